@@ -0,0 +1,1042 @@
+#include <string.h>
+#include <limits.h>
+#include "../header/main.h"
+#include "../header/textures.h"
+#include "../header/rendering.h"
+#include "../header/floorcast.h"
+#include "../header/weapon.h"
+#include "../header/options.h"
+#include "../header/assets.h"
+#include "../header/minimap.h"
+#include "../header/particles.h"
+#include "../header/sprites.h"
+#include "../header/camera.h"
+#include "../header/resolution.h"
+#include "../header/input.h"
+#include "../header/input_log.h"
+#include "../header/entity_grid.h"
+#include "../header/view_batch.h"
+#include "../header/lightmap.h"
+#include "../header/flow_field.h"
+
+/*
+ * Headless rendering benchmark. Renders a scripted camera path, or a
+ * session recorded with --record and given with --replay, through an
+ * offscreen software renderer (no window, SDL dummy video driver) and
+ * reports frame time statistics per render stage as JSON. With --views N
+ * it renders the path through the batched view API instead, N cameras
+ * per call, and reports views per second. With --flow N it renders
+ * nothing and times the NPC flow field and N NPCs steering by it. With
+ * --check-kernels it checks the packet DDA kernels against castRay, and
+ * with --check-lightmap the lightmap rebakes against full bakes.
+ */
+
+Mix_Chunk *shotgunSound = NULL;
+
+/*Camera pose the scripted path passes through*/
+typedef struct {
+	double posX, posY;
+	double angle; /* radians, 0 looks down +x */
+	int frames;   /* frames spent moving to the next keyframe */
+} Keyframe;
+
+/*Walks the open corridors of resources/map.txt, turning on the spot at the corners*/
+static const Keyframe cameraPath[] = {
+	{22.0, 12.0, M_PI, 60},
+	{21.5, 12.0, M_PI * 1.5, 90},
+	{21.5, 2.5, M_PI * 1.5, 60},
+	{21.5, 2.5, M_PI, 150},
+	{2.5, 2.5, M_PI, 60},
+	{2.5, 2.5, M_PI * 0.5, 60},
+	{2.5, 9.5, M_PI * 0.5, 60},
+	{2.5, 9.5, 0.0, 150},
+	{21.5, 9.5, 0.0, 60},
+	{21.5, 9.5, M_PI * 0.5, 120},
+	{21.5, 21.5, M_PI * 0.5, 60},
+	{21.5, 21.5, M_PI, 90},
+	{12.5, 21.5, M_PI, 120},
+	{12.5, 21.5, M_PI, 0},
+};
+
+#define PATH_LENGTH (int)(sizeof(cameraPath) / sizeof(cameraPath[0]))
+
+typedef enum {
+	STAGE_RAYCASTING,
+	STAGE_FLOOR,
+	STAGE_SPRITES,
+	STAGE_MINIMAP,
+	STAGE_PARTICLES,
+	STAGE_WEAPON,
+	STAGE_PRESENT,
+	STAGE_COUNT
+} Stage;
+
+static const char *stageNames[STAGE_COUNT] = {
+	"raycasting", "floor", "sprites", "minimap", "particles", "weapon", "present"
+};
+
+/**
+ * getPathLength - function counts the frames in one pass of the camera path
+ *
+ * Return: number of frames
+ */
+static int getPathLength(void)
+{
+	int frames = 0;
+
+	for (int i = 0; i < PATH_LENGTH - 1; i++)
+		frames += cameraPath[i].frames;
+	return (frames);
+}
+
+/**
+ * getCameraAt - function interpolates the camera path at a frame
+ * @frame: frame number, wrapping around at the end of the path
+ * @posX: receives the position on the x axis
+ * @posY: receives the position on the y axis
+ * @dirX: receives the direction on the x axis
+ * @dirY: receives the direction on the y axis
+ * @planeX: receives the camera plane on the x axis
+ * @planeY: receives the camera plane on the y axis
+ *
+ * Return: void
+ */
+static void getCameraAt(int frame, double *posX, double *posY, double *dirX,
+		double *dirY, double *planeX, double *planeY)
+{
+	int i = 0;
+	double t, angle;
+	Player camera;
+
+	frame %= getPathLength();
+	while (frame >= cameraPath[i].frames)
+		frame -= cameraPath[i++].frames;
+	t = frame / (double)cameraPath[i].frames;
+	*posX = cameraPath[i].posX + (cameraPath[i + 1].posX - cameraPath[i].posX) * t;
+	*posY = cameraPath[i].posY + (cameraPath[i + 1].posY - cameraPath[i].posY) * t;
+	angle = cameraPath[i].angle + (cameraPath[i + 1].angle - cameraPath[i].angle) * t;
+	/*Snapped to the game's angle steps, so the views come from the same tables*/
+	setPlayerAngle(&camera, (int)lround(angle * ANGLE_STEPS / (2 * M_PI)));
+	fitViewToAspect(&camera, cameraTables.width, cameraTables.height);
+	*dirX = camera.dirX;
+	*dirY = camera.dirY;
+	*planeX = camera.planeX;
+	*planeY = camera.planeY;
+}
+
+/*A recorded session played back one tick per frame*/
+typedef struct {
+	InputLog *log;
+	GameState game;
+} Replay;
+
+/**
+ * compareDoubles - qsort comparator for doubles
+ * @a: pointer to the first value
+ * @b: pointer to the second value
+ *
+ * Return: negative, zero or positive like strcmp
+ */
+static int compareDoubles(const void *a, const void *b)
+{
+	double x = *(const double *)a, y = *(const double *)b;
+
+	return ((x > y) - (x < y));
+}
+
+/**
+ * printStats - function writes mean, p50, p99 and max of samples as JSON
+ * @out: stream receiving the JSON object
+ * @samples: frame times in milliseconds, sorted in place
+ * @count: number of samples
+ *
+ * Return: void
+ */
+static void printStats(FILE *out, double *samples, int count)
+{
+	double sum = 0;
+
+	qsort(samples, count, sizeof(double), compareDoubles);
+	for (int i = 0; i < count; i++)
+		sum += samples[i];
+	/*Nearest-rank percentiles*/
+	fprintf(out, "{\"mean\": %.4f, \"p50\": %.4f, \"p99\": %.4f, \"max\": %.4f}",
+			sum / count, samples[(count * 50 + 99) / 100 - 1],
+			samples[(count * 99 + 99) / 100 - 1], samples[count - 1]);
+}
+
+/**
+ * writeTimings - function writes every frame's times as CSV
+ * @path: path of the file to write
+ * @frameTimes: frame times in milliseconds, in frame order
+ * @stageTimes: per stage times in milliseconds, in frame order
+ * @count: number of frames
+ *
+ * Return: true on success, false if the file could not be written
+ */
+static bool writeTimings(const char *path, const double *frameTimes,
+		double *const stageTimes[STAGE_COUNT], int count)
+{
+	FILE *file = fopen(path, "w");
+
+	if (!file)
+	{
+		fprintf(stderr, "Failed to open %s\n", path);
+		return (false);
+	}
+	fprintf(file, "frame,frame_ms");
+	for (int s = 0; s < STAGE_COUNT; s++)
+		fprintf(file, ",%s_ms", stageNames[s]);
+	fprintf(file, "\n");
+	for (int i = 0; i < count; i++)
+	{
+		fprintf(file, "%d,%.4f", i, frameTimes[i]);
+		for (int s = 0; s < STAGE_COUNT; s++)
+			fprintf(file, ",%.4f", stageTimes[s][i]);
+		fprintf(file, "\n");
+	}
+	return (fclose(file) == 0);
+}
+
+/**
+ * matchesFullBake - function compares a lightmap with one baked from scratch
+ * @lights: pointer to the lightmap of worldMap, baked
+ * @sprites: sprites the lights were placed from
+ *
+ * Return: true if every block is the same, false otherwise
+ */
+static bool matchesFullBake(const Lightmap *lights, const SpriteSet *sprites)
+{
+	const size_t blockSize = sizeof(Uint32) * LIGHT_REGION * LIGHT_REGION * 4 * LIGHT_FACE_SAMPLES;
+	Lightmap fresh;
+	bool same = initLightmap(&fresh, worldMap.width, worldMap.height) &&
+		addSpriteLights(&fresh, sprites);
+
+	if (same)
+		bakeLightmap(&fresh);
+	for (int i = 0; same && i < lights->regionsX * lights->regionsY; i++)
+		if ((fresh.regions[i] == NULL) != (lights->regions[i] == NULL) ||
+				(fresh.regions[i] && memcmp(fresh.regions[i], lights->regions[i], blockSize) != 0))
+			same = false;
+	destroyLightmap(&fresh);
+	return (same);
+}
+
+/**
+ * timeWallChanges - function times the lightmap rebakes after walls change
+ * @lights: pointer to the lightmap of worldMap, fully baked
+ * @sprites: sprites the lights were placed from
+ * @changes: receives the number of cells changed
+ * @exact: receives whether the rebakes matched full bakes
+ *
+ * Puts a wall in the empty cell east of every light, then takes them
+ * all away again, with setMapCell, baking after each change as the game
+ * does once per frame. With the walls up, and once they are down, the
+ * lightmap is compared with one baked from scratch.
+ *
+ * Return: mean milliseconds per rebake, 0 if no cell could be changed
+ */
+static double timeWallChanges(Lightmap *lights, const SpriteSet *sprites,
+		int *changes, bool *exact)
+{
+	int *cells = malloc(sizeof(int) * 2 * SDL_max(lights->lightCount, 1));
+	int raised = 0;
+	Uint64 ticks = 0, start;
+
+	*changes = 0;
+	*exact = false;
+	if (!cells)
+		return (0);
+	for (int i = 0; i < lights->lightCount; i++)
+	{
+		int x = (int)lights->lights[i].x + 1, y = (int)lights->lights[i].y;
+
+		if (x >= worldMap.width || getMapCell(&worldMap, x, y) != 0)
+			continue;
+		start = SDL_GetPerformanceCounter();
+		setMapCell(&worldMap, x, y, 1);
+		bakeLightmap(lights);
+		ticks += SDL_GetPerformanceCounter() - start;
+		cells[raised * 2] = x;
+		cells[raised++ * 2 + 1] = y;
+	}
+	*exact = matchesFullBake(lights, sprites);
+	*changes = raised * 2;
+	while (raised-- > 0)
+	{
+		start = SDL_GetPerformanceCounter();
+		setMapCell(&worldMap, cells[raised * 2], cells[raised * 2 + 1], 0);
+		bakeLightmap(lights);
+		ticks += SDL_GetPerformanceCounter() - start;
+	}
+	*exact = matchesFullBake(lights, sprites) && *exact;
+	free(cells);
+	return (*changes ? ticks * 1000.0 / SDL_GetPerformanceFrequency() / *changes : 0);
+}
+
+/**
+ * runLightmapCheck - function checks the lightmap rebakes after wall changes
+ * @options: parsed options, for the map and --sprites
+ * @seed: seed for rand(), scattering the --sprites
+ * @out: stream receiving the JSON report
+ *
+ * Lights --map from its sprites as the game does, bakes it whole, then
+ * changes walls next to the lights with timeWallChanges.
+ *
+ * Return: 0 if every rebake matched a bake from scratch, 1 otherwise
+ */
+static int runLightmapCheck(const GameOptions *options, Uint32 seed, FILE *out)
+{
+	SpriteSet *sprites = createSpriteSet();
+	Lightmap lights;
+	double rebakeMs;
+	int changes;
+	bool exact;
+
+	loadMap(options->mapPath);
+	if (!sprites || !loadSprites(sprites, SPRITE_PLACEMENTS))
+		return (1);
+	scatterSprites(sprites, options->extraSprites, seed);
+	if (!initLightmap(&lights, worldMap.width, worldMap.height) ||
+			!addSpriteLights(&lights, sprites))
+		return (1);
+	bakeLightmap(&lights);
+	rebakeMs = timeWallChanges(&lights, sprites, &changes, &exact);
+
+	fprintf(out, "{\n  \"backend\": \"lightmap_check\",\n  \"map_width\": %d,\n"
+			"  \"map_height\": %d,\n  \"lights\": %d,\n  \"wall_changes\": %d,\n"
+			"  \"rebake_ms\": %.4f,\n  \"exact\": %s\n}\n",
+			worldMap.width, worldMap.height, lights.lightCount, changes, rebakeMs,
+			exact ? "true" : "false");
+	if (!exact)
+		fprintf(stderr, "Rebaking after wall changes left the lightmap unlike a full bake\n");
+
+	destroyLightmap(&lights);
+	destroySpriteSet(sprites);
+	freeMap(&worldMap);
+	return (exact ? 0 : 1);
+}
+
+/**
+ * runViewBatches - function renders the camera path as batches of offscreen views
+ * @options: parsed render options, for the view size, threads and render scale
+ * @batchSize: cameras per renderViewBatch call
+ * @views: cameras to time, 0 for one pass of the path
+ * @warmup: cameras rendered before timing starts
+ * @out: stream receiving the JSON report
+ *
+ * Return: 0 on success, 1 on failure
+ */
+static int runViewBatches(const GameOptions *options, int batchSize, int views,
+		int warmup, FILE *out)
+{
+	RenderResolution resolution;
+	ViewBatch *batch;
+	ViewCamera *cameras;
+	Framebuffer *targets;
+	double *batchTimes, total = 0;
+	const double msPerTick = 1000.0 / SDL_GetPerformanceFrequency();
+	int batches, warmupBatches = (warmup + batchSize - 1) / batchSize;
+
+	initRenderResolution(&resolution, options->windowWidth, options->windowHeight,
+			options->renderScale > 0 ? options->renderScale : 1, options->frameBudgetMs);
+	/*The path is turned into cameras with the game's angle tables and aspect fit*/
+	if (!initCameraTables(resolution.width, resolution.height))
+		return (1);
+	loadMap("./resources/map.txt");
+	if (views == 0)
+		views = getPathLength();
+	batches = (views + batchSize - 1) / batchSize;
+	batch = createViewBatch(resolution.width, resolution.height, options->threadCount);
+	cameras = malloc(sizeof(ViewCamera) * batchSize);
+	targets = calloc(batchSize, sizeof(Framebuffer));
+	batchTimes = malloc(sizeof(double) * batches);
+	if (!batch || !cameras || !targets || !batchTimes ||
+			!createViewTargets(batch, targets, batchSize))
+		return (1);
+
+	for (int b = -warmupBatches; b < batches; b++)
+	{
+		/*The last batch may be short so exactly views cameras are timed*/
+		int count = b < 0 ? batchSize : SDL_min(batchSize, views - b * batchSize);
+		Uint64 start;
+
+		for (int i = 0; i < count; i++)
+		{
+			ViewCamera *camera = &cameras[i];
+
+			getCameraAt((b + warmupBatches) * batchSize + i, &camera->posX, &camera->posY,
+					&camera->dirX, &camera->dirY, &camera->planeX, &camera->planeY);
+		}
+		start = SDL_GetPerformanceCounter();
+		renderViewBatch(batch, cameras, targets, count);
+		if (b < 0)
+			continue;
+		batchTimes[b] = (SDL_GetPerformanceCounter() - start) * msPerTick;
+		total += batchTimes[b];
+	}
+
+	fprintf(out, "{\n  \"backend\": \"batch\",\n  \"kernel\": \"%s\",\n"
+			"  \"threads\": %d,\n  \"width\": %d,\n  \"height\": %d,\n"
+			"  \"views\": %d,\n  \"batch_size\": %d,\n"
+			"  \"views_per_second\": %.1f,\n  \"batch_ms\": ",
+			getRayKernelName(options->rayKernel), batch->pool->threadCount,
+			resolution.width, resolution.height, views, batchSize,
+			views / (total / 1000));
+	printStats(out, batchTimes, batches);
+	fprintf(out, "\n}\n");
+
+	destroyViewTargets(targets, batchSize);
+	free(targets);
+	free(cameras);
+	free(batchTimes);
+	destroyViewBatch(batch);
+	destroyCameraTables();
+	freeMap(&worldMap);
+	return (0);
+}
+
+/*Frames the player takes to walk a cell, at the game's 0.06 cells per tick*/
+#define FLOW_FRAMES_PER_CELL 16
+/*Cells an agent walks per frame*/
+#define FLOW_AGENT_SPEED 0.04f
+
+/**
+ * walkPlayer - function moves the player into a neighbouring open cell
+ * @x: player cell column, updated
+ * @y: player cell row, updated
+ * @heading: side the player walks toward, 0 to 3, updated
+ *
+ * Mostly keeps walking the same way, so the walk crosses the map instead
+ * of circling one spot, and turns at random when blocked.
+ *
+ * Return: void
+ */
+static void walkPlayer(int *x, int *y, int *heading)
+{
+	for (int tries = 0; tries < 16; tries++)
+	{
+		int side = tries == 0 && rand() % 4 != 0 ? *heading : rand() % 4;
+		int nx = *x + (side == 0) - (side == 1), ny = *y + (side == 2) - (side == 3);
+
+		if (nx < 0 || ny < 0 || nx >= worldMap.width || ny >= worldMap.height ||
+				getMapCell(&worldMap, nx, ny) != 0)
+			continue;
+		*x = nx;
+		*y = ny;
+		*heading = side;
+		return;
+	}
+}
+
+/**
+ * runFlowField - function times the NPC flow field while the player walks
+ * @options: parsed options, for the map
+ * @agents: NPCs steered by the field every frame
+ * @frames: frames to time, 0 for 600
+ * @warmup: frames run before timing starts
+ * @seed: seed for rand(), placing the NPCs and choosing the walk
+ * @out: stream receiving the JSON report
+ *
+ * Every frame builds the game's slice of the field and steers every NPC
+ * one step along it. Each time the player enters a new cell, a second
+ * field is also rebuilt whole, for the cost of one full rebuild.
+ *
+ * Return: 0 on success, 1 on failure
+ */
+static int runFlowField(const GameOptions *options, int agents, int frames, int warmup,
+		Uint32 seed, FILE *out)
+{
+	FlowField *field, *full;
+	float *agentX, *agentY;
+	double *updateTimes, *steerTimes, *rebuildTimes, reachedCells = 0, steerTotal = 0;
+	const double msPerTick = 1000.0 / SDL_GetPerformanceFrequency();
+	int playerX, playerY, heading = 0, rebuilds = 0, firstRebuilds;
+
+	loadMap(options->mapPath);
+	if (frames == 0)
+		frames = 600;
+	if (!findEmptyCell(&worldMap, worldMap.width / 2, worldMap.height / 2, &playerX, &playerY))
+	{
+		fprintf(stderr, "Map %s has no empty cell to start in\n", options->mapPath);
+		return (1);
+	}
+	field = createFlowField();
+	full = createFlowField();
+	agentX = malloc(sizeof(float) * SDL_max(agents, 1));
+	agentY = malloc(sizeof(float) * SDL_max(agents, 1));
+	updateTimes = malloc(sizeof(double) * frames);
+	steerTimes = malloc(sizeof(double) * frames);
+	rebuildTimes = malloc(sizeof(double) * (frames / FLOW_FRAMES_PER_CELL + 1));
+	if (!field || !full || !agentX || !agentY || !updateTimes || !steerTimes || !rebuildTimes)
+		return (1);
+	/*NPCs in open cells within the field's reach of the start*/
+	srand(seed);
+	for (int i = 0; i < agents; i++)
+	{
+		int cellX, cellY;
+
+		findEmptyCell(&worldMap,
+				SDL_max(SDL_min(playerX + rand() % FLOW_SIZE - FLOW_SIZE / 2, worldMap.width - 1), 0),
+				SDL_max(SDL_min(playerY + rand() % FLOW_SIZE - FLOW_SIZE / 2, worldMap.height - 1), 0),
+				&cellX, &cellY);
+		agentX[i] = cellX + 0.5f;
+		agentY[i] = cellY + 0.5f;
+	}
+	updateFlowField(field, &worldMap, playerX, playerY, INT_MAX);
+
+	firstRebuilds = field->rebuilds;
+	for (int f = -warmup; f < frames; f++)
+	{
+		Uint64 start, updated, steered;
+
+		if (f == 0)
+			firstRebuilds = field->rebuilds;
+		if ((f + warmup) % FLOW_FRAMES_PER_CELL == FLOW_FRAMES_PER_CELL - 1)
+		{
+			walkPlayer(&playerX, &playerY, &heading);
+			start = SDL_GetPerformanceCounter();
+			updateFlowField(full, &worldMap, playerX, playerY, INT_MAX);
+			if (f >= 0)
+			{
+				rebuildTimes[rebuilds++] = (SDL_GetPerformanceCounter() - start) * msPerTick;
+				reachedCells += full->layers[full->ready].reached;
+			}
+		}
+		start = SDL_GetPerformanceCounter();
+		updateFlowField(field, &worldMap, playerX, playerY, FLOW_CELLS_PER_FRAME);
+		updated = SDL_GetPerformanceCounter();
+		/*One lookup per NPC, then a step toward the centre of the cell it names*/
+		for (int i = 0; i < agents; i++)
+		{
+			float toX, toY, length;
+			int dx, dy;
+
+			if (!getFlowStep(field, agentX[i], agentY[i], &dx, &dy))
+				continue;
+			toX = floorf(agentX[i]) + dx + 0.5f - agentX[i];
+			toY = floorf(agentY[i]) + dy + 0.5f - agentY[i];
+			length = sqrtf(toX * toX + toY * toY);
+			agentX[i] += toX * FLOW_AGENT_SPEED / length;
+			agentY[i] += toY * FLOW_AGENT_SPEED / length;
+		}
+		steered = SDL_GetPerformanceCounter();
+		if (f < 0)
+			continue;
+		updateTimes[f] = (updated - start) * msPerTick;
+		steerTimes[f] = (steered - updated) * msPerTick;
+		steerTotal += steerTimes[f];
+	}
+
+	fprintf(out, "{\n  \"backend\": \"flow_field\",\n  \"map_width\": %d,\n"
+			"  \"map_height\": %d,\n  \"field_size\": %d,\n  \"agents\": %d,\n"
+			"  \"frames\": %d,\n  \"cells_per_frame\": %d,\n  \"reached_cells\": %.0f,\n"
+			"  \"frames_per_rebuild\": %.2f,\n  \"steer_ns_per_agent\": %.2f,\n"
+			"  \"rebuild_ms\": ",
+			worldMap.width, worldMap.height, FLOW_SIZE, agents, frames, FLOW_CELLS_PER_FRAME,
+			rebuilds ? reachedCells / rebuilds : 0,
+			(double)frames / SDL_max(field->rebuilds - firstRebuilds, 1),
+			agents ? steerTotal * 1e6 / ((double)frames * agents) : 0);
+	if (rebuilds > 0)
+		printStats(out, rebuildTimes, rebuilds);
+	else
+		fprintf(out, "null");
+	fprintf(out, ",\n  \"update_ms\": ");
+	printStats(out, updateTimes, frames);
+	fprintf(out, ",\n  \"steer_ms\": ");
+	printStats(out, steerTimes, frames);
+	fprintf(out, "\n}\n");
+
+	free(rebuildTimes);
+	free(steerTimes);
+	free(updateTimes);
+	free(agentY);
+	free(agentX);
+	destroyFlowField(full);
+	destroyFlowField(field);
+	freeMap(&worldMap);
+	return (0);
+}
+
+/*Distance two kernels may differ by on the same wall, in cells*/
+#define KERNEL_CHECK_EPSILON 1e-9
+/*Rays a packet kernel may send to another wall than castRay*/
+#define KERNEL_CHECK_TOLERANCE 0
+/*Texture width texture columns are compared at*/
+#define KERNEL_CHECK_TEXTURE 64
+
+/**
+ * runKernelCheck - function casts random cameras through every DDA kernel
+ * @options: parsed options, for the map, the view width and the kernel to restore
+ * @cameras: cameras to cast, 0 for 2000
+ * @seed: seed for rand(), placing the cameras
+ * @out: stream receiving the JSON report
+ *
+ * Every camera stands in a random open cell, facing one of the game's
+ * angles, and casts one ray per column. castRay gives the reference hit;
+ * castRays then casts the same rays with each packet kernel the CPU has.
+ * A ray mismatches when its wall cell, side or texture column differ, or
+ * its distance by more than KERNEL_CHECK_EPSILON. Each kernel is timed too.
+ *
+ * Return: 0 if every kernel stays within KERNEL_CHECK_TOLERANCE, 1 otherwise
+ */
+static int runKernelCheck(const GameOptions *options, int cameras, Uint32 seed, FILE *out)
+{
+	const int width = options->windowWidth;
+	const double msPerTick = 1000.0 / SDL_GetPerformanceFrequency();
+	double *cameraX = malloc(sizeof(double) * width);
+	double *rayDirX = malloc(sizeof(double) * width * 2), *rayDirY = rayDirX + width;
+	RayHit *reference = malloc(sizeof(RayHit) * width * 2), *hits = reference + width;
+	double scalarMs = 0, kernelMs[RAY_KERNEL_AVX2 + 1] = {0};
+	long mismatches[RAY_KERNEL_AVX2 + 1] = {0};
+	bool available[RAY_KERNEL_AVX2 + 1] = {false};
+	int status = 0;
+
+	if (!cameraX || !rayDirX || !reference || !initCameraTables(width, options->windowHeight))
+		return (1);
+	loadMap(options->mapPath);
+	if (cameras == 0)
+		cameras = 2000;
+	fillCameraColumns(cameraX, width);
+	for (RayKernel k = RAY_KERNEL_SCALAR + 1; k <= RAY_KERNEL_AVX2; k++)
+		available[k] = selectRayKernel(k) == k;
+	srand(seed);
+	for (int c = 0; c < cameras; c++)
+	{
+		int cellX, cellY;
+		Player camera;
+		Uint64 start;
+
+		if (!findEmptyCell(&worldMap, rand() % worldMap.width, rand() % worldMap.height,
+					&cellX, &cellY))
+			return (1);
+		camera.posX = cellX + (rand() + 0.5) / ((double)RAND_MAX + 1);
+		camera.posY = cellY + (rand() + 0.5) / ((double)RAND_MAX + 1);
+		setPlayerAngle(&camera, rand() % ANGLE_STEPS);
+		fitViewToAspect(&camera, width, options->windowHeight);
+		for (int x = 0; x < width; x++)
+		{
+			rayDirX[x] = camera.dirX + camera.planeX * cameraX[x];
+			rayDirY[x] = camera.dirY + camera.planeY * cameraX[x];
+		}
+		start = SDL_GetPerformanceCounter();
+		for (int x = 0; x < width; x++)
+			castRay(camera.posX, camera.posY, rayDirX[x], rayDirY[x], &reference[x]);
+		scalarMs += (SDL_GetPerformanceCounter() - start) * msPerTick;
+		for (RayKernel k = RAY_KERNEL_SCALAR + 1; k <= RAY_KERNEL_AVX2; k++)
+		{
+			if (!available[k])
+				continue;
+			selectRayKernel(k);
+			start = SDL_GetPerformanceCounter();
+			castRays(camera.posX, camera.posY, rayDirX, rayDirY, width, hits);
+			kernelMs[k] += (SDL_GetPerformanceCounter() - start) * msPerTick;
+			for (int x = 0; x < width; x++)
+			{
+				const RayHit *a = &reference[x], *b = &hits[x];
+
+				if (a->mapX != b->mapX || a->mapY != b->mapY || a->side != b->side ||
+						fabs(a->perpWallDist - b->perpWallDist) > KERNEL_CHECK_EPSILON ||
+						getTextureX(a, KERNEL_CHECK_TEXTURE) != getTextureX(b, KERNEL_CHECK_TEXTURE))
+					mismatches[k]++;
+			}
+		}
+	}
+	selectRayKernel(options->rayKernel);
+
+	fprintf(out, "{\n  \"backend\": \"kernel_check\",\n  \"map_width\": %d,\n"
+			"  \"map_height\": %d,\n  \"cameras\": %d,\n  \"rays\": %ld,\n"
+			"  \"epsilon\": %g,\n  \"tolerance\": %d,\n  \"kernels\": [\n"
+			"    {\"name\": \"scalar\", \"rays_per_second\": %.0f}",
+			worldMap.width, worldMap.height, cameras, (long)cameras * width,
+			KERNEL_CHECK_EPSILON, KERNEL_CHECK_TOLERANCE,
+			(double)cameras * width / (scalarMs / 1000));
+	for (RayKernel k = RAY_KERNEL_SCALAR + 1; k <= RAY_KERNEL_AVX2; k++)
+	{
+		double rate = mismatches[k] / ((double)cameras * width);
+
+		if (!available[k])
+			continue;
+		fprintf(out, ",\n    {\"name\": \"%s\", \"rays_per_second\": %.0f,"
+				" \"mismatches\": %ld, \"mismatch_rate\": %.3g}",
+				getRayKernelName(k), (double)cameras * width / (kernelMs[k] / 1000),
+				mismatches[k], rate);
+		if (mismatches[k] > KERNEL_CHECK_TOLERANCE)
+		{
+			fprintf(stderr, "The %s kernel missed castRay on %ld of %ld rays\n",
+					getRayKernelName(k), mismatches[k], (long)cameras * width);
+			status = 1;
+		}
+	}
+	fprintf(out, "\n  ]\n}\n");
+
+	free(reference);
+	free(rayDirX);
+	free(cameraX);
+	destroyCameraTables();
+	freeMap(&worldMap);
+	return (status);
+}
+
+/**
+ * printUsage - function prints the benchmark specific options
+ * @program: name the benchmark was started with
+ *
+ * Return: void
+ */
+static void printUsage(const char *program)
+{
+	fprintf(stderr, "Usage: %s [--frames N] [--warmup N] [--output FILE]"
+			" [--timings FILE] [--views N] [--flow N] [--check-kernels]"
+			" [--check-lightmap] [game render options]\n", program);
+	fprintf(stderr, "  --replay F   render the session recorded in F instead of the camera path\n");
+	fprintf(stderr, "  --timings F  write every frame's stage times to F as CSV\n");
+	fprintf(stderr, "  --views N    render the path through the batched view API,"
+			" N cameras per batch, and report views per second\n");
+	fprintf(stderr, "  --flow N     time the NPC flow field on --map while the player walks,"
+			" with N NPCs steering by it\n");
+	fprintf(stderr, "  --check-kernels cast --frames random cameras on --map through castRay"
+			" and every packet kernel, and fail if any ray disagrees\n");
+	fprintf(stderr, "  --check-lightmap put walls up next to the lights of --map and take them"
+			" down, and fail if a rebake differs from a full bake\n");
+}
+
+/**
+ * main - renders the camera path offscreen and reports frame times
+ * @argc: arguments counter
+ * @argv: pointer to argument array
+ *
+ * Return: 0 on success, 1 on failure
+ */
+int main(int argc, char *argv[])
+{
+	int frames = 0, warmup = 30, batchSize = 0, flowAgents = -1;
+	bool checkKernels = false, checkLightmap = false, mapGiven = false;
+	const char *outputPath = NULL, *timingsPath = NULL;
+	Replay replay = {0};
+	Uint32 seed = 1;
+	char **renderArgs = calloc(argc + 1, sizeof(char *));
+	int renderArgc = 0;
+	GameOptions options;
+	Framebuffer framebuffer;
+	Minimap minimap;
+	RenderResolution resolution;
+	ThreadPool *renderPool;
+	FILE *out = stdout;
+
+	/*Keep our own options and hand the rest to the game's parser*/
+	renderArgs[renderArgc++] = argv[0];
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc)
+			frames = atoi(argv[++i]);
+		else if (strcmp(argv[i], "--warmup") == 0 && i + 1 < argc)
+			warmup = atoi(argv[++i]);
+		else if (strcmp(argv[i], "--output") == 0 && i + 1 < argc)
+			outputPath = argv[++i];
+		else if (strcmp(argv[i], "--timings") == 0 && i + 1 < argc)
+			timingsPath = argv[++i];
+		else if (strcmp(argv[i], "--views") == 0 && i + 1 < argc)
+			batchSize = atoi(argv[++i]);
+		else if (strcmp(argv[i], "--flow") == 0 && i + 1 < argc)
+			flowAgents = atoi(argv[++i]);
+		else if (strcmp(argv[i], "--check-kernels") == 0)
+			checkKernels = true;
+		else if (strcmp(argv[i], "--check-lightmap") == 0)
+			checkLightmap = true;
+		else
+		{
+			mapGiven = mapGiven || strcmp(argv[i], "--map") == 0;
+			renderArgs[renderArgc++] = argv[i];
+		}
+	}
+	if (frames < 0 || batchSize < 0 || flowAgents < -1 || !parseOptions(renderArgc, renderArgs, &options))
+	{
+		printUsage(argv[0]);
+		return (1);
+	}
+
+	/*cameraPath and the view batches are scripted for resources/map.txt*/
+	if (mapGiven && !options.replayPath && flowAgents < 0 && !checkKernels && !checkLightmap)
+	{
+		fprintf(stderr, "--map needs --replay, --flow, --check-kernels or --check-lightmap:"
+				" the camera path only fits ./resources/map.txt\n");
+		return (1);
+	}
+
+	/*No display needed: dummy video driver and a surface-backed renderer*/
+	SDL_setenv("SDL_VIDEODRIVER", "dummy", 1);
+	if (SDL_Init(SDL_INIT_VIDEO) < 0 || !(IMG_Init(IMG_INIT_PNG) & IMG_INIT_PNG))
+	{
+		fprintf(stderr, "SDL_Init or IMG_Init failed: %s\n", SDL_GetError());
+		return (1);
+	}
+	options.rayKernel = selectRayKernel(options.rayKernel);
+	if (batchSize > 0 || flowAgents >= 0 || checkKernels || checkLightmap)
+	{
+		int status;
+
+		if (outputPath && !(out = fopen(outputPath, "w")))
+		{
+			fprintf(stderr, "Failed to open %s\n", outputPath);
+			return (1);
+		}
+		if (checkKernels)
+			status = runKernelCheck(&options, frames, seed, out);
+		else if (checkLightmap)
+			status = runLightmapCheck(&options, seed, out);
+		else if (flowAgents >= 0)
+			status = runFlowField(&options, flowAgents, frames, warmup, seed, out);
+		else
+			status = runViewBatches(&options, batchSize, frames, warmup, out);
+		if (out != stdout)
+			fclose(out);
+		free(renderArgs);
+		IMG_Quit();
+		SDL_Quit();
+		return (status);
+	}
+	SDL_Surface *target = SDL_CreateRGBSurfaceWithFormat(0, options.windowWidth,
+			options.windowHeight, 32, SDL_PIXELFORMAT_ARGB8888);
+	SDL_Renderer *renderer = target ? SDL_CreateSoftwareRenderer(target) : NULL;
+
+	if (!renderer)
+	{
+		fprintf(stderr, "Offscreen renderer creation failed: %s\n", SDL_GetError());
+		return (1);
+	}
+	rayCache.enabled = options.rayCache;
+	/*A fixed render scale, so every run renders the same pixels*/
+	initRenderResolution(&resolution, options.windowWidth, options.windowHeight,
+			options.renderScale > 0 ? options.renderScale : 1, options.frameBudgetMs);
+	renderPool = createThreadPool(options.threadCount);
+	if (!renderPool || !initCameraTables(resolution.width, resolution.height) ||
+			!createFramebuffer(&framebuffer, renderer, resolution.width, resolution.height))
+		return (1);
+
+	loadMap(options.mapPath);
+	if (options.replayPath)
+	{
+		replay.log = loadInputLog(options.replayPath);
+		if (!replay.log)
+			return (1);
+		if (replay.log->mapChecksum != getMapChecksum(&worldMap))
+		{
+			fprintf(stderr, "%s was recorded on another map than %s\n",
+					options.replayPath, options.mapPath);
+			return (1);
+		}
+		seed = replay.log->seed;
+		options.extraSprites = replay.log->extraSprites;
+		/*One frame per tick, the whole session unless fewer frames are asked for*/
+		frames = frames ? SDL_min(frames, replay.log->tickCount) : replay.log->tickCount;
+		if (frames <= 0)
+			return (1);
+	}
+	else if (frames == 0)
+		frames = getPathLength();
+	if (!createMinimap(&minimap, renderer))
+		return (1);
+	/*Everything is loaded before timing starts, so decoding never overlaps a frame*/
+	TextureCache *textures = createTextureCache(renderer, (size_t)options.textureBudgetMB << 20);
+	AssetLoader *assets = textures ? createAssetLoader(ASSET_MANIFEST, textures, false) : NULL;
+
+	if (!assets || !waitForAssets(assets, false))
+		return (1);
+	TextureData wallTextures[WALL_TEXTURE_COUNT];
+	char path[64];
+
+	for (int i = 0; i < WALL_TEXTURE_COUNT; i++)
+	{
+		snprintf(path, sizeof(path), "./resources/textures/%d.png", i + 1);
+		wallTextures[i] = acquireTexture(textures, path);
+	}
+	/*Transposed copy of the wall textures and their mip levels for the software renderer*/
+	WallAtlas wallAtlas;
+	if (!createWallAtlas(&wallAtlas, wallTextures))
+		return (1);
+	/*The same levels as textures for the SDL renderer*/
+	WallMipmaps wallMipmaps;
+	if (!createWallMipmaps(&wallMipmaps, &wallAtlas, wallTextures, renderer))
+		return (1);
+	/*Row-major mip chains of the floor and ceiling for the software renderer*/
+	FloorTextures floorTextures;
+	if (!createFloorTextures(&floorTextures, &wallAtlas))
+		return (1);
+	TextureData skyTexture = acquireTexture(textures, "./resources/textures/sky.png");
+	TextureData weaponTextures[4];
+	weaponTextures[0] = acquireTexture(textures, "./resources/sprites/weapon/shotgun/0.png");
+	weaponTextures[1] = acquireTexture(textures, "./resources/sprites/weapon/shotgun/1.png");
+	weaponTextures[2] = acquireTexture(textures, "./resources/sprites/weapon/shotgun/4.png");
+	weaponTextures[3] = acquireTexture(textures, "./resources/sprites/weapon/shotgun/5.png");
+
+	/*Same rain every run, advanced by a fixed 60 Hz frame time*/
+	ParticleSystem *particles = createParticleSystem(options.rainDrops * 2 +
+			MUZZLE_SMOKE_PUFFS * 8, seed);
+
+	if (!particles)
+		return (1);
+	setParticleArea(particles, resolution.outputWidth, resolution.outputHeight);
+	setRainDensity(particles, options.rainDrops);
+	/*The placed sprites, plus --sprites N scattered the same way every run*/
+	SpriteSet *sprites = createSpriteSet();
+
+	if (!sprites || !loadSprites(sprites, SPRITE_PLACEMENTS) || !createSpriteAtlas(sprites, textures))
+		return (1);
+	scatterSprites(sprites, options.extraSprites, seed);
+	if (!initLightmap(&lightmap, worldMap.width, worldMap.height) ||
+			!addSpriteLights(&lightmap, sprites))
+		return (1);
+	/*Whole-map bake, as the game does once at load*/
+	Uint64 bakeStart = SDL_GetPerformanceCounter();
+	bakeLightmap(&lightmap);
+	double bakeMs = (SDL_GetPerformanceCounter() - bakeStart) * 1000.0 / SDL_GetPerformanceFrequency();
+	lightmap.enabled = options.lighting;
+	if (replay.log && !initGameState(&replay.game, sprites))
+		return (1);
+
+	double *frameTimes = malloc(sizeof(double) * frames);
+	double *stageTimes[STAGE_COUNT];
+	const double msPerTick = 1000.0 / SDL_GetPerformanceFrequency();
+	float muzzleX, muzzleY;
+	long reusedColumns = 0;
+
+	getMuzzlePosition(renderer, &muzzleX, &muzzleY);
+
+	for (int s = 0; s < STAGE_COUNT; s++)
+		stageTimes[s] = malloc(sizeof(double) * frames);
+
+	for (int frame = -warmup; frame < frames; frame++)
+	{
+		double posX, posY, dirX, dirY, planeX, planeY;
+		Uint64 stamps[STAGE_COUNT + 1];
+		/*Cycle through the weapon states so every sprite gets drawn*/
+		WeaponState weaponState = (WeaponState)((frame + warmup) / 8 % 4);
+		/*A shot's smoke whenever the weapon cycle reaches the fire state*/
+		bool fired = (frame + warmup) % 32 == 8;
+
+		if (replay.log)
+		{
+			Player view;
+
+			/*Warm-up frames render the start of the session without playing it*/
+			fired = frame >= 0 && runTick(&replay.game, replay.log->ticks[frame], frame);
+			weaponState = replay.game.weaponState;
+			view = replay.game.player;
+			fitViewToAspect(&view, cameraTables.width, cameraTables.height);
+			posX = view.posX;
+			posY = view.posY;
+			dirX = view.dirX;
+			dirY = view.dirY;
+			planeX = view.planeX;
+			planeY = view.planeY;
+		}
+		else
+			getCameraAt(frame + warmup, &posX, &posY, &dirX, &dirY, &planeX, &planeY);
+
+		stamps[STAGE_RAYCASTING] = SDL_GetPerformanceCounter();
+		SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
+		SDL_RenderClear(renderer);
+		if (options.renderMode == RENDER_SDL)
+			SDL_RenderSetScale(renderer, (float)resolution.outputWidth / resolution.width,
+					(float)resolution.outputHeight / resolution.height);
+		if (options.renderMode == RENDER_SOFTWARE)
+			performRaycastingSoftware(&framebuffer, renderPool, &wallAtlas,
+					options.showSky ? &skyTexture : NULL,
+					posX, posY, dirX, dirY, planeX, planeY);
+		else
+			performRaycasting(renderer, &wallMipmaps, &skyTexture, posX, posY,
+					dirX, dirY, planeX, planeY);
+		stamps[STAGE_FLOOR] = SDL_GetPerformanceCounter();
+		if (options.renderMode == RENDER_SOFTWARE)
+			performFloorCasting(&framebuffer, renderPool, &floorTextures, !options.showSky,
+					posX, posY, dirX, dirY, planeX, planeY);
+		stamps[STAGE_SPRITES] = SDL_GetPerformanceCounter();
+		prepareSprites(sprites, (frame + warmup) / 60.0, posX, posY, dirX, dirY, planeX, planeY);
+		if (options.renderMode == RENDER_SOFTWARE)
+		{
+			drawSpritesSoftware(sprites, &framebuffer, renderPool);
+			presentFramebuffer(&framebuffer, renderer);
+		}
+		else
+		{
+			drawSprites(sprites, renderer);
+			SDL_RenderSetScale(renderer, 1, 1);
+		}
+		stamps[STAGE_MINIMAP] = SDL_GetPerformanceCounter();
+		revealMinimapCells(&minimap, columnHits, posX, posY, dirX, dirY, planeX, planeY);
+		drawMiniMap(renderer, &minimap, options.minimapZoom, posX, posY, dirX, dirY);
+		stamps[STAGE_PARTICLES] = SDL_GetPerformanceCounter();
+		if (fired)
+			emitMuzzleSmoke(particles, muzzleX, muzzleY, MUZZLE_SMOKE_PUFFS);
+		updateParticles(particles, 1.0f / 60);
+		drawParticles(particles, renderer);
+		stamps[STAGE_WEAPON] = SDL_GetPerformanceCounter();
+		renderWeapon(renderer, weaponTextures, weaponState);
+		stamps[STAGE_PRESENT] = SDL_GetPerformanceCounter();
+		SDL_RenderPresent(renderer);
+		stamps[STAGE_COUNT] = SDL_GetPerformanceCounter();
+
+		if (frame < 0)
+			continue;
+		reusedColumns += SDL_AtomicGet(&rayCache.reused);
+		for (int s = 0; s < STAGE_COUNT; s++)
+			stageTimes[s][frame] = (stamps[s + 1] - stamps[s]) * msPerTick;
+		frameTimes[frame] = (stamps[STAGE_COUNT] - stamps[0]) * msPerTick;
+	}
+
+	/*Before printStats sorts the samples*/
+	if (timingsPath && !writeTimings(timingsPath, frameTimes, stageTimes, frames))
+		return (1);
+	if (outputPath && !(out = fopen(outputPath, "w")))
+	{
+		fprintf(stderr, "Failed to open %s\n", outputPath);
+		return (1);
+	}
+	fprintf(out, "{\n  \"backend\": \"%s\",\n  \"kernel\": \"%s\",\n"
+			"  \"threads\": %d,\n  \"width\": %d,\n  \"height\": %d,\n"
+			"  \"output_width\": %d,\n  \"output_height\": %d,\n"
+			"  \"frames\": %d,\n  \"lighting\": %s,\n  \"lightmap_bake_ms\": %.3f,\n"
+			"  \"ray_cache_reuse\": %.4f,\n  \"frame_ms\": ",
+			options.renderMode == RENDER_SOFTWARE ? "software" : "sdl",
+			getRayKernelName(options.rayKernel), renderPool->threadCount,
+			resolution.width, resolution.height,
+			resolution.outputWidth, resolution.outputHeight, frames,
+			options.lighting ? "true" : "false", bakeMs, reusedColumns / ((double)frames * resolution.width));
+	printStats(out, frameTimes, frames);
+	fprintf(out, ",\n  \"stages_ms\": {\n");
+	for (int s = 0; s < STAGE_COUNT; s++)
+	{
+		fprintf(out, "    \"%s\": ", stageNames[s]);
+		printStats(out, stageTimes[s], frames);
+		fprintf(out, s + 1 < STAGE_COUNT ? ",\n" : "\n");
+	}
+	fprintf(out, "  }\n}\n");
+	if (out != stdout)
+		fclose(out);
+
+	for (int s = 0; s < STAGE_COUNT; s++)
+		free(stageTimes[s]);
+	free(frameTimes);
+	free(renderArgs);
+	destroyWallMipmaps(&wallMipmaps);
+	destroyWallAtlas(&wallAtlas);
+	destroyFloorTextures(&floorTextures);
+	destroyCameraTables();
+	destroyAssetLoader(assets);
+	destroyTextureCache(textures);
+	destroyMinimap(&minimap);
+	destroyParticleSystem(particles);
+	destroyEntityGrid(replay.game.npcs);
+	destroyInputLog(replay.log);
+	destroyLightmap(&lightmap);
+	destroySpriteSet(sprites);
+	destroyFramebuffer(&framebuffer);
+	destroyThreadPool(renderPool);
+	SDL_DestroyRenderer(renderer);
+	SDL_FreeSurface(target);
+	IMG_Quit();
+	freeMap(&worldMap);
+	SDL_Quit();
+	return (0);
+}
@@ -0,0 +1,68 @@
+#ifndef ASSETS_H
+#define ASSETS_H
+
+#include "main.h"
+#include "texture_cache.h"
+
+#define ASSET_MANIFEST "./resources/manifest.txt"
+#define ASSET_PATH_LENGTH 128
+/*Textures created on the render thread per frame once the game is running*/
+#define ASSET_UPLOADS_PER_FRAME 4
+
+typedef enum {
+	ASSET_IMAGE,
+	ASSET_SOUND,
+	ASSET_MUSIC
+} AssetKind;
+
+/*
+ * Workers move an asset from queued to decoded (images) or straight to
+ * ready (audio); the render thread hands decoded images to the texture
+ * cache, which makes them ready.
+ */
+typedef enum {
+	ASSET_QUEUED,
+	ASSET_DECODED,
+	ASSET_READY,
+	ASSET_FAILED
+} AssetState;
+
+/*One manifest entry and whatever has been loaded for it so far*/
+typedef struct {
+	AssetKind kind;
+	bool critical;
+	char path[ASSET_PATH_LENGTH];
+	SDL_atomic_t state;
+	SDL_Surface *surface; /* decoded pixels until they go to the cache */
+	Mix_Chunk *sound;
+	Mix_Music *music;
+} Asset;
+
+/*
+ * Assets from the manifest, critical ones first, decoded by worker threads
+ * in that order while the render thread uploads the finished images into
+ * the texture cache.
+ */
+typedef struct {
+	Asset *assets;
+	TextureCache *textures;
+	int count;
+	int criticalCount;
+	SDL_Thread **threads;
+	int threadCount;
+	SDL_atomic_t next;
+	SDL_atomic_t quit;
+	SDL_sem *finished;
+	/*Render thread only: assets before this one are ready or failed*/
+	int settled;
+	Uint64 startTime;
+} AssetLoader;
+
+AssetLoader *createAssetLoader(const char *manifestPath, TextureCache *textures, bool loadAudio);
+int pumpAssetUploads(AssetLoader *loader, int maxUploads);
+bool waitForAssets(AssetLoader *loader, bool criticalOnly);
+Mix_Chunk *getSoundAsset(const AssetLoader *loader, const char *path);
+Mix_Music *getMusicAsset(const AssetLoader *loader, const char *path);
+void destroyAssetLoader(AssetLoader *loader);
+
+#endif
@@ -0,0 +1,38 @@
+#ifndef CAMERA_H
+#define CAMERA_H
+
+#include "main.h"
+
+/*The view turns in whole steps of 2 pi / ANGLE_STEPS radians*/
+#define ANGLE_STEPS 4096
+#define ANGLE_MASK (ANGLE_STEPS - 1)
+/*Steps turned per tick while a rotation key is held, about 0.03 radians*/
+#define ROTATION_STEPS 20
+/*Half the camera plane, for a field of view of about 66 degrees*/
+#define CAMERA_PLANE 0.66
+
+/*
+ * View direction and camera plane of every quantized angle, and the
+ * camera-space x of every column of the internal render resolution.
+ * Both are computed once, so a frame's ray directions only take a
+ * multiply-add per component, and the same angle index always gives
+ * bit-identical rays. width and height are the size the 3D view is
+ * rendered at, which every renderer reads.
+ */
+typedef struct {
+	double dirX[ANGLE_STEPS], dirY[ANGLE_STEPS];
+	double planeX[ANGLE_STEPS], planeY[ANGLE_STEPS];
+	double *cameraX; /* from -1 at the left edge towards 1 at the right */
+	int width;
+	int height;
+} CameraTables;
+
+extern CameraTables cameraTables;
+
+void fillCameraColumns(double *cameraX, int width);
+bool initCameraTables(int width, int height);
+void setPlayerAngle(Player *player, int angle);
+void fitViewToAspect(Player *view, int width, int height);
+void destroyCameraTables(void);
+
+#endif
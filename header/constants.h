@@ -2,9 +2,15 @@
 #ifndef CONSTANTS_H
 #define CONSTANTS_H
 
+/*Window size at startup; the HUD is laid out for this height and scaled with the window*/
 #define SCREEN_WIDTH 640
 #define SCREEN_HEIGHT 480
-#define MAP_WIDTH 24
-#define MAP_HEIGHT 24
+/*Largest internal render resolution, which sizes the per-column buffers*/
+#define MAX_RENDER_WIDTH 3840
+#define MAX_RENDER_HEIGHT 2160
+/*Wall types 1 to WALL_TEXTURE_COUNT, each with its own texture*/
+#define WALL_TEXTURE_COUNT 5
+/*Fixed simulation steps per second*/
+#define TICK_RATE 60
 
 #endif // CONSTANTS_H
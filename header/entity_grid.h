@@ -0,0 +1,41 @@
+#ifndef ENTITY_GRID_H
+#define ENTITY_GRID_H
+
+#include "main.h"
+
+/*Entities are no wider than a map cell, so one can only reach into the neighbouring cells*/
+#define ENTITY_MAX_RADIUS 0.5f
+/*Hit radius of an NPC*/
+#define NPC_RADIUS 0.3f
+
+/*
+ * Spatial hash of entities keyed by the worldMap cell their centre is in.
+ * Each bucket is a doubly linked list through the per-entity next and
+ * prev arrays, so moving an entity to another cell is O(1) and the table
+ * only grows with the number of entities, not with the map. Entity ids
+ * are chosen by the caller, from 0 to capacity - 1.
+ */
+typedef struct {
+	int *heads;      /* first entity of each bucket, -1 if empty */
+	int bucketMask;  /* buckets - 1, a power of two */
+	int *next, *prev;
+	int *cellX, *cellY;
+	float *x, *y;
+	float *radius;
+	bool *active;
+	int capacity;
+	int count;
+} EntityGrid;
+
+EntityGrid *createEntityGrid(int capacity);
+bool insertEntity(EntityGrid *grid, int id, float x, float y, float radius);
+void moveEntity(EntityGrid *grid, int id, float x, float y);
+void removeEntity(EntityGrid *grid, int id);
+void renumberEntity(EntityGrid *grid, int from, int to);
+int castEntityRay(const EntityGrid *grid, double posX, double posY, double dirX, double dirY,
+		double *distance);
+int queryEntityRadius(const EntityGrid *grid, float x, float y, float radius,
+		int *results, int maxResults);
+void destroyEntityGrid(EntityGrid *grid);
+
+#endif
@@ -0,0 +1,42 @@
+#ifndef FLOORCAST_H
+#define FLOORCAST_H
+
+#include "main.h"
+#include "framebuffer.h"
+#include "threadpool.h"
+#include "textures.h"
+
+/*Wall textures tiled over the floor and the ceiling, one per map cell*/
+#define FLOOR_TEXTURE 0
+#define CEILING_TEXTURE 2
+/*Rows claimed at once by a render worker, each a floor row and its ceiling row*/
+#define FLOOR_ROW_STRIP 8
+/*Enough halvings to take a 65536 texel side down to one texel*/
+#define FLOOR_MAX_LEVELS 17
+
+/*One level of a mip chain, stored row by row*/
+typedef struct {
+	Uint32 offset;   /* first texel of the level */
+	int widthShift;  /* log2 of the texels per row */
+	int heightShift; /* log2 of the rows */
+} FloorLevel;
+
+/*
+ * Floor and ceiling textures for the software renderer. Unlike the wall
+ * atlas they are kept row-major, and with every power-of-two reduction,
+ * so a row of the floor far away reads a small level that stays in cache
+ * rather than skipping across the full-size texture.
+ */
+typedef struct {
+	Uint32 *texels;
+	FloorLevel levels[2][FLOOR_MAX_LEVELS]; /* floor, then ceiling */
+	int levelCount[2];
+} FloorTextures;
+
+bool createFloorTextures(FloorTextures *floors, const WallAtlas *wallAtlas);
+void performFloorCasting(Framebuffer *fb, ThreadPool *pool, const FloorTextures *floors,
+		bool ceiling, double posX, double posY, double dirX, double dirY,
+		double planeX, double planeY);
+void destroyFloorTextures(FloorTextures *floors);
+
+#endif
@@ -0,0 +1,93 @@
+#ifndef FLOW_FIELD_H
+#define FLOW_FIELD_H
+
+#include <math.h>
+#include "main.h"
+
+/*A field covers FLOW_SIZE x FLOW_SIZE cells around its goal, its outer ring kept as walls*/
+#define FLOW_SHIFT 8
+#define FLOW_SIZE (1 << FLOW_SHIFT)
+#define FLOW_MASK (FLOW_SIZE - 1)
+/*Cells a frame may visit while building the next field*/
+#define FLOW_CELLS_PER_FRAME 16384
+/*Distance of walls, and of the open cells the search has not reached*/
+#define FLOW_WALL 0xFFFE
+#define FLOW_UNREACHED 0xFFFF
+/*Step of the goal, of walls, and of the cells the goal cannot be reached from*/
+#define FLOW_NO_STEP 0xFF
+
+/*A finished or half-built field toward one goal cell*/
+typedef struct {
+	int originX, originY; /* map cell of the window's first cell */
+	int goalX, goalY;
+	uint32_t mapVersion;  /* worldMap.version the walls were read at */
+	int reached;          /* cells the goal can be reached from */
+	Uint16 *distance;     /* steps to the goal of every window cell */
+	Uint8 *step;          /* (dx + 1) | (dy + 1) << 2 toward the goal, or FLOW_NO_STEP */
+} FlowLayer;
+
+/*What the layer being built is going through*/
+typedef enum {
+	FLOW_IDLE,   /* nothing to build: the ready layer is up to date */
+	FLOW_WALLS,  /* copying the window's walls from the map */
+	FLOW_SPREAD  /* breadth-first search out from the goal */
+} FlowPhase;
+
+/*
+ * Flow field toward the player for any number of NPCs. A breadth-first
+ * search from the player's cell gives every cell of the window its
+ * distance in steps, and every cell keeps the neighbour, diagonals
+ * included when no wall corner is cut, that is nearest the goal. An NPC
+ * steers by reading the step of the cell it stands in, whatever the
+ * number of NPCs. A new field is only built when the player enters
+ * another cell or the map's version changes, into the second layer and
+ * a bounded number of cells per call, while NPCs keep reading the last
+ * finished one. A build is never abandoned, so a player walking faster
+ * than the builds still gets a field at most one build behind.
+ */
+typedef struct {
+	FlowLayer layers[2];
+	int ready;      /* layer NPCs read, -1 until the first is built */
+	FlowPhase phase;
+	int row;        /* next window row whose walls are copied */
+	int *queue;     /* window cells in the order the search reached them */
+	int head;       /* next cell of queue to spread from */
+	int rebuilds;   /* layers finished so far */
+} FlowField;
+
+FlowField *createFlowField(void);
+int updateFlowField(FlowField *field, const Map *map, int goalX, int goalY, int budget);
+void destroyFlowField(FlowField *field);
+
+/**
+ * getFlowStep - function looks up where an NPC should head for
+ * @field: pointer to the flow field
+ * @x: NPC position on the x axis
+ * @y: NPC position on the y axis
+ * @dx: receives the step along x, -1, 0 or 1
+ * @dy: receives the step along y, -1, 0 or 1
+ *
+ * Return: true if the cell has a step toward the goal, false if the NPC
+ * is on the goal, outside the field, or cannot reach the goal
+ */
+static inline bool getFlowStep(const FlowField *field, float x, float y, int *dx, int *dy)
+{
+	const FlowLayer *layer;
+	int cellX, cellY, step;
+
+	if (field->ready < 0)
+		return (false);
+	layer = &field->layers[field->ready];
+	cellX = (int)floorf(x) - layer->originX;
+	cellY = (int)floorf(y) - layer->originY;
+	if ((unsigned)cellX >= FLOW_SIZE || (unsigned)cellY >= FLOW_SIZE)
+		return (false);
+	step = layer->step[(cellY << FLOW_SHIFT) | cellX];
+	if (step == FLOW_NO_STEP)
+		return (false);
+	*dx = (step & 3) - 1;
+	*dy = (step >> 2) - 1;
+	return (true);
+}
+
+#endif
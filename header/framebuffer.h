@@ -0,0 +1,29 @@
+#ifndef FRAMEBUFFER_H
+#define FRAMEBUFFER_H
+
+#include "main.h"
+
+/*
+ * CPU-side ARGB8888 frame uploaded to a streaming texture once per frame.
+ * The buffers and the texture are allocated for the largest size asked
+ * for, so the render resolution can drop and rise again without
+ * reallocating; rows are width pixels apart at any size.
+ */
+typedef struct {
+	Uint32 *pixels;
+	double *depth; /* perpendicular wall distance of every column */
+	int *drawStart; /* first row of every column's wall slice */
+	int *drawEnd;   /* one past the last row of every column's wall slice */
+	int width;
+	int height;
+	int maxWidth;   /* size the buffers and the texture were allocated for */
+	int maxHeight;
+	SDL_Texture *texture;
+} Framebuffer;
+
+bool createFramebuffer(Framebuffer *fb, SDL_Renderer *renderer, int width, int height);
+bool resizeFramebuffer(Framebuffer *fb, SDL_Renderer *renderer, int width, int height);
+void presentFramebuffer(Framebuffer *fb, SDL_Renderer *renderer);
+void destroyFramebuffer(Framebuffer *fb);
+
+#endif
@@ -2,7 +2,29 @@
 #define INPUT_H
 
 #include "main.h"
+#include "options.h"
+#include "entity_grid.h"
+#include "sprites.h"
 
-void handlePlayerInput(SDL_Event* event, bool* running, bool* showMiniMap, bool* showRain, double* posX, double* posY, double* dirX, double* dirY, double* planeX, double* planeY);
+/*Map cell the player starts in, facing along -x, if it is empty*/
+#define SPAWN_X 22
+#define SPAWN_Y 12
+
+/*Everything a simulation tick changes, so the game and replays run the same ticks*/
+typedef struct {
+    Player player;
+    WeaponState weaponState;
+    Uint32 weaponStateTime; /* simulation time (ms) the weapon entered its current state */
+    EntityGrid* npcs;       /* NPCs indexed by map cell, with their sprite index as id */
+    SpriteSet* sprites;
+} GameState;
+
+void handlePlayerInput(SDL_Event* event, bool* running, bool* showMiniMap, bool* showRain, GameOptions* options);
+Uint8 readTickInput(bool fire);
+void updatePlayerMovement(Player* player, Uint8 input);
+void interpolatePlayer(const Player* previous, const Player* current, double alpha, Player* out);
+bool spawnPlayer(Player* player);
+bool initGameState(GameState* game, SpriteSet* sprites);
+bool runTick(GameState* game, Uint8 input, Uint64 tick);
 
 #endif
@@ -0,0 +1,53 @@
+#ifndef INPUT_LOG_H
+#define INPUT_LOG_H
+
+#include "main.h"
+
+/*What the player asked for during one simulation tick, one bit each*/
+#define INPUT_FORWARD 0x01
+#define INPUT_BACKWARD 0x02
+#define INPUT_TURN_LEFT 0x04
+#define INPUT_TURN_RIGHT 0x08
+#define INPUT_FIRE 0x10
+
+/*
+ * Input log file: an InputLogHeader, then runCount runs of two bytes,
+ * the input of a tick and how many ticks in a row had it (1 to 255).
+ * All fields are little-endian.
+ */
+#define INPUT_LOG_MAGIC "RCIN"
+#define INPUT_LOG_VERSION 1
+
+typedef struct {
+	char magic[4];
+	uint16_t version;
+	uint16_t tickRate; /* TICK_RATE of the game that recorded it */
+	uint32_t seed; /* sprite scatter and particle seed of the session */
+	uint32_t extraSprites; /* --sprites N of the session */
+	uint32_t tickCount;
+	uint32_t runCount;
+	uint64_t mapChecksum; /* hashMapCells of the map played */
+} InputLogHeader;
+
+/*
+ * The input of every tick of a session. Movement, collision and the
+ * weapon only depend on it, the map and the seed, so feeding it back
+ * replays the session exactly, at any frame rate and without a window.
+ */
+typedef struct {
+	Uint8 *ticks; /* one input per tick */
+	int tickCount;
+	int capacity;
+	Uint32 seed;
+	int extraSprites;
+	uint64_t mapChecksum;
+} InputLog;
+
+uint64_t getMapChecksum(const Map *map);
+InputLog *createInputLog(Uint32 seed, int extraSprites, uint64_t mapChecksum);
+bool recordTick(InputLog *log, Uint8 input);
+bool saveInputLog(const InputLog *log, const char *path);
+InputLog *loadInputLog(const char *path);
+void destroyInputLog(InputLog *log);
+
+#endif
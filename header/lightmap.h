@@ -0,0 +1,140 @@
+#ifndef LIGHTMAP_H
+#define LIGHTMAP_H
+
+#include "main.h"
+#include "raycast.h"
+#include "sprites.h"
+
+/*Lightmap blocks cover LIGHT_REGION x LIGHT_REGION cells*/
+#define LIGHT_REGION_SHIFT 4
+#define LIGHT_REGION (1 << LIGHT_REGION_SHIFT)
+/*Light samples along each wall face, picked by wallX*/
+#define LIGHT_FACE_SAMPLES 4
+/*Light of faces no light reaches, and of the floor and ceiling*/
+#define LIGHT_AMBIENT_LEVEL 0x78
+#define LIGHT_AMBIENT (LIGHT_AMBIENT_LEVEL * 0x010101u)
+/*Shade that leaves a texel as it is*/
+#define LIGHT_FULL 0x00FFFFFF
+/*Farthest any light reaches, in cells*/
+#define LIGHT_MAX_RADIUS 8.0f
+/*Fog table entries per cell of distance, and how far the table reaches*/
+#define FOG_STEPS_PER_CELL 16
+#define FOG_STEPS 1024
+/*Distance the fog starts at, and how quickly it thickens past it*/
+#define FOG_START 4.0
+#define FOG_DENSITY 0.06
+
+/*A point light standing in an open cell*/
+typedef struct {
+	float x, y;
+	float radius;  /* distance at which it no longer adds anything */
+	Uint32 color;  /* 0x00RRGGBB added at the light itself */
+} Light;
+
+/*
+ * Light on every wall face of worldMap, baked when the level loads, and
+ * the fog of every distance. Faces are lit by the lights they can see,
+ * falling off with distance and angle, on top of LIGHT_AMBIENT, which is
+ * all the floor and ceiling get. Only the
+ * blocks of cells some light reaches are stored; the others read the
+ * ambient light. Adding, moving or removing a light, or changing a wall
+ * with setMapCell, marks the blocks it can touch, and bakeLightmap
+ * rebakes only those. Drawing a column then costs a block
+ * lookup, a fog table lookup and a multiply per channel.
+ */
+typedef struct {
+	bool enabled;
+	Light *lights;
+	int lightCount;
+	int lightCapacity;
+	int regionsX, regionsY;
+	Uint32 **regions; /* per block, LIGHT_FACE_SAMPLES per face, 4 faces per cell, or NULL */
+	bool *dirty;      /* blocks to rebake */
+	int dirtyCount;
+	uint32_t mapVersion; /* worldMap.version whose changed cells are marked */
+	Uint16 fog[FOG_STEPS]; /* brightness left at each distance, 256 for none */
+} Lightmap;
+
+extern Lightmap lightmap;
+
+bool initLightmap(Lightmap *lights, int width, int height);
+int addLight(Lightmap *lights, float x, float y, float radius, Uint32 color);
+void moveLight(Lightmap *lights, int i, float x, float y);
+void removeLight(Lightmap *lights, int i);
+bool addSpriteLights(Lightmap *lights, const SpriteSet *sprites);
+void updateLightCell(Lightmap *lights, int x, int y);
+int bakeLightmap(Lightmap *lights);
+void destroyLightmap(Lightmap *lights);
+
+/**
+ * getWallFace - function tells which face of its cell a ray hit
+ * @hit: pointer to the ray hit
+ *
+ * Return: 0 east, 1 west, 2 north, 3 south
+ */
+static inline int getWallFace(const RayHit *hit)
+{
+	return (hit->side * 2 + hit->flipTex);
+}
+
+/**
+ * getFog - function looks up the fog at a distance
+ * @lights: pointer to the lightmap
+ * @distance: distance along the view direction, in cells
+ *
+ * Return: brightness left, from 0 to 256 for no fog
+ */
+static inline Uint32 getFog(const Lightmap *lights, double distance)
+{
+	if (!(distance < (double)FOG_STEPS / FOG_STEPS_PER_CELL))
+		return (lights->fog[FOG_STEPS - 1]);
+	return (lights->fog[(int)(SDL_max(distance, 0) * FOG_STEPS_PER_CELL)]);
+}
+
+/**
+ * getColumnShade - function finds how a wall column is lit and fogged
+ * @lights: pointer to the lightmap
+ * @hit: pointer to the column's ray hit
+ *
+ * Return: per channel multipliers as 0x00RRGGBB, LIGHT_FULL for none
+ */
+static inline Uint32 getColumnShade(const Lightmap *lights, const RayHit *hit)
+{
+	const Uint32 *block;
+	Uint32 light = LIGHT_AMBIENT, fog, shade = 0;
+
+	if (!lights->enabled)
+		return (LIGHT_FULL);
+	block = lights->regions[(hit->mapY >> LIGHT_REGION_SHIFT) * lights->regionsX
+		+ (hit->mapX >> LIGHT_REGION_SHIFT)];
+	if (block)
+	{
+		int cell = ((hit->mapY & (LIGHT_REGION - 1)) << LIGHT_REGION_SHIFT)
+			| (hit->mapX & (LIGHT_REGION - 1));
+
+		light = block[(cell * 4 + getWallFace(hit)) * LIGHT_FACE_SAMPLES
+			+ (int)(hit->wallX * LIGHT_FACE_SAMPLES)];
+	}
+	fog = getFog(lights, hit->perpWallDist);
+	for (int shift = 0; shift < 24; shift += 8)
+		shade |= (((light >> shift & 0xFF) * fog) >> 8) << shift;
+	return (shade);
+}
+
+/**
+ * shadeTexel - function multiplies a texel by a shade
+ * @texel: ARGB8888 texel
+ * @shade: per channel multipliers from getColumnShade
+ *
+ * Return: the shaded texel; LIGHT_FULL leaves it unchanged
+ */
+static inline Uint32 shadeTexel(Uint32 texel, Uint32 shade)
+{
+	Uint32 result = texel & 0xFF000000;
+
+	for (int shift = 0; shift < 24; shift += 8)
+		result |= (((texel >> shift & 0xFF) * ((shade >> shift & 0xFF) + 1)) >> 8) << shift;
+	return (result);
+}
+
+#endif
@@ -5,7 +5,6 @@
 #include <SDL2/SDL_image.h>
 #include <SDL2/SDL_mixer.h>
 #include "constants.h"
-#include "raindrops.h"
 #include <stdbool.h>
 #include "map.h"
 
@@ -20,13 +19,24 @@ typedef enum {
     WEAPON_RELOAD
 } WeaponState;
 
+typedef enum {
+    RENDER_SDL,
+    RENDER_SOFTWARE
+} RenderMode;
+
+/*Player position, view direction and camera plane*/
+typedef struct {
+    double posX, posY;
+    double dirX, dirY;
+    double planeX, planeY;
+    int angle; /* index into the camera tables that dir and plane come from */
+} Player;
+
 typedef struct {
     SDL_Texture* texture;
+    SDL_Surface* surface; /* ARGB8888 pixels kept for the software renderer */
     int width;
     int height;
 } TextureData;
 
-void initializeRaindrops();
-void handlePlayerInput(SDL_Event* event, bool* running, bool* showMiniMap, bool* showRain, double* posX, double* posY, double* dirX, double* dirY, double* planeX, double* planeY);
-
 #endif
@@ -2,11 +2,142 @@
 #ifndef MAP_H
 #define MAP_H
 
-#include "constants.h" // Include the constants for map dimensions
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "constants.h" // Include the constants for wall types
 
-extern int worldMap[MAP_WIDTH][MAP_HEIGHT]; // Map array declaration
+/*
+ * Cells are stored in MAP_TILE x MAP_TILE tiles, row-major inside a tile
+ * and tile by tile across the map, so one 64-byte cache line holds an
+ * 8x8 neighbourhood and a DDA step in either axis usually stays in it.
+ */
+#define MAP_TILE_SHIFT 3
+#define MAP_TILE (1 << MAP_TILE_SHIFT)
+#define MAP_TILE_MASK (MAP_TILE - 1)
+
+/*
+ * Occupancy pyramid for empty-space skipping: the number of walls in
+ * every MAP_REGION x MAP_REGION region, and in every MAP_SECTOR x
+ * MAP_SECTOR sector of regions. The cells of a region without walls also
+ * carry MAP_CELL_OPEN, so the DDA notices it has entered one from the cell
+ * load it makes anyway, and crosses the region, or its sector if that is
+ * empty too, in one jump.
+ */
+#define MAP_REGION_SHIFT 6
+#define MAP_REGION (1 << MAP_REGION_SHIFT)
+#define MAP_SECTOR_SHIFT 9
+#define MAP_SECTOR (1 << MAP_SECTOR_SHIFT)
+#define MAP_CELL_OPEN 0x80
+#define MAP_WALL_MASK 0x7F
+
+/*Bytes allocated past the last tile so 32-bit gathers may read the last cell*/
+#define MAP_PADDING 4
+/*Latest setMapCell changes kept for caches that follow the map cell by cell*/
+#define MAP_CHANGE_LOG 64
+
+/*Level whose size comes from the map file*/
+typedef struct {
+	int width;
+	int height;
+	int tilesX;
+	int tilesY;
+	uint8_t *cells;
+	void *mapping; /* mmap of a binary map file, NULL when cells are heap owned */
+	size_t mappingSize;
+	int regionsX;
+	int regionsY;
+	int sectorsX;
+	int sectorsY;
+	uint16_t *regionWalls; /* walls per region, regionsX * regionsY */
+	uint32_t *sectorWalls; /* walls per sector, sectorsX * sectorsY */
+	uint32_t version; /* changes whenever a cell does, for caches of what the map looked like */
+	uint32_t logStart; /* version loaded; only the changes made since are logged */
+	uint16_t changedX[MAP_CHANGE_LOG]; /* cell whose change reached each version, */
+	uint16_t changedY[MAP_CHANGE_LOG]; /* at version % MAP_CHANGE_LOG */
+} Map;
+
+/*
+ * Binary map file: a MapFileHeader, then from dataOffset the cells in
+ * exactly the tiled layout of Map.cells, followed by MAP_PADDING zero
+ * bytes, so the payload can be mapped and used without any parsing.
+ * All fields are little-endian.
+ */
+#define MAP_FILE_MAGIC "RCMP"
+#define MAP_FILE_VERSION 1
+#define MAP_CELL_UINT8 1
+#define MAP_FILE_ALIGN 64
+/*Largest side a map may have, so cell offsets fit in an int*/
+#define MAP_MAX_SIZE (1 << 15)
+
+typedef struct {
+	char magic[4];
+	uint16_t version;
+	uint8_t cellType; /* MAP_CELL_UINT8 */
+	uint8_t tileShift; /* MAP_TILE_SHIFT the payload was tiled with */
+	uint32_t width;
+	uint32_t height;
+	uint32_t dataOffset; /* start of the cells, a multiple of MAP_FILE_ALIGN */
+	uint32_t flags; /* reserved, 0 */
+	uint64_t dataSize; /* bytes of tiled cells, without the padding */
+	uint64_t checksum; /* hashMapCells of the payload */
+} MapFileHeader;
+
+extern Map worldMap; // Map declaration
+
+/**
+ * getMapCellIndex - function finds where a cell lives in Map.cells
+ * @map: pointer to the map
+ * @x: cell column
+ * @y: cell row
+ *
+ * Return: byte offset of the cell
+ */
+static inline int getMapCellIndex(const Map *map, int x, int y)
+{
+	return ((((y >> MAP_TILE_SHIFT) * map->tilesX + (x >> MAP_TILE_SHIFT))
+				<< (2 * MAP_TILE_SHIFT)) | ((y & MAP_TILE_MASK) << MAP_TILE_SHIFT)
+			| (x & MAP_TILE_MASK));
+}
+
+/**
+ * getMapCell - function reads a cell of the map
+ * @map: pointer to the map
+ * @x: cell column
+ * @y: cell row
+ *
+ * Return: 0 for empty space, otherwise the wall type
+ */
+static inline int getMapCell(const Map *map, int x, int y)
+{
+	return (map->cells[getMapCellIndex(map, x, y)] & MAP_WALL_MASK);
+}
+
+/**
+ * getOpenBlockShift - function finds the largest empty block around an open cell
+ * @map: pointer to the map
+ * @x: column of a cell marked MAP_CELL_OPEN
+ * @y: row of the cell
+ *
+ * Return: MAP_SECTOR_SHIFT if the sector holding the cell has no walls,
+ * otherwise MAP_REGION_SHIFT
+ */
+static inline int getOpenBlockShift(const Map *map, int x, int y)
+{
+	if (map->sectorWalls[(y >> MAP_SECTOR_SHIFT) * map->sectorsX + (x >> MAP_SECTOR_SHIFT)] == 0)
+		return (MAP_SECTOR_SHIFT);
+	return (MAP_REGION_SHIFT);
+}
 
 // Function declarations
 void loadMap(const char* filename);
+bool createMap(Map *map, int width, int height);
+void freeMap(Map *map);
+uint64_t hashMapCells(const uint8_t *cells, size_t size);
+bool saveMapBinary(const Map *map, const char *filename);
+void buildMapOccupancy(Map *map);
+void setMapCell(Map *map, int x, int y, int value);
+bool getMapChange(const Map *map, uint32_t version, int *x, int *y);
+bool findEmptyCell(const Map *map, int x, int y, int *foundX, int *foundY);
 
 #endif // MAP_H
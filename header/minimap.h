@@ -0,0 +1,44 @@
+#ifndef MINIMAP_H
+#define MINIMAP_H
+
+#include "main.h"
+#include "raycast.h"
+
+/*Map cells kept drawn in the cached texture, one texel per cell*/
+#define MINIMAP_CACHE_CELLS 256
+/*Screen size of the minimap; at the default zoom a cell is MINIMAP_SCALE pixels*/
+#define MINIMAP_SIZE (24 * MINIMAP_SCALE)
+/*Cells across the minimap are 12 << zoom*/
+#define MINIMAP_ZOOM_LEVELS 4
+#define MINIMAP_DEFAULT_ZOOM 1
+/*How far from the player the rays uncover the fog, in cells*/
+#define MINIMAP_REVEAL_RADIUS 16
+/*Every this many screen columns also uncover the floor along their ray*/
+#define MINIMAP_REVEAL_STRIDE 4
+/*Cells queued for redrawing before the whole cache is redrawn instead*/
+#define MINIMAP_DIRTY_MAX 4096
+
+/*
+ * Minimap drawn once into a render target covering a window of the map,
+ * so a frame only blits the visible part. Cells change on the texture when
+ * they are first seen or invalidated; the window moves when the view leaves it.
+ */
+typedef struct {
+	SDL_Texture *texture;
+	int originX, originY; /* map cell drawn at the texture's top left */
+	bool redraw;          /* the whole window needs drawing */
+	Uint8 *explored;      /* one bit per map cell seen by the raycaster */
+	int dirtyCount;
+	SDL_Point dirty[MINIMAP_DIRTY_MAX];
+} Minimap;
+
+bool createMinimap(Minimap *minimap, SDL_Renderer *renderer);
+void revealMinimapCells(Minimap *minimap, const RayHit hits[], double posX, double posY,
+		double dirX, double dirY, double planeX, double planeY);
+void invalidateMinimapCell(Minimap *minimap, int x, int y);
+void invalidateMinimap(Minimap *minimap);
+void drawMiniMap(SDL_Renderer *renderer, Minimap *minimap, int zoom,
+		double posX, double posY, double dirX, double dirY);
+void destroyMinimap(Minimap *minimap);
+
+#endif
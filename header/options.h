@@ -0,0 +1,41 @@
+#ifndef OPTIONS_H
+#define OPTIONS_H
+
+#include "main.h"
+#include "raycast.h"
+
+/*How the main loop paces presented frames*/
+typedef enum {
+	PACING_VSYNC,
+	PACING_CAP,
+	PACING_UNCAPPED
+} FramePacing;
+
+/*Settings chosen on the command line*/
+typedef struct {
+	RenderMode renderMode;
+	int threadCount; /* software render threads, 0 for one per core */
+	RayKernel rayKernel; /* widest DDA kernel to use if the CPU has it */
+	FramePacing pacing;
+	int fpsCap; /* frames per second when pacing is PACING_CAP */
+	bool showProfiler;
+	bool showSky; /* sky over the software renderer instead of a textured ceiling */
+	int minimapZoom; /* 0 to MINIMAP_ZOOM_LEVELS - 1, higher shows more cells */
+	const char *tracePath; /* Chrome trace written on exit */
+	const char *mapPath; /* text or binary map to play */
+	int rainDrops; /* drops falling while rain is on */
+	int extraSprites; /* sprites scattered over the map besides the placed ones */
+	int textureBudgetMB; /* texture cache size before unused textures are evicted */
+	int windowWidth, windowHeight; /* window size at startup */
+	bool fullscreen; /* fill the desktop instead of opening a window */
+	double renderScale; /* internal width over output width, 0 to follow the budget */
+	double frameBudgetMs; /* render time the dynamic resolution aims to stay under */
+	bool rayCache; /* reuse the last frame's ray hits when the camera stands or turns */
+	bool lighting; /* baked wall light and distance fog */
+	const char *recordPath; /* input log written on exit, or NULL */
+	const char *replayPath; /* input log played instead of the keyboard, or NULL */
+} GameOptions;
+
+bool parseOptions(int argc, char *argv[], GameOptions *options);
+
+#endif
@@ -0,0 +1,53 @@
+#ifndef PARTICLES_H
+#define PARTICLES_H
+
+#include "main.h"
+
+/*Rain drops falling while rain is on, unless --rain says otherwise*/
+#define DEFAULT_RAIN_DROPS 1000
+/*Smoke puffs left by one shot*/
+#define MUZZLE_SMOKE_PUFFS 24
+
+typedef enum {
+	PARTICLE_RAIN,
+	PARTICLE_SPLASH,
+	PARTICLE_SMOKE
+} ParticleKind;
+
+/*
+ * Screen-space particles in structure-of-arrays buffers, so the update
+ * and the geometry build stream through each field four particles at a
+ * time. Every particle dies when its age reaches its lifetime; rain is
+ * given the lifetime that lands it on the ground, where it breaks into
+ * splashes.
+ */
+typedef struct {
+	float *x, *y;      /* top left corner at birth, in pixels */
+	float *vx, *vy;    /* pixels per second */
+	float *ay;         /* vertical acceleration, gravity or buoyancy */
+	float *age, *life; /* seconds */
+	float *size;       /* width and height at birth */
+	float *grow;       /* pixels per second the quad grows by on each side */
+	float *stretch;    /* seconds of fall drawn behind the particle, for streaks */
+	Uint8 *kind;
+	int count;
+	int capacity;
+	int rainCount;
+	int rainTarget;
+	int smokeCount;
+	float width, height; /* area the rain falls over, in output pixels */
+	Uint32 random; /* xorshift32 state */
+	float *corners;    /* four vertices per particle, rebuilt every frame */
+	SDL_Color *colors; /* four per particle, set when it spawns */
+	int *indices;      /* six per particle, built once */
+} ParticleSystem;
+
+ParticleSystem *createParticleSystem(int capacity, Uint32 seed);
+void setRainDensity(ParticleSystem *particles, int drops);
+void setParticleArea(ParticleSystem *particles, int width, int height);
+void emitMuzzleSmoke(ParticleSystem *particles, float x, float y, int puffs);
+void updateParticles(ParticleSystem *particles, float seconds);
+void drawParticles(ParticleSystem *particles, SDL_Renderer *renderer);
+void destroyParticleSystem(ParticleSystem *particles);
+
+#endif
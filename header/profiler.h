@@ -0,0 +1,46 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include "main.h"
+#include "texture_cache.h"
+
+/*Parts of the game timed by the profiler*/
+typedef enum {
+	ZONE_MAP_LOAD,
+	ZONE_TEXTURE_LOAD,
+	ZONE_RAYCASTING,
+	ZONE_FLOOR,
+	ZONE_SPRITES,
+	ZONE_MINIMAP,
+	ZONE_WEAPON,
+	ZONE_PARTICLES,
+	ZONE_PRESENT,
+	ZONE_COUNT
+} ProfileZone;
+
+/*Frames kept in the ring buffer, and zone events recorded per frame*/
+#define PROFILE_FRAMES 240
+#define PROFILE_MAX_EVENTS 32
+
+/*
+ * Zones cost two SDL_GetPerformanceCounter calls each and are compiled
+ * out entirely when NDEBUG is defined for release builds.
+ */
+#ifndef NDEBUG
+#define PROFILE_BEGIN(zone) profileBegin(zone)
+#define PROFILE_END(zone) profileEnd(zone)
+#define PROFILE_END_FRAME() profileEndFrame()
+#else
+#define PROFILE_BEGIN(zone) ((void)0)
+#define PROFILE_END(zone) ((void)0)
+#define PROFILE_END_FRAME() ((void)0)
+#endif
+
+void profileBegin(ProfileZone zone);
+void profileEnd(ProfileZone zone);
+void profileEndFrame(void);
+bool loadProfilerOverlay(TextureCache *textures);
+void drawProfilerOverlay(SDL_Renderer *renderer);
+bool writeProfileTrace(const char *path);
+
+#endif
@@ -0,0 +1,153 @@
+#ifndef RAYCAST_H
+#define RAYCAST_H
+
+#include "main.h"
+
+/*Result of casting a single ray through worldMap*/
+typedef struct {
+	double perpWallDist;
+	double wallX;
+	int mapX;
+	int mapY;
+	int side;
+	int flipTex;
+} RayHit;
+
+/*DDA implementations selectable at startup*/
+typedef enum {
+	RAY_KERNEL_SCALAR,
+	RAY_KERNEL_AVX2
+} RayKernel;
+
+/*
+ * The DDA measures distances along the ray in 32.32 fixed point. Adding
+ * deltaDist k times then gives exactly sideDist + k * deltaDist, so a
+ * jump across an empty block computes the same state as stepping, and
+ * every kernel that walks with these values visits the same cells.
+ */
+#define DDA_ONE 4294967296.0
+/*Longer than any ray, yet MAP_SECTOR of them still fit in an int64_t*/
+#define DDA_NEVER ((int64_t)1 << 52)
+
+/*DDA state of a ray, with distances in 32.32 fixed point*/
+typedef struct {
+	int mapX, mapY;
+	/*Direction to go in x and y (+1 or -1)*/
+	int stepX, stepY;
+	/*Length of ray from one x or y-side to the next x or y-side*/
+	int64_t deltaDistX, deltaDistY;
+	/*Length of ray from current position to next x or y-side*/
+	int64_t sideDistX, sideDistY;
+} RayWalk;
+
+/*Called by walkRay for each cell entered; returning false stops the walk*/
+typedef bool (*RayCellVisitor)(void *context, int mapX, int mapY, double distance);
+
+/*Rays traversed together by the widest packet kernel*/
+#define RAY_PACKET_MAX 8
+
+void castRay(double posX, double posY, double rayDirX, double rayDirY, RayHit *result);
+void castRays(double posX, double posY, const double *rayDirX, const double *rayDirY, int count, RayHit *results);
+double walkRay(double posX, double posY, double rayDirX, double rayDirY, double maxDistance, RayCellVisitor visit, void *context);
+void completeRayHit(double posX, double posY, double rayDirX, double rayDirY, int mapX, int mapY, int side, RayHit *result);
+RayKernel selectRayKernel(RayKernel requested);
+const char *getRayKernelName(RayKernel kernel);
+void castRayPacketAVX2(double posX, double posY, const double *rayDirX, const double *rayDirY, RayHit *results);
+void getColumnExtent(double perpWallDist, int screenHeight, int *lineHeight, int *drawStart, int *drawEnd);
+int getTextureX(const RayHit *hit, int texWidth);
+
+/**
+ * toRayDistance - function converts a distance along a ray to fixed point
+ * @distance: distance in multiples of the ray direction
+ *
+ * Return: the distance in 32.32 fixed point, at most DDA_NEVER
+ */
+static inline int64_t toRayDistance(double distance)
+{
+	return (distance < DDA_NEVER / DDA_ONE ? (int64_t)(distance * DDA_ONE + 0.5)
+			: DDA_NEVER);
+}
+
+/**
+ * startRayWalk - function sets up the DDA for a ray
+ * @walk: pointer to the state to fill in
+ * @posX: ray origin on the x axis
+ * @posY: ray origin on the y axis
+ * @rayDirX: ray direction on the x axis
+ * @rayDirY: ray direction on the y axis
+ *
+ * Return: void
+ */
+static inline void startRayWalk(RayWalk *walk, double posX, double posY,
+		double rayDirX, double rayDirY)
+{
+	walk->mapX = (int)posX;
+	walk->mapY = (int)posY;
+	walk->deltaDistX = toRayDistance(fabs(1 / rayDirX));
+	walk->deltaDistY = toRayDistance(fabs(1 / rayDirY));
+
+	/* Calculate step and initial sideDist*/
+	if (rayDirX < 0)
+	{
+		walk->stepX = -1;
+		walk->sideDistX = toRayDistance((posX - walk->mapX) * fabs(1 / rayDirX));
+	} else
+	{
+		walk->stepX = 1;
+		walk->sideDistX = toRayDistance((walk->mapX + 1.0 - posX) * fabs(1 / rayDirX));
+	}
+
+	if (rayDirY < 0)
+	{
+		walk->stepY = -1;
+		walk->sideDistY = toRayDistance((posY - walk->mapY) * fabs(1 / rayDirY));
+	} else
+	{
+		walk->stepY = 1;
+		walk->sideDistY = toRayDistance((walk->mapY + 1.0 - posY) * fabs(1 / rayDirY));
+	}
+}
+
+/**
+ * crossOpenBlock - function carries a ray across the open block it stands in
+ * @walk: DDA state of a ray whose cell is marked MAP_CELL_OPEN
+ *
+ * The ray leaves the block through whichever side it crosses first,
+ * taking every step on the other axis that comes before it. It stops on
+ * the last cell inside the block, with that side next: the caller's
+ * following DDA step leaves the block, landing on the same cell and side
+ * as stepping through every cell would.
+ *
+ * Return: void
+ */
+static inline void crossOpenBlock(RayWalk *walk)
+{
+	int shift = getOpenBlockShift(&worldMap, walk->mapX, walk->mapY);
+	int mask = (1 << shift) - 1;
+	/*Sides left to cross inside the block on each axis*/
+	int innerX = walk->stepX > 0 ? mask - (walk->mapX & mask) : walk->mapX & mask;
+	int innerY = walk->stepY > 0 ? mask - (walk->mapY & mask) : walk->mapY & mask;
+	int64_t exitX = walk->sideDistX + innerX * walk->deltaDistX;
+	int64_t exitY = walk->sideDistY + innerY * walk->deltaDistY;
+	int64_t taken;
+
+	if (exitX < exitY)
+	{
+		taken = exitX < walk->sideDistY ? 0
+			: (exitX - walk->sideDistY) / walk->deltaDistY + 1;
+		walk->sideDistY += taken * walk->deltaDistY;
+		walk->mapY += (int)taken * walk->stepY;
+		walk->sideDistX = exitX;
+		walk->mapX += innerX * walk->stepX;
+	} else
+	{
+		taken = exitY <= walk->sideDistX ? 0
+			: (exitY - walk->sideDistX - 1) / walk->deltaDistX + 1;
+		walk->sideDistX += taken * walk->deltaDistX;
+		walk->mapX += (int)taken * walk->stepX;
+		walk->sideDistY = exitY;
+		walk->mapY += innerY * walk->stepY;
+	}
+}
+
+#endif
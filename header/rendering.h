@@ -2,9 +2,40 @@
 #define RENDERING_H
 
 #include "main.h"
+#include "framebuffer.h"
+#include "threadpool.h"
+#include "textures.h"
+#include "raycast.h"
 
-void drawMiniMap(SDL_Renderer* renderer, double posX, double posY, double dirX, double dirY);
-void drawRain(SDL_Renderer* renderer);
-void performRaycasting(SDL_Renderer* renderer, TextureData wallTextures[], TextureData* skyTexture, double posX, double posY, double dirX, double dirY, double planeX, double planeY);
+/*Columns claimed at once by a render worker; 16 ARGB pixels fill a 64-byte cache line*/
+#define COLUMN_STRIP 16
+/*Tallest texture column a worker lights once per slice; taller ones are lit texel by texel*/
+#define SHADED_COLUMN_TEXELS 1024
+
+/*
+ * The camera and map the hits in columnHits were cast for. A frame seen
+ * from the same place and direction reuses those hits as they are. A
+ * frame that only turned looks up, for each column, the two rays of the
+ * last frame on either side of it: when both hit the same face of the
+ * same cell, no wall can stand between them, so the new ray hits that
+ * face too and completeRayHit fills it in without walking the map. Only
+ * the columns turned into view, or whose neighbours disagree, are cast.
+ */
+typedef struct {
+	bool enabled;
+	bool valid;
+	double posX, posY, dirX, dirY, planeX, planeY;
+	int width;
+	uint32_t mapVersion;
+	SDL_atomic_t reused; /* columns of the last frame drawn without casting a ray */
+} RayCache;
+
+extern RayHit columnHits[MAX_RENDER_WIDTH];
+extern RayCache rayCache;
+
+void performRaycasting(SDL_Renderer* renderer, const WallMipmaps* wallMipmaps, TextureData* skyTexture, double posX, double posY, double dirX, double dirY, double planeX, double planeY);
+void performRaycastingSoftware(Framebuffer* fb, ThreadPool* pool, const WallAtlas* wallAtlas, TextureData* skyTexture, double posX, double posY, double dirX, double dirY, double planeX, double planeY);
+
+void performRaycastingView(Framebuffer* fb, const WallAtlas* wallAtlas, const double* cameraX, double posX, double posY, double dirX, double dirY, double planeX, double planeY);
 
 #endif
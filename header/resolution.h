@@ -0,0 +1,38 @@
+#ifndef RESOLUTION_H
+#define RESOLUTION_H
+
+#include "main.h"
+
+/*Render time the dynamic resolution aims to stay under, in ms*/
+#define DEFAULT_FRAME_BUDGET_MS 12.0
+/*Smallest fraction of the output width rendered*/
+#define MIN_RENDER_SCALE 0.25
+/*Render widths are kept to multiples of a column strip*/
+#define RENDER_WIDTH_STEP 16
+/*Frames a new resolution is kept before it is judged*/
+#define RESOLUTION_SETTLE_FRAMES 30
+
+/*
+ * The internal resolution the world is rendered at, kept apart from the
+ * output the window shows. The rendered picture is stretched over the
+ * output in one blit, and the HUD is drawn at the output size on top.
+ * With a dynamic scale the internal width follows the measured render
+ * time, shrinking when a frame runs over budget and growing back when
+ * there is room, always at the output's aspect ratio.
+ */
+typedef struct {
+	int outputWidth, outputHeight;
+	int width, height; /* internal render resolution */
+	double scale;      /* internal width over output width */
+	bool dynamic;
+	double budgetMs;
+	double averageMs;  /* smoothed render time at the current resolution */
+	int settle;        /* frames left before the average is trusted */
+} RenderResolution;
+
+void initRenderResolution(RenderResolution *resolution, int outputWidth, int outputHeight,
+		double scale, double budgetMs);
+void setOutputSize(RenderResolution *resolution, int outputWidth, int outputHeight);
+bool updateRenderResolution(RenderResolution *resolution, double renderMs);
+
+#endif
@@ -0,0 +1,87 @@
+#ifndef SPRITES_H
+#define SPRITES_H
+
+#include "main.h"
+#include "framebuffer.h"
+#include "threadpool.h"
+#include "texture_cache.h"
+
+/*Where the sprites of resources/map.txt stand*/
+#define SPRITE_PLACEMENTS "./resources/sprites.txt"
+/*Frames taller than this are scaled down when packed into the atlas*/
+#define SPRITE_FRAME_HEIGHT 256
+#define SPRITE_ATLAS_WIDTH 1024
+#define SPRITE_FRAMES_MAX 8
+/*Sprites closer to the camera plane than this are not drawn*/
+#define SPRITE_NEAR 0.2f
+
+typedef enum {
+	SPRITE_CANDLEBRA,
+	SPRITE_GREEN_LIGHT,
+	SPRITE_RED_LIGHT,
+	SPRITE_SOLDIER,
+	SPRITE_CACO_DEMON,
+	SPRITE_CYBER_DEMON,
+	SPRITE_KIND_COUNT
+} SpriteKind;
+
+/*Kinds from SPRITE_SOLDIER on are NPCs, the ones before decorations*/
+#define SPRITE_FIRST_NPC SPRITE_SOLDIER
+
+/*
+ * Every sprite frame packed into one texture, so all sprites are drawn
+ * with one geometry call, and a transposed copy of its pixels so the
+ * software renderer reads a sprite column from consecutive texels.
+ */
+typedef struct {
+	SDL_Texture *texture;
+	Uint32 *columns; /* texel (x, y) at columns[x * height + y] */
+	int width;
+	int height;
+	SDL_Rect frames[SPRITE_KIND_COUNT][SPRITE_FRAMES_MAX];
+} SpriteAtlas;
+
+/*A sprite in front of the camera this frame, in screen space*/
+typedef struct {
+	float depth;        /* distance along the view direction */
+	float left, top;    /* unclipped top left corner */
+	float width, height;
+	int first, last;    /* screen columns it covers, clipped to the screen */
+	const SDL_Rect *frame;
+} VisibleSprite;
+
+/*
+ * Billboards standing in the world, kept in structure-of-arrays form.
+ * prepareSprites culls them against the view and the wall depth of the
+ * last frame and radix sorts the rest far to near; the draw functions
+ * then paint them over the walls one column at a time.
+ */
+typedef struct {
+	float *x, *y;
+	Uint8 *kind;
+	int count;
+	int capacity;
+	SpriteAtlas atlas;
+	/*Per frame*/
+	VisibleSprite *visible;
+	Uint32 *sortKeys;  /* radix sort keys and their scratch copy */
+	int *order;        /* visible sprites far to near, and its scratch copy */
+	int visibleCount;
+	SDL_Vertex *vertices;
+	int *indices;
+	int quadCapacity;
+} SpriteSet;
+
+SpriteSet *createSpriteSet(void);
+bool addSprite(SpriteSet *sprites, SpriteKind kind, float x, float y);
+void removeSprite(SpriteSet *sprites, int i);
+bool loadSprites(SpriteSet *sprites, const char *path);
+void scatterSprites(SpriteSet *sprites, int count, unsigned int seed);
+bool createSpriteAtlas(SpriteSet *sprites, TextureCache *textures);
+void prepareSprites(SpriteSet *sprites, double seconds, double posX, double posY,
+		double dirX, double dirY, double planeX, double planeY);
+void drawSprites(SpriteSet *sprites, SDL_Renderer *renderer);
+void drawSpritesSoftware(SpriteSet *sprites, Framebuffer *fb, ThreadPool *pool);
+void destroySpriteSet(SpriteSet *sprites);
+
+#endif
@@ -0,0 +1,49 @@
+#ifndef TEXTURE_CACHE_H
+#define TEXTURE_CACHE_H
+
+#include "main.h"
+
+#define TEXTURE_CACHE_BUCKETS 256
+/*Default limit on decoded pixels plus GPU copies, in megabytes*/
+#define TEXTURE_BUDGET_MB 256
+
+/*One loaded image, shared by everyone who acquired its path*/
+typedef struct CachedTexture {
+	char *path;
+	TextureData data;
+	int refCount;
+	Uint64 lastUse; /* cache clock at the last acquire, for LRU eviction */
+	size_t surfaceBytes;
+	size_t textureBytes;
+	struct CachedTexture *next; /* next entry in the same bucket */
+} CachedTexture;
+
+typedef struct {
+	Uint64 hits;
+	Uint64 misses;
+	Uint64 evictions;
+	int entries;
+	size_t surfaceBytes; /* decoded pixels in RAM */
+	size_t textureBytes; /* estimated size of the GPU textures */
+} TextureCacheStats;
+
+/*
+ * Textures keyed by path. Entries nobody holds a reference to stay
+ * cached until the budget is exceeded, then go least recently used first.
+ */
+typedef struct {
+	CachedTexture *buckets[TEXTURE_CACHE_BUCKETS];
+	SDL_Renderer *renderer;
+	size_t budget;
+	Uint64 clock;
+	TextureCacheStats stats;
+} TextureCache;
+
+TextureCache *createTextureCache(SDL_Renderer *renderer, size_t budget);
+TextureData acquireTexture(TextureCache *cache, const char *path);
+void releaseTexture(TextureCache *cache, const char *path);
+bool insertTexture(TextureCache *cache, const char *path, SDL_Surface *surface);
+void printTextureCacheStats(const TextureCache *cache, FILE *out);
+void destroyTextureCache(TextureCache *cache);
+
+#endif
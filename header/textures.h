@@ -3,7 +3,101 @@
 
 #include "main.h"
 
+/*Enough halvings to take a 65536 texel slot down to one texel*/
+#define WALL_MAX_LEVELS 17
+
+/*
+ * Wall textures for the software renderer, transposed so that each texture
+ * column is contiguous, and padded to one power-of-two slot size so that a
+ * texel is found with shifts and masks alone. Every level after the first
+ * halves both sides of the slots, so a distant wall reads a small level
+ * that stays in cache instead of skipping through the full-size texture.
+ */
+typedef struct {
+    Uint32 *texels;
+    int widthShift;  /* log2 of the columns per slot at level 0 */
+    int heightShift; /* log2 of the texels per column at level 0 */
+    int levelCount;
+    size_t levelOffset[WALL_MAX_LEVELS]; /* first texel of each level */
+    int width[WALL_TEXTURE_COUNT];  /* size of each texture before padding */
+    int height[WALL_TEXTURE_COUNT];
+    int textureLevels[WALL_TEXTURE_COUNT]; /* levels until a side of the texture is one texel */
+} WallAtlas;
+
+/*
+ * The SDL renderer's copy of the wall mip levels, one texture per level.
+ * Level 0 is the loaded texture itself; the others are made from the
+ * atlas' levels.
+ */
+typedef struct {
+    SDL_Texture* levels[WALL_TEXTURE_COUNT][WALL_MAX_LEVELS];
+    int levelCount[WALL_TEXTURE_COUNT];
+    int width[WALL_TEXTURE_COUNT];  /* size of level 0 */
+    int height[WALL_TEXTURE_COUNT];
+} WallMipmaps;
+
+/**
+ * getAtlasColumn - function finds a texture column in the wall atlas
+ * @atlas: pointer to the atlas
+ * @level: mip level, 0 to levelCount - 1
+ * @texID: wall texture, 0 to WALL_TEXTURE_COUNT - 1
+ * @texX: column of the texture at that level
+ *
+ * Return: pointer to the 1 << (heightShift - level) texels of the column
+ */
+static inline const Uint32 *getAtlasColumn(const WallAtlas *atlas, int level, int texID, int texX)
+{
+    const int widthShift = atlas->widthShift - level;
+    size_t column = ((size_t)texID << widthShift) | (texX & ((1 << widthShift) - 1));
+
+    return (atlas->texels + atlas->levelOffset[level]
+            + (column << (atlas->heightShift - level)));
+}
+
+/**
+ * pickWallLevel - function chooses the mip level a wall slice reads
+ * @lineHeight: unclipped height of the slice on screen
+ * @texHeight: height of the texture at level 0
+ * @levelCount: levels the texture has
+ *
+ * Return: the largest level with at least one texel per row of the slice
+ */
+static inline int pickWallLevel(int lineHeight, int texHeight, int levelCount)
+{
+    int level = 0;
+
+    while (level + 1 < levelCount && texHeight >> (level + 1) >= lineHeight)
+        level++;
+    return level;
+}
+
+/**
+ * averageTexels - function blends four texels channel by channel
+ * @a: first texel
+ * @b: second texel
+ * @c: third texel
+ * @d: fourth texel
+ *
+ * Return: the rounded average
+ */
+static inline Uint32 averageTexels(Uint32 a, Uint32 b, Uint32 c, Uint32 d)
+{
+    Uint32 result = 0;
+
+    for (int shift = 0; shift < 32; shift += 8)
+        result |= (((a >> shift & 0xFF) + (b >> shift & 0xFF) + (c >> shift & 0xFF)
+                    + (d >> shift & 0xFF) + 2) / 4) << shift;
+    return result;
+}
+
 SDL_Texture* loadTexture(const char* path, SDL_Renderer* renderer);
+SDL_Surface* decodeTextureSurface(const char* file);
+TextureData uploadTextureData(SDL_Surface* surface, SDL_Renderer* renderer);
 TextureData loadTextureWithDimensions(const char* file, SDL_Renderer* renderer);
+void freeTextureData(TextureData* texData);
+bool createWallAtlas(WallAtlas* atlas, const TextureData wallTextures[]);
+void destroyWallAtlas(WallAtlas* atlas);
+bool createWallMipmaps(WallMipmaps* mipmaps, const WallAtlas* atlas, const TextureData wallTextures[], SDL_Renderer* renderer);
+void destroyWallMipmaps(WallMipmaps* mipmaps);
 
 #endif
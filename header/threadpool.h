@@ -0,0 +1,31 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include "main.h"
+
+/*Work callback: processes items [begin, end) of a parallel job*/
+typedef void (*ParallelJob)(void *context, int begin, int end);
+
+/*Persistent workers that split a range of items between them*/
+typedef struct {
+	SDL_Thread **threads;
+	int threadCount;
+	SDL_mutex *lock;
+	SDL_cond *wake;
+	SDL_cond *done;
+	int generation;
+	int busyWorkers;
+	bool quit;
+	/*Current job, published under lock*/
+	ParallelJob job;
+	void *context;
+	int count;
+	int grain;
+	SDL_atomic_t next;
+} ThreadPool;
+
+ThreadPool *createThreadPool(int threadCount);
+void runParallel(ThreadPool *pool, int count, int grain, ParallelJob job, void *context);
+void destroyThreadPool(ThreadPool *pool);
+
+#endif
@@ -0,0 +1,9 @@
+#ifndef TIMING_H
+#define TIMING_H
+
+#include "main.h"
+
+double getSecondsBetween(Uint64 start, Uint64 end);
+void waitUntil(Uint64 deadline);
+
+#endif
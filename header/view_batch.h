@@ -0,0 +1,40 @@
+#ifndef VIEW_BATCH_H
+#define VIEW_BATCH_H
+
+#include "main.h"
+#include "framebuffer.h"
+#include "threadpool.h"
+#include "textures.h"
+#include "floorcast.h"
+
+/*A camera state to render: position, view direction and camera plane*/
+typedef struct {
+	double posX, posY;
+	double dirX, dirY;
+	double planeX, planeY;
+} ViewCamera;
+
+/*
+ * Renders many cameras over worldMap in one call, for agents and tools
+ * that want pictures rather than a game. No window or renderer is
+ * needed. The wall atlas, floor textures and column table are built
+ * once and shared read-only by every view, and each view is drawn whole
+ * by one thread with the game's column and floor code, so the views of
+ * a batch are spread over the cores instead of the columns of a view.
+ */
+typedef struct {
+	int width;
+	int height;
+	double *cameraX; /* camera-space x of every column, shared by the views */
+	WallAtlas wallAtlas;
+	FloorTextures floorTextures;
+	ThreadPool *pool;
+} ViewBatch;
+
+ViewBatch *createViewBatch(int width, int height, int threadCount);
+bool createViewTargets(const ViewBatch *batch, Framebuffer *targets, int count);
+void renderViewBatch(ViewBatch *batch, const ViewCamera *views, Framebuffer *targets, int count);
+void destroyViewTargets(Framebuffer *targets, int count);
+void destroyViewBatch(ViewBatch *batch);
+
+#endif
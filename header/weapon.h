@@ -2,9 +2,19 @@
 #define WEAPON_H
 
 #include "main.h"
+#include "entity_grid.h"
+#include "sprites.h"
+
+/*Time in (ms) the weapon spends in each state after firing*/
+#define WEAPON_FIRE_MS 100
+#define WEAPON_RECOIL_MS 100
+#define WEAPON_RELOAD_MS 100
 
 WeaponState handleWeaponInput(bool* firing, WeaponState currentWeaponState);
 void renderWeapon(SDL_Renderer* renderer, TextureData* weaponTextures, WeaponState weaponState);
-void updateWeaponState(WeaponState* weaponState, Uint32* lastFireTime, Uint32 fireCooldown);
+void getMuzzlePosition(SDL_Renderer* renderer, float* x, float* y);
+bool fireWeapon(WeaponState* weaponState, Uint32* stateTime, Uint32 now);
+int shootNpcs(EntityGrid* npcs, SpriteSet* sprites, const Player* player);
+void updateWeaponState(WeaponState* weaponState, Uint32* stateTime, Uint32 now);
 
 #endif
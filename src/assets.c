@@ -0,0 +1,406 @@
+#include "../header/assets.h"
+#include "../header/textures.h"
+#include "../header/timing.h"
+
+/**
+ * parseAssetLine - function reads one manifest entry
+ * @line: manifest line
+ * @asset: pointer to the asset to fill in
+ *
+ * Return: 1 for an entry, 0 for a blank or comment line, -1 if malformed
+ */
+static int parseAssetLine(const char *line, Asset *asset)
+{
+	char kind[16], priority[16];
+
+	while (*line == ' ' || *line == '\t')
+		line++;
+	if (*line == '#' || *line == '\n' || *line == '\r' || *line == '\0')
+		return (0);
+	if (sscanf(line, "%15s %15s %127s", kind, priority, asset->path) != 3)
+		return (-1);
+
+	if (strcmp(kind, "image") == 0)
+		asset->kind = ASSET_IMAGE;
+	else if (strcmp(kind, "sound") == 0)
+		asset->kind = ASSET_SOUND;
+	else if (strcmp(kind, "music") == 0)
+		asset->kind = ASSET_MUSIC;
+	else
+		return (-1);
+
+	if (strcmp(priority, "critical") == 0)
+		asset->critical = true;
+	else if (strcmp(priority, "deferred") == 0)
+		asset->critical = false;
+	else
+		return (-1);
+	return (1);
+}
+
+/**
+ * readManifest - function reads every entry of an asset manifest
+ * @loader: pointer to the loader receiving the assets
+ * @manifestPath: path to the manifest
+ * @loadAudio: false to leave out sounds and music
+ *
+ * Critical entries are moved ahead of deferred ones, each group keeping
+ * the manifest order, so the workers decode them first.
+ *
+ * Return: true on success, false otherwise
+ */
+static bool readManifest(AssetLoader *loader, const char *manifestPath, bool loadAudio)
+{
+	FILE *file = fopen(manifestPath, "r");
+	char line[256];
+	int lineNumber = 0, capacity = 0, status;
+	Asset entry, *grown, *ordered;
+
+	if (!file)
+	{
+		fprintf(stderr, "Failed to open asset manifest %s\n", manifestPath);
+		return (false);
+	}
+	while (fgets(line, sizeof(line), file))
+	{
+		lineNumber++;
+		memset(&entry, 0, sizeof(entry));
+		status = parseAssetLine(line, &entry);
+		if (status < 0)
+		{
+			fprintf(stderr, "%s:%d: expected \"image|sound|music critical|deferred PATH\"\n",
+					manifestPath, lineNumber);
+			fclose(file);
+			return (false);
+		}
+		if (status == 0 || (!loadAudio && entry.kind != ASSET_IMAGE))
+			continue;
+		if (loader->count == capacity)
+		{
+			capacity = capacity ? capacity * 2 : 64;
+			grown = realloc(loader->assets, capacity * sizeof(Asset));
+			if (!grown)
+			{
+				fclose(file);
+				return (false);
+			}
+			loader->assets = grown;
+		}
+		loader->assets[loader->count++] = entry;
+		loader->criticalCount += entry.critical;
+	}
+	fclose(file);
+
+	ordered = malloc(SDL_max(loader->count, 1) * sizeof(Asset));
+	if (!ordered)
+		return (false);
+	for (int i = 0, critical = 0, deferred = loader->criticalCount; i < loader->count; i++)
+	{
+		if (loader->assets[i].critical)
+			ordered[critical++] = loader->assets[i];
+		else
+			ordered[deferred++] = loader->assets[i];
+	}
+	free(loader->assets);
+	loader->assets = ordered;
+	return (true);
+}
+
+/**
+ * decodeAsset - function does the part of loading that needs no renderer
+ * @asset: pointer to the asset
+ *
+ * Images are decoded to pixels and wait for the render thread to upload
+ * them; audio is decoded completely and is ready straight away.
+ *
+ * Return: void
+ */
+static void decodeAsset(Asset *asset)
+{
+	bool loaded;
+
+	switch (asset->kind)
+	{
+	case ASSET_IMAGE:
+		asset->surface = decodeTextureSurface(asset->path);
+		loaded = asset->surface != NULL;
+		break;
+	case ASSET_SOUND:
+		asset->sound = Mix_LoadWAV(asset->path);
+		loaded = asset->sound != NULL;
+		break;
+	default:
+		asset->music = Mix_LoadMUS(asset->path);
+		loaded = asset->music != NULL;
+		break;
+	}
+	if (!loaded && asset->kind != ASSET_IMAGE)
+		fprintf(stderr, "Failed to load %s! SDL_mixer Error: %s\n", asset->path, Mix_GetError());
+	/*Publishing the state is a full barrier, so readers see the pointers above*/
+	SDL_AtomicSet(&asset->state, !loaded ? ASSET_FAILED :
+			asset->kind == ASSET_IMAGE ? ASSET_DECODED : ASSET_READY);
+}
+
+/**
+ * assetWorkerMain - function decodes assets until none are left
+ * @data: pointer to the asset loader
+ *
+ * Return: 0 when the worker is done
+ */
+static int assetWorkerMain(void *data)
+{
+	AssetLoader *loader = data;
+	int index;
+
+	while (!SDL_AtomicGet(&loader->quit))
+	{
+		index = SDL_AtomicAdd(&loader->next, 1);
+		if (index >= loader->count)
+			break;
+		decodeAsset(&loader->assets[index]);
+		SDL_SemPost(loader->finished);
+	}
+	return (0);
+}
+
+/**
+ * createAssetLoader - function reads a manifest and starts decoding it
+ * @manifestPath: path to the manifest
+ * @textures: pointer to the cache receiving the images
+ * @loadAudio: false to leave out sounds and music, e.g. without a mixer
+ *
+ * Decoding starts on one worker per CPU core as soon as the loader is
+ * created, so the caller can do other startup work meanwhile.
+ *
+ * Return: pointer to the loader, or NULL on failure
+ */
+AssetLoader *createAssetLoader(const char *manifestPath, TextureCache *textures, bool loadAudio)
+{
+	AssetLoader *loader = calloc(1, sizeof(AssetLoader));
+
+	if (!loader)
+		return (NULL);
+	loader->textures = textures;
+	loader->startTime = SDL_GetPerformanceCounter();
+	if (!readManifest(loader, manifestPath, loadAudio))
+	{
+		destroyAssetLoader(loader);
+		return (NULL);
+	}
+	loader->finished = SDL_CreateSemaphore(0);
+	loader->threadCount = SDL_clamp(SDL_GetCPUCount(), 1, SDL_max(loader->count, 1));
+	loader->threads = calloc(loader->threadCount, sizeof(SDL_Thread *));
+	if (!loader->finished || !loader->threads)
+	{
+		destroyAssetLoader(loader);
+		return (NULL);
+	}
+	for (int i = 0; i < loader->threadCount; i++)
+	{
+		loader->threads[i] = SDL_CreateThread(assetWorkerMain, "assets", loader);
+		if (!loader->threads[i])
+		{
+			fprintf(stderr, "Asset thread creation failed: %s\n", SDL_GetError());
+			destroyAssetLoader(loader);
+			return (NULL);
+		}
+	}
+	return (loader);
+}
+
+/**
+ * settleAssets - function caches decoded images and skips past finished assets
+ * @loader: pointer to the asset loader
+ * @end: first asset not to upload
+ * @maxUploads: most textures to create in this call
+ *
+ * Return: number of textures created
+ */
+static int settleAssets(AssetLoader *loader, int end, int maxUploads)
+{
+	int uploads = 0, state;
+
+	for (int i = loader->settled; i < end && uploads < maxUploads; i++)
+	{
+		Asset *asset = &loader->assets[i];
+
+		if (SDL_AtomicGet(&asset->state) != ASSET_DECODED)
+			continue;
+		/*An image acquired before it streamed in is cached already*/
+		insertTexture(loader->textures, asset->path, asset->surface);
+		asset->surface = NULL;
+		SDL_AtomicSet(&asset->state, ASSET_READY);
+		uploads++;
+	}
+	while (loader->settled < loader->count)
+	{
+		state = SDL_AtomicGet(&loader->assets[loader->settled].state);
+		if (state != ASSET_READY && state != ASSET_FAILED)
+			break;
+		loader->settled++;
+	}
+	return (uploads);
+}
+
+/**
+ * pumpAssetUploads - function caches textures for images decoded so far
+ * @loader: pointer to the asset loader
+ * @maxUploads: most textures to create, to bound the time taken per frame
+ *
+ * Called once per frame on the render thread while deferred assets load.
+ *
+ * Return: number of assets not loaded yet
+ */
+int pumpAssetUploads(AssetLoader *loader, int maxUploads)
+{
+	if (loader->settled == loader->count)
+		return (0);
+	settleAssets(loader, loader->count, maxUploads);
+	if (loader->settled == loader->count)
+		printf("Loaded all %d assets in %.1f ms\n", loader->count,
+				getSecondsBetween(loader->startTime, SDL_GetPerformanceCounter()) * 1000);
+	return (loader->count - loader->settled);
+}
+
+/**
+ * drawLoadingBar - function shows how far loading has got
+ * @renderer: SDL renderer pointer
+ * @done: assets loaded
+ * @total: assets being waited for
+ *
+ * Return: void
+ */
+static void drawLoadingBar(SDL_Renderer *renderer, int done, int total)
+{
+	SDL_Rect frame, bar;
+	int width, height;
+
+	SDL_GetRendererOutputSize(renderer, &width, &height);
+	frame = (SDL_Rect){width / 4, height / 2 - 8, width / 2, 16};
+	bar = (SDL_Rect){frame.x + 2, frame.y + 2, (frame.w - 4) * done / total, frame.h - 4};
+
+	SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
+	SDL_RenderClear(renderer);
+	SDL_SetRenderDrawColor(renderer, 200, 200, 200, 255);
+	SDL_RenderDrawRect(renderer, &frame);
+	SDL_SetRenderDrawColor(renderer, 200, 30, 30, 255);
+	SDL_RenderFillRect(renderer, &bar);
+	SDL_RenderPresent(renderer);
+}
+
+/**
+ * waitForAssets - function blocks until assets are loaded, showing progress
+ * @loader: pointer to the asset loader
+ * @criticalOnly: true to wait for the critical assets only
+ *
+ * Return: true if every asset waited for loaded, false otherwise
+ */
+bool waitForAssets(AssetLoader *loader, bool criticalOnly)
+{
+	const int target = criticalOnly ? loader->criticalCount : loader->count;
+	bool loaded = true;
+
+	for (;;)
+	{
+		settleAssets(loader, target, target);
+		if (loader->settled >= target)
+			break;
+		drawLoadingBar(loader->textures->renderer, loader->settled, target);
+		SDL_PumpEvents();
+		SDL_SemWaitTimeout(loader->finished, 100);
+	}
+	for (int i = 0; i < target; i++)
+	{
+		if (SDL_AtomicGet(&loader->assets[i].state) == ASSET_FAILED)
+			loaded = false;
+	}
+	printf("Loaded %d of %d assets in %.1f ms\n", target, loader->count,
+			getSecondsBetween(loader->startTime, SDL_GetPerformanceCounter()) * 1000);
+	return (loaded);
+}
+
+/**
+ * findReadyAsset - function looks up loaded audio by path and kind
+ * @loader: pointer to the asset loader
+ * @path: path as written in the manifest
+ * @kind: kind of asset expected
+ *
+ * Return: pointer to the asset, or NULL if it is not loaded
+ */
+static const Asset *findReadyAsset(const AssetLoader *loader, const char *path, AssetKind kind)
+{
+	for (int i = 0; i < loader->count; i++)
+	{
+		Asset *asset = &loader->assets[i];
+
+		if (asset->kind != kind || strcmp(asset->path, path) != 0)
+			continue;
+		if (SDL_AtomicGet(&asset->state) != ASSET_READY)
+			return (NULL);
+		return (asset);
+	}
+	fprintf(stderr, "Asset %s is not in the manifest\n", path);
+	return (NULL);
+}
+
+/**
+ * getSoundAsset - function gets a loaded sound effect
+ * @loader: pointer to the asset loader
+ * @path: path as written in the manifest
+ *
+ * Return: pointer to the chunk, owned by the loader, or NULL if not loaded
+ */
+Mix_Chunk *getSoundAsset(const AssetLoader *loader, const char *path)
+{
+	const Asset *asset = findReadyAsset(loader, path, ASSET_SOUND);
+
+	return (asset ? asset->sound : NULL);
+}
+
+/**
+ * getMusicAsset - function gets loaded music
+ * @loader: pointer to the asset loader
+ * @path: path as written in the manifest
+ *
+ * Return: pointer to the music, owned by the loader, or NULL if not loaded
+ */
+Mix_Music *getMusicAsset(const AssetLoader *loader, const char *path)
+{
+	const Asset *asset = findReadyAsset(loader, path, ASSET_MUSIC);
+
+	return (asset ? asset->music : NULL);
+}
+
+/**
+ * destroyAssetLoader - function stops the workers and frees the audio
+ * @loader: pointer to the asset loader, may be NULL
+ *
+ * Workers finish the asset they are decoding; the rest are never started.
+ * Images already handed over stay in the texture cache.
+ *
+ * Return: void
+ */
+void destroyAssetLoader(AssetLoader *loader)
+{
+	if (!loader)
+		return;
+	SDL_AtomicSet(&loader->quit, 1);
+	for (int i = 0; loader->threads && i < loader->threadCount; i++)
+		SDL_WaitThread(loader->threads[i], NULL);
+	for (int i = 0; i < loader->count; i++)
+	{
+		Asset *asset = &loader->assets[i];
+
+		if (asset->surface)
+			SDL_FreeSurface(asset->surface);
+		if (asset->sound)
+			Mix_FreeChunk(asset->sound);
+		if (asset->music)
+			Mix_FreeMusic(asset->music);
+	}
+	if (loader->finished)
+		SDL_DestroySemaphore(loader->finished);
+	free(loader->threads);
+	free(loader->assets);
+	free(loader);
+}
@@ -0,0 +1,114 @@
+#include <math.h>
+#include "../header/camera.h"
+
+/*Direction, plane and column tables shared by the simulation and the renderers*/
+CameraTables cameraTables;
+
+/**
+ * fillCameraColumns - function computes the camera-space x of every column
+ * @cameraX: array receiving width values
+ * @width: number of columns
+ *
+ * Return: void
+ */
+void fillCameraColumns(double *cameraX, int width)
+{
+	for (int x = 0; x < width; x++)
+		cameraX[x] = 2 * x / (double)width - 1;
+}
+
+/**
+ * initCameraTables - function fills the angle tables and the column table
+ * @width: number of columns of the internal render resolution
+ * @height: number of rows of the internal render resolution
+ *
+ * The angle tables are filled on the first call only; the column table
+ * is rebuilt whenever the width changes.
+ *
+ * Return: true on success, false if the column table could not be allocated
+ */
+bool initCameraTables(int width, int height)
+{
+	static bool anglesReady;
+	double *cameraX;
+
+	if (!anglesReady)
+	{
+		for (int i = 0; i < ANGLE_STEPS; i++)
+		{
+			double angle = 2 * M_PI * i / ANGLE_STEPS;
+
+			cameraTables.dirX[i] = cos(angle);
+			cameraTables.dirY[i] = sin(angle);
+			/*The plane is the direction turned a quarter clockwise*/
+			cameraTables.planeX[i] = cameraTables.dirY[i] * CAMERA_PLANE;
+			cameraTables.planeY[i] = -cameraTables.dirX[i] * CAMERA_PLANE;
+		}
+		anglesReady = true;
+	}
+	cameraTables.height = height;
+	if (cameraTables.cameraX && cameraTables.width == width)
+		return (true);
+	cameraX = malloc(sizeof(double) * width);
+	if (!cameraX)
+	{
+		fprintf(stderr, "Failed to allocate the camera table for %d columns\n", width);
+		return (false);
+	}
+	fillCameraColumns(cameraX, width);
+	free(cameraTables.cameraX);
+	cameraTables.cameraX = cameraX;
+	cameraTables.width = width;
+	return (true);
+}
+
+/**
+ * setPlayerAngle - function points the player along a quantized angle
+ * @player: player whose direction and camera plane are set
+ * @angle: angle index, wrapped into 0 to ANGLE_STEPS - 1
+ *
+ * Return: void
+ */
+void setPlayerAngle(Player *player, int angle)
+{
+	angle &= ANGLE_MASK;
+	player->angle = angle;
+	player->dirX = cameraTables.dirX[angle];
+	player->dirY = cameraTables.dirY[angle];
+	player->planeX = cameraTables.planeX[angle];
+	player->planeY = cameraTables.planeY[angle];
+}
+
+/**
+ * fitViewToAspect - function widens the camera plane of a view to its screen
+ * @view: player state about to be drawn
+ * @width: columns the view is rendered at
+ * @height: rows the view is rendered at
+ *
+ * Walls are as tall as the screen at distance 1 whatever its shape, so
+ * wider screens see further to the sides instead of stretching the
+ * picture. The plane is left exactly as it is at the 4:3 SCREEN_WIDTH by
+ * SCREEN_HEIGHT.
+ *
+ * Return: void
+ */
+void fitViewToAspect(Player *view, int width, int height)
+{
+	double widen = (double)width * SCREEN_HEIGHT / ((double)height * SCREEN_WIDTH);
+
+	view->planeX *= widen;
+	view->planeY *= widen;
+}
+
+/**
+ * destroyCameraTables - function frees the column table
+ *
+ * Return: void
+ */
+void destroyCameraTables(void)
+{
+	free(cameraTables.cameraX);
+	cameraTables.cameraX = NULL;
+	cameraTables.width = 0;
+	cameraTables.height = 0;
+}
@@ -0,0 +1,366 @@
+#include <math.h>
+#include "../header/entity_grid.h"
+#include "../header/raycast.h"
+
+/**
+ * hashCell - function finds the bucket of a map cell
+ * @grid: pointer to the grid
+ * @x: cell column
+ * @y: cell row
+ *
+ * Return: bucket index
+ */
+static inline int hashCell(const EntityGrid *grid, int x, int y)
+{
+	return ((int)(((Uint32)x * 73856093u) ^ ((Uint32)y * 19349663u)) & grid->bucketMask);
+}
+
+/**
+ * createEntityGrid - function allocates an empty grid
+ * @capacity: number of entity ids, from 0 to capacity - 1
+ *
+ * Return: pointer to the grid, or NULL on failure
+ */
+EntityGrid *createEntityGrid(int capacity)
+{
+	EntityGrid *grid = calloc(1, sizeof(EntityGrid));
+	int buckets = 64;
+
+	if (!grid)
+		return (NULL);
+	/*About two buckets per entity keeps the chains short*/
+	while (buckets < capacity * 2)
+		buckets <<= 1;
+	grid->bucketMask = buckets - 1;
+	grid->capacity = capacity;
+	grid->heads = malloc(buckets * sizeof(int));
+	grid->next = malloc(SDL_max(capacity, 1) * sizeof(int));
+	grid->prev = malloc(SDL_max(capacity, 1) * sizeof(int));
+	grid->cellX = malloc(SDL_max(capacity, 1) * sizeof(int));
+	grid->cellY = malloc(SDL_max(capacity, 1) * sizeof(int));
+	grid->x = malloc(SDL_max(capacity, 1) * sizeof(float));
+	grid->y = malloc(SDL_max(capacity, 1) * sizeof(float));
+	grid->radius = malloc(SDL_max(capacity, 1) * sizeof(float));
+	grid->active = calloc(SDL_max(capacity, 1), sizeof(bool));
+	if (!grid->heads || !grid->next || !grid->prev || !grid->cellX || !grid->cellY ||
+			!grid->x || !grid->y || !grid->radius || !grid->active)
+	{
+		fprintf(stderr, "Failed to allocate the entity grid for %d entities\n", capacity);
+		destroyEntityGrid(grid);
+		return (NULL);
+	}
+	for (int i = 0; i < buckets; i++)
+		grid->heads[i] = -1;
+	return (grid);
+}
+
+/**
+ * linkEntity - function files an entity under the cell of its position
+ * @grid: pointer to the grid
+ * @id: entity id
+ *
+ * Return: void
+ */
+static void linkEntity(EntityGrid *grid, int id)
+{
+	int bucket;
+
+	grid->cellX[id] = (int)floorf(grid->x[id]);
+	grid->cellY[id] = (int)floorf(grid->y[id]);
+	bucket = hashCell(grid, grid->cellX[id], grid->cellY[id]);
+	grid->prev[id] = -1;
+	grid->next[id] = grid->heads[bucket];
+	if (grid->heads[bucket] >= 0)
+		grid->prev[grid->heads[bucket]] = id;
+	grid->heads[bucket] = id;
+}
+
+/**
+ * unlinkEntity - function takes an entity out of its bucket
+ * @grid: pointer to the grid
+ * @id: entity id
+ *
+ * Return: void
+ */
+static void unlinkEntity(EntityGrid *grid, int id)
+{
+	if (grid->prev[id] >= 0)
+		grid->next[grid->prev[id]] = grid->next[id];
+	else
+		grid->heads[hashCell(grid, grid->cellX[id], grid->cellY[id])] = grid->next[id];
+	if (grid->next[id] >= 0)
+		grid->prev[grid->next[id]] = grid->prev[id];
+}
+
+/**
+ * insertEntity - function adds an entity to the grid
+ * @grid: pointer to the grid
+ * @id: unused entity id below the grid's capacity
+ * @x: position on the x axis, in map cells
+ * @y: position on the y axis, in map cells
+ * @radius: hit radius, at most ENTITY_MAX_RADIUS
+ *
+ * Return: true on success, false if the id is out of range or in use
+ */
+bool insertEntity(EntityGrid *grid, int id, float x, float y, float radius)
+{
+	if (id < 0 || id >= grid->capacity || grid->active[id])
+		return (false);
+	grid->x[id] = x;
+	grid->y[id] = y;
+	grid->radius[id] = SDL_min(radius, ENTITY_MAX_RADIUS);
+	grid->active[id] = true;
+	grid->count++;
+	linkEntity(grid, id);
+	return (true);
+}
+
+/**
+ * moveEntity - function updates an entity's position
+ * @grid: pointer to the grid
+ * @id: entity id
+ * @x: new position on the x axis
+ * @y: new position on the y axis
+ *
+ * The entity only changes bucket when it crosses into another cell.
+ *
+ * Return: void
+ */
+void moveEntity(EntityGrid *grid, int id, float x, float y)
+{
+	if (!grid->active[id])
+		return;
+	grid->x[id] = x;
+	grid->y[id] = y;
+	if ((int)floorf(x) != grid->cellX[id] || (int)floorf(y) != grid->cellY[id])
+	{
+		unlinkEntity(grid, id);
+		linkEntity(grid, id);
+	}
+}
+
+/**
+ * removeEntity - function takes an entity out of the grid
+ * @grid: pointer to the grid
+ * @id: entity id, may already be unused
+ *
+ * Return: void
+ */
+void removeEntity(EntityGrid *grid, int id)
+{
+	if (!grid->active[id])
+		return;
+	unlinkEntity(grid, id);
+	grid->active[id] = false;
+	grid->count--;
+}
+
+/**
+ * renumberEntity - function gives an entity another id
+ * @grid: pointer to the grid
+ * @from: current id, may be unused
+ * @to: unused id it moves to
+ *
+ * For owners that keep their entities packed by moving the last one into
+ * a freed slot.
+ *
+ * Return: void
+ */
+void renumberEntity(EntityGrid *grid, int from, int to)
+{
+	if (!grid->active[from] || grid->active[to])
+		return;
+	unlinkEntity(grid, from);
+	grid->active[from] = false;
+	grid->x[to] = grid->x[from];
+	grid->y[to] = grid->y[from];
+	grid->radius[to] = grid->radius[from];
+	grid->active[to] = true;
+	linkEntity(grid, to);
+}
+
+/*Nearest entity along a ray found so far, for the walkRay visitor*/
+typedef struct {
+	const EntityGrid *grid;
+	double posX, posY, dirX, dirY;
+	double nearest;
+	int hit;
+} EntityRay;
+
+/**
+ * testCellEntities - function intersects a ray with the entities of a cell
+ * @ray: pointer to the ray and its nearest hit so far
+ * @cellX: cell column
+ * @cellY: cell row
+ *
+ * Return: void
+ */
+static void testCellEntities(EntityRay *ray, int cellX, int cellY)
+{
+	const EntityGrid *grid = ray->grid;
+
+	for (int id = grid->heads[hashCell(grid, cellX, cellY)]; id >= 0; id = grid->next[id])
+	{
+		double toX, toY, along, missSquared, radius, half, t;
+
+		/*Other cells can share the bucket*/
+		if (grid->cellX[id] != cellX || grid->cellY[id] != cellY)
+			continue;
+		toX = grid->x[id] - ray->posX;
+		toY = grid->y[id] - ray->posY;
+		radius = grid->radius[id];
+		along = toX * ray->dirX + toY * ray->dirY;
+		missSquared = toX * toX + toY * toY - along * along;
+		if (missSquared > radius * radius)
+			continue;
+		half = sqrt(radius * radius - missSquared);
+		if (along + half < 0)
+			continue;
+		/*First point of the circle on the ray, or the origin if it starts inside*/
+		t = SDL_max(0, along - half);
+		if (t < ray->nearest)
+		{
+			ray->nearest = t;
+			ray->hit = id;
+		}
+	}
+}
+
+/**
+ * visitEntityCell - function tests the entities that can reach into a cell on the ray
+ * @context: pointer to the EntityRay
+ * @mapX: cell column
+ * @mapY: cell row
+ * @distance: where the ray enters the cell
+ *
+ * An entity centred in a neighbouring cell can still cover this one, so
+ * all nine cells around it are tested. Once the ray is a cell past the
+ * nearest hit, no entity further on can be hit sooner.
+ *
+ * Return: true to keep walking, false once the nearest hit is certain
+ */
+static bool visitEntityCell(void *context, int mapX, int mapY, double distance)
+{
+	EntityRay *ray = context;
+
+	if (distance > ray->nearest + 1)
+		return (false);
+	for (int dy = -1; dy <= 1; dy++)
+		for (int dx = -1; dx <= 1; dx++)
+			testCellEntities(ray, mapX + dx, mapY + dy);
+	return (true);
+}
+
+/**
+ * castEntityRay - function finds the first entity a ray hits before a wall
+ * @grid: pointer to the grid
+ * @posX: ray origin on the x axis
+ * @posY: ray origin on the y axis
+ * @dirX: ray direction on the x axis
+ * @dirY: ray direction on the y axis
+ * @distance: receives the distance to the entity, may be NULL
+ *
+ * Walks the cells with the raycaster's DDA, so only entities near the
+ * ray are looked at, and the walk ends at the first wall.
+ *
+ * Return: id of the entity hit, or -1 if a wall comes first
+ */
+int castEntityRay(const EntityGrid *grid, double posX, double posY, double dirX, double dirY,
+		double *distance)
+{
+	double length = sqrt(dirX * dirX + dirY * dirY);
+	EntityRay ray = {grid, posX, posY, dirX / length, dirY / length, HUGE_VAL, -1};
+	double wall;
+
+	if (grid->count == 0 || length == 0)
+		return (-1);
+	wall = walkRay(posX, posY, ray.dirX, ray.dirY, HUGE_VAL, visitEntityCell, &ray);
+	/*Entities in the cells around the wall may stand behind it*/
+	if (ray.hit < 0 || ray.nearest >= wall)
+		return (-1);
+	if (distance)
+		*distance = ray.nearest;
+	return (ray.hit);
+}
+
+/**
+ * queryEntityRadius - function finds the entities within reach of a point
+ * @grid: pointer to the grid
+ * @x: centre on the x axis
+ * @y: centre on the y axis
+ * @radius: reach, measured to the edge of each entity
+ * @results: array receiving the ids found
+ * @maxResults: size of results
+ *
+ * For splash damage and sounds: walls do not block the reach. Only the
+ * cells the circle can touch are visited, unless there are more of them
+ * than entities, in which case every entity is checked instead.
+ *
+ * Return: number of entities found, at most maxResults
+ */
+int queryEntityRadius(const EntityGrid *grid, float x, float y, float radius,
+		int *results, int maxResults)
+{
+	int found = 0;
+	int minX = (int)floorf(x - radius - ENTITY_MAX_RADIUS);
+	int maxX = (int)floorf(x + radius + ENTITY_MAX_RADIUS);
+	int minY = (int)floorf(y - radius - ENTITY_MAX_RADIUS);
+	int maxY = (int)floorf(y + radius + ENTITY_MAX_RADIUS);
+
+	if ((double)(maxX - minX + 1) * (maxY - minY + 1) > grid->capacity)
+	{
+		for (int id = 0; id < grid->capacity && found < maxResults; id++)
+		{
+			float dx, dy, reach;
+
+			if (!grid->active[id])
+				continue;
+			dx = grid->x[id] - x;
+			dy = grid->y[id] - y;
+			reach = radius + grid->radius[id];
+			if (dx * dx + dy * dy <= reach * reach)
+				results[found++] = id;
+		}
+		return (found);
+	}
+	for (int cellY = minY; cellY <= maxY; cellY++)
+	{
+		for (int cellX = minX; cellX <= maxX; cellX++)
+		{
+			int id = grid->heads[hashCell(grid, cellX, cellY)];
+
+			for (; id >= 0 && found < maxResults; id = grid->next[id])
+			{
+				float dx = grid->x[id] - x, dy = grid->y[id] - y;
+				float reach = radius + grid->radius[id];
+
+				if (grid->cellX[id] == cellX && grid->cellY[id] == cellY &&
+						dx * dx + dy * dy <= reach * reach)
+					results[found++] = id;
+			}
+		}
+	}
+	return (found);
+}
+
+/**
+ * destroyEntityGrid - function frees the grid
+ * @grid: pointer to the grid, may be NULL
+ *
+ * Return: void
+ */
+void destroyEntityGrid(EntityGrid *grid)
+{
+	if (!grid)
+		return;
+	free(grid->heads);
+	free(grid->next);
+	free(grid->prev);
+	free(grid->cellX);
+	free(grid->cellY);
+	free(grid->x);
+	free(grid->y);
+	free(grid->radius);
+	free(grid->active);
+	free(grid);
+}
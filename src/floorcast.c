@@ -0,0 +1,412 @@
+#include <math.h>
+#include "../header/floorcast.h"
+#include "../header/lightmap.h"
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+/*Everything a worker needs to draw its rows*/
+typedef struct {
+	Framebuffer *fb;
+	const FloorTextures *floors;
+	bool ceiling;
+	double posX, posY, dirX, dirY, planeX, planeY;
+} FloorJob;
+
+/**
+ * floorShift - function finds the largest power of two not above a size
+ * @size: texture width or height
+ *
+ * Return: log2 of that power of two
+ */
+static int floorShift(int size)
+{
+	int shift = 0;
+
+	while ((2 << shift) <= size && shift + 1 < FLOOR_MAX_LEVELS)
+		shift++;
+	return (shift);
+}
+
+/**
+ * reduceLevel - function fills a mip level from the level above it
+ * @texels: texels of every level
+ * @from: level twice as large on each side, or as large when it is one texel
+ * @to: level to fill
+ *
+ * Return: void
+ */
+static void reduceLevel(Uint32 *texels, const FloorLevel *from, const FloorLevel *to)
+{
+	const Uint32 *src = texels + from->offset;
+	Uint32 *dst = texels + to->offset;
+	const int stepX = from->widthShift > to->widthShift;
+	const int stepY = from->heightShift > to->heightShift;
+
+	for (int y = 0; y < 1 << to->heightShift; y++)
+	{
+		const Uint32 *top = src + ((size_t)(y << stepY) << from->widthShift);
+		const Uint32 *bottom = top + ((size_t)stepY << from->widthShift);
+
+		for (int x = 0; x < 1 << to->widthShift; x++)
+		{
+			int left = x << stepX;
+
+			dst[((size_t)y << to->widthShift) + x] = averageTexels(top[left],
+					top[left + stepX], bottom[left], bottom[left + stepX]);
+		}
+	}
+}
+
+/**
+ * createFloorTextures - function builds the floor and ceiling mip chains
+ * @floors: pointer to the textures to fill in
+ * @wallAtlas: wall textures, FLOOR_TEXTURE and CEILING_TEXTURE among them
+ *
+ * Textures whose sides are not powers of two are cropped to the largest
+ * power of two that fits, so a texel is still found with shifts alone.
+ *
+ * Return: true on success, false if the texels could not be allocated
+ */
+bool createFloorTextures(FloorTextures *floors, const WallAtlas *wallAtlas)
+{
+	const int texIDs[2] = {FLOOR_TEXTURE, CEILING_TEXTURE};
+	size_t total = 0;
+
+	for (int t = 0; t < 2; t++)
+	{
+		int widthShift = floorShift(wallAtlas->width[texIDs[t]]);
+		int heightShift = floorShift(wallAtlas->height[texIDs[t]]);
+		int count = 0;
+
+		/*Halve both sides until each is one texel*/
+		do
+		{
+			floors->levels[t][count++] = (FloorLevel){(Uint32)total, widthShift, heightShift};
+			total += (size_t)1 << (widthShift + heightShift);
+			widthShift = SDL_max(widthShift - 1, 0);
+			heightShift = SDL_max(heightShift - 1, 0);
+		} while (floors->levels[t][count - 1].widthShift + floors->levels[t][count - 1].heightShift > 0);
+		floors->levelCount[t] = count;
+	}
+	floors->texels = malloc(total * sizeof(Uint32));
+	if (!floors->texels)
+	{
+		fprintf(stderr, "Failed to allocate %zu texels of floor textures\n", total);
+		return (false);
+	}
+
+	for (int t = 0; t < 2; t++)
+	{
+		const FloorLevel *top = &floors->levels[t][0];
+
+		/*Back from the atlas' columns into rows*/
+		for (int x = 0; x < 1 << top->widthShift; x++)
+		{
+			const Uint32 *column = getAtlasColumn(wallAtlas, 0, texIDs[t], x);
+
+			for (int y = 0; y < 1 << top->heightShift; y++)
+				floors->texels[top->offset + ((size_t)y << top->widthShift) + x] = column[y];
+		}
+		for (int i = 1; i < floors->levelCount[t]; i++)
+			reduceLevel(floors->texels, &floors->levels[t][i - 1], &floors->levels[t][i]);
+	}
+	return (true);
+}
+
+/**
+ * pickLevel - function chooses the mip level a row of the floor reads
+ * @floors: pointer to the floor textures
+ * @chain: 0 for the floor, 1 for the ceiling
+ * @stepX: distance along the x axis between two pixels of the row, in cells
+ * @stepY: distance along the y axis between two pixels of the row, in cells
+ *
+ * Return: the largest level in which neighbouring pixels are at most a
+ * texel apart
+ */
+static const FloorLevel *pickLevel(const FloorTextures *floors, int chain,
+		double stepX, double stepY)
+{
+	const FloorLevel *levels = floors->levels[chain];
+	double footprint = SDL_max(fabs(stepX) * (1 << levels[0].widthShift),
+			fabs(stepY) * (1 << levels[0].heightShift));
+	int i = 0;
+
+	while (footprint > 1 && i + 1 < floors->levelCount[chain])
+	{
+		footprint /= 2;
+		i++;
+	}
+	return (&levels[i]);
+}
+
+/**
+ * getTexelIndex - function finds the texel under a position inside a cell
+ * @level: pointer to the mip level read
+ * @u: position along the x axis, as a fraction of the cell
+ * @v: position along the y axis, as a fraction of the cell
+ *
+ * Return: index of the texel in FloorTextures.texels
+ */
+static inline Uint32 getTexelIndex(const FloorLevel *level, Uint32 u, Uint32 v)
+{
+	/*A shift by 32 is undefined, so one-texel sides are shifted in two steps*/
+	return (level->offset + ((v >> 1 >> (31 - level->heightShift)) << level->widthShift)
+			+ (u >> 1 >> (31 - level->widthShift)));
+}
+
+/**
+ * toCellFraction - function keeps the part of a coordinate inside its cell
+ * @value: coordinate in map cells
+ *
+ * Return: the fraction of the cell scaled to 32 bits, so that adding steps
+ * wraps around from one cell into the next on its own
+ */
+static Uint32 toCellFraction(double value)
+{
+	return ((Uint32)(Sint64)((value - floor(value)) * 4294967296.0));
+}
+
+#ifdef __SSE2__
+/*A mip level's texel lookup spread over four lanes, set up once per row*/
+typedef struct {
+	__m128i offset;
+	__m128i columnShift; /* leaves the column in the top bits of u */
+	__m128i rowShift;    /* leaves the row, times the row length, in the top bits of v */
+	__m128i rowMask;
+} LevelLanes;
+
+/**
+ * getLevelLanes - function spreads a mip level's texel lookup over four lanes
+ * @level: pointer to the mip level
+ *
+ * SSE2 shifts by 32 or more give zero, so one-texel sides need no care.
+ *
+ * Return: the lanes
+ */
+static inline LevelLanes getLevelLanes(const FloorLevel *level)
+{
+	LevelLanes lanes;
+
+	lanes.offset = _mm_set1_epi32((int)level->offset);
+	lanes.columnShift = _mm_cvtsi32_si128(32 - level->widthShift);
+	lanes.rowShift = _mm_cvtsi32_si128(32 - level->heightShift - level->widthShift);
+	lanes.rowMask = _mm_set1_epi32(((1 << level->heightShift) - 1) << level->widthShift);
+	return (lanes);
+}
+
+/**
+ * gatherTexels - function loads the texels under four positions
+ * @texels: texels of every level
+ * @lanes: pointer to the lookup of the mip level read
+ * @u: four positions along the x axis
+ * @v: four positions along the y axis
+ *
+ * The indices are computed four at a time; SSE2 has no gather, so the
+ * texels themselves are loaded one by one.
+ *
+ * Return: the four texels
+ */
+static inline __m128i gatherTexels(const Uint32 *texels, const LevelLanes *lanes,
+		__m128i u, __m128i v)
+{
+	Uint32 index[4];
+	__m128i column = _mm_srl_epi32(u, lanes->columnShift);
+	__m128i row = _mm_and_si128(_mm_srl_epi32(v, lanes->rowShift), lanes->rowMask);
+
+	_mm_storeu_si128((__m128i *)index, _mm_add_epi32(lanes->offset,
+				_mm_add_epi32(row, column)));
+	return (_mm_setr_epi32((int)texels[index[0]], (int)texels[index[1]],
+				(int)texels[index[2]], (int)texels[index[3]]));
+}
+
+/**
+ * shadeTexels - function darkens four texels by the brightness of their row
+ * @texels: four ARGB8888 texels
+ * @brightness: the row's brightness in every colour lane and 256 in the alpha lanes
+ *
+ * Return: the shaded texels
+ */
+static inline __m128i shadeTexels(__m128i texels, __m128i brightness)
+{
+	const __m128i zero = _mm_setzero_si128();
+	__m128i low = _mm_mullo_epi16(_mm_unpacklo_epi8(texels, zero), brightness);
+	__m128i high = _mm_mullo_epi16(_mm_unpackhi_epi8(texels, zero), brightness);
+
+	return (_mm_packus_epi16(_mm_srli_epi16(low, 8), _mm_srli_epi16(high, 8)));
+}
+#endif
+
+/**
+ * drawRowPair - function draws a floor row and the ceiling row mirroring it
+ * @job: pointer to the FloorJob describing the frame
+ * @y: floor row, in the bottom half of the framebuffer
+ * @floorLevel: mip level of the floor texture the row reads
+ * @ceilingLevel: mip level of the ceiling texture the mirrored row reads
+ * @u: position of the first pixel along the x axis, as a cell fraction
+ * @v: position of the first pixel along the y axis, as a cell fraction
+ * @stepU: change in u from one pixel to the next
+ * @stepV: change in v from one pixel to the next
+ * @brightness: what the row's light and fog leave, from 1 to 256 for full
+ *
+ * Both rows see the same points of the map, one on the floor and one on
+ * the ceiling, so they share the walk along the row, and their shade. Pixels
+ * the walls already cover are left alone.
+ *
+ * Return: void
+ */
+static void drawRowPair(const FloorJob *job, int y, const FloorLevel *floorLevel,
+		const FloorLevel *ceilingLevel, Uint32 u, Uint32 v, Uint32 stepU, Uint32 stepV,
+		Uint32 brightness)
+{
+	Framebuffer *fb = job->fb;
+	const Uint32 *texels = job->floors->texels;
+	const int c = fb->height - 1 - y;
+	Uint32 *floorRow = fb->pixels + (size_t)y * fb->width;
+	Uint32 *ceilingRow = fb->pixels + (size_t)c * fb->width;
+	int x = 0;
+
+#ifdef __SSE2__
+	__m128i vecU = _mm_setr_epi32((int)u, (int)(u + stepU), (int)(u + 2 * stepU),
+			(int)(u + 3 * stepU));
+	__m128i vecV = _mm_setr_epi32((int)v, (int)(v + stepV), (int)(v + 2 * stepV),
+			(int)(v + 3 * stepV));
+	const __m128i stepU4 = _mm_set1_epi32((int)(4 * stepU));
+	const __m128i stepV4 = _mm_set1_epi32((int)(4 * stepV));
+	const __m128i floorY = _mm_set1_epi32(y);
+	const __m128i ceilingY = _mm_set1_epi32(c);
+	const LevelLanes floorLanes = getLevelLanes(floorLevel);
+	const LevelLanes ceilingLanes = getLevelLanes(ceilingLevel);
+	const __m128i brightnessLanes = _mm_set_epi16(256, (short)brightness,
+			(short)brightness, (short)brightness, 256, (short)brightness,
+			(short)brightness, (short)brightness);
+
+	for (; x + 4 <= fb->width; x += 4)
+	{
+		/*Wall slices end below y where they hide the floor, start above c where they hide the ceiling*/
+		__m128i floorHidden = _mm_cmpgt_epi32(
+				_mm_loadu_si128((const __m128i *)(fb->drawEnd + x)), floorY);
+		__m128i ceilingShown = _mm_cmpgt_epi32(
+				_mm_loadu_si128((const __m128i *)(fb->drawStart + x)), ceilingY);
+
+		if (_mm_movemask_epi8(floorHidden) != 0xFFFF)
+		{
+			__m128i *dst = (__m128i *)(floorRow + x);
+			__m128i texel = gatherTexels(texels, &floorLanes, vecU, vecV);
+
+			if (brightness < 256)
+				texel = shadeTexels(texel, brightnessLanes);
+			/*Only quads the wall reaches into need what is already there*/
+			if (_mm_movemask_epi8(floorHidden) != 0)
+				texel = _mm_or_si128(_mm_andnot_si128(floorHidden, texel),
+						_mm_and_si128(floorHidden, _mm_loadu_si128(dst)));
+			_mm_storeu_si128(dst, texel);
+		}
+		if (job->ceiling && _mm_movemask_epi8(ceilingShown) != 0)
+		{
+			__m128i *dst = (__m128i *)(ceilingRow + x);
+			__m128i texel = gatherTexels(texels, &ceilingLanes, vecU, vecV);
+
+			if (brightness < 256)
+				texel = shadeTexels(texel, brightnessLanes);
+			if (_mm_movemask_epi8(ceilingShown) != 0xFFFF)
+				texel = _mm_or_si128(_mm_and_si128(ceilingShown, texel),
+						_mm_andnot_si128(ceilingShown, _mm_loadu_si128(dst)));
+			_mm_storeu_si128(dst, texel);
+		}
+		vecU = _mm_add_epi32(vecU, stepU4);
+		vecV = _mm_add_epi32(vecV, stepV4);
+	}
+	u += (Uint32)x * stepU;
+	v += (Uint32)x * stepV;
+#endif
+
+	/*The same shade in every channel*/
+	const Uint32 shade = (brightness - 1) * 0x010101;
+
+	for (; x < fb->width; x++, u += stepU, v += stepV)
+	{
+		if (y >= fb->drawEnd[x])
+			floorRow[x] = shadeTexel(texels[getTexelIndex(floorLevel, u, v)], shade);
+		if (job->ceiling && c < fb->drawStart[x])
+			ceilingRow[x] = shadeTexel(texels[getTexelIndex(ceilingLevel, u, v)], shade);
+	}
+}
+
+/**
+ * drawFloorRows - function casts a band of floor rows and their ceiling rows
+ * @context: pointer to the FloorJob describing the frame
+ * @begin: first row of the band, counted down from the horizon
+ * @end: one past the last row of the band
+ *
+ * Return: void
+ */
+static void drawFloorRows(void *context, int begin, int end)
+{
+	const FloorJob *job = context;
+	const Framebuffer *fb = job->fb;
+	const double horizon = fb->height / 2;
+
+	for (int row = begin; row < end; row++)
+	{
+		int y = fb->height / 2 + row;
+		/*The eye is halfway up the walls, so row y sees the floor this far away*/
+		double rowDistance = horizon / (y + 0.5 - horizon);
+		/*Rays of the leftmost column and the step from one column to the next*/
+		double rayDirX = job->dirX - job->planeX, rayDirY = job->dirY - job->planeY;
+		double stepX = rowDistance * 2 * job->planeX / fb->width;
+		double stepY = rowDistance * 2 * job->planeY / fb->width;
+
+		drawRowPair(job, y, pickLevel(job->floors, 0, stepX, stepY),
+				pickLevel(job->floors, 1, stepX, stepY),
+				toCellFraction(job->posX + rowDistance * rayDirX),
+				toCellFraction(job->posY + rowDistance * rayDirY),
+				toCellFraction(stepX), toCellFraction(stepY),
+				lightmap.enabled ? SDL_max(LIGHT_AMBIENT_LEVEL
+					* getFog(&lightmap, rowDistance) / 255, 1) : 256);
+	}
+}
+
+/**
+ * performFloorCasting - Function textures the floor and ceiling of a framebuffer
+ * @fb: framebuffer holding the walls of the frame and their drawStart/drawEnd
+ * @pool: worker threads sharing the rows, or NULL for the caller only
+ * @floors: floor and ceiling mip chains built by createFloorTextures
+ * @ceiling: true to texture the ceiling too, false to keep the sky drawn there
+ * @posX: player position on the x axis
+ * @posY: player position on the y axis
+ * @dirX: player direction on the x axis
+ * @dirY: player direction on the y axis
+ * @planeX: camera plane on the x axis
+ * @planeY: camera plane on the y axis
+ *
+ * Casts one row at a time instead of one column: every pixel of a row is
+ * the same distance away, so the map position moves by a constant step
+ * along the row and is walked four pixels at a time in fixed point, in
+ * the mip level where that step is about one texel, and darkened by the
+ * ambient light and the fog of the row's distance. Runs after
+ * performRaycastingSoftware and only fills the pixels above and below
+ * its wall slices.
+ *
+ * Return: void
+ */
+void performFloorCasting(Framebuffer *fb, ThreadPool *pool, const FloorTextures *floors,
+		bool ceiling, double posX, double posY, double dirX, double dirY,
+		double planeX, double planeY)
+{
+	FloorJob job = {fb, floors, ceiling, posX, posY, dirX, dirY, planeX, planeY};
+
+	runParallel(pool, fb->height - fb->height / 2, FLOOR_ROW_STRIP, drawFloorRows, &job);
+}
+
+/**
+ * destroyFloorTextures - function frees the floor and ceiling mip chains
+ * @floors: pointer to the textures
+ *
+ * Return: void
+ */
+void destroyFloorTextures(FloorTextures *floors)
+{
+	free(floors->texels);
+	floors->texels = NULL;
+}
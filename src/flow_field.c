@@ -0,0 +1,237 @@
+#include "../header/flow_field.h"
+
+/*Window cell offsets of the four sides, in the order steps are tried*/
+static const int sideOffset[4] = {1, -1, FLOW_SIZE, -FLOW_SIZE};
+
+/**
+ * createFlowField - function allocates a flow field with no layer built yet
+ *
+ * Return: pointer to the field, or NULL on failure
+ */
+FlowField *createFlowField(void)
+{
+	FlowField *field = calloc(1, sizeof(FlowField));
+
+	if (!field)
+		return (NULL);
+	field->ready = -1;
+	field->phase = FLOW_IDLE;
+	field->queue = malloc(FLOW_SIZE * FLOW_SIZE * sizeof(int));
+	for (int i = 0; i < 2; i++)
+	{
+		field->layers[i].distance = malloc(FLOW_SIZE * FLOW_SIZE * sizeof(Uint16));
+		field->layers[i].step = malloc(FLOW_SIZE * FLOW_SIZE);
+	}
+	if (!field->queue || !field->layers[0].distance || !field->layers[0].step ||
+			!field->layers[1].distance || !field->layers[1].step)
+	{
+		fprintf(stderr, "Failed to allocate the flow field\n");
+		destroyFlowField(field);
+		return (NULL);
+	}
+	return (field);
+}
+
+/**
+ * startLayer - function starts building a layer toward a goal
+ * @field: pointer to the flow field
+ * @map: map whose walls the NPCs walk around
+ * @goalX: goal cell column
+ * @goalY: goal cell row
+ *
+ * The window is centred on the goal, and kept inside maps large enough
+ * to fill it, up to the ring of walls around it.
+ *
+ * Return: void
+ */
+static void startLayer(FlowField *field, const Map *map, int goalX, int goalY)
+{
+	FlowLayer *layer = &field->layers[field->ready == 0];
+
+	layer->originX = SDL_max(SDL_min(goalX - FLOW_SIZE / 2, map->width + 1 - FLOW_SIZE), -1);
+	layer->originY = SDL_max(SDL_min(goalY - FLOW_SIZE / 2, map->height + 1 - FLOW_SIZE), -1);
+	layer->goalX = goalX;
+	layer->goalY = goalY;
+	layer->mapVersion = map->version;
+	layer->reached = 0;
+	field->row = 0;
+	field->head = 0;
+	field->phase = FLOW_WALLS;
+}
+
+/**
+ * copyWalls - function reads the walls of the next rows of the window
+ * @field: pointer to the flow field
+ * @layer: pointer to the layer being built
+ * @map: map whose walls the NPCs walk around
+ * @budget: most cells to read
+ *
+ * Cells outside the map, and the outer ring of the window, count as
+ * walls, so the search never has to check where it is. Once every row
+ * is read, the goal is put in the queue.
+ *
+ * Return: number of cells read
+ */
+static int copyWalls(FlowField *field, FlowLayer *layer, const Map *map, int budget)
+{
+	int visited = 0;
+
+	while (field->row < FLOW_SIZE && visited < budget)
+	{
+		int y = field->row++, mapY = layer->originY + y;
+		Uint16 *distance = layer->distance + (y << FLOW_SHIFT);
+
+		memset(layer->step + (y << FLOW_SHIFT), FLOW_NO_STEP, FLOW_SIZE);
+		if (y == 0 || y == FLOW_SIZE - 1 || (unsigned)mapY >= (unsigned)map->height)
+		{
+			for (int x = 0; x < FLOW_SIZE; x++)
+				distance[x] = FLOW_WALL;
+		}
+		else
+		{
+			for (int x = 0; x < FLOW_SIZE; x++)
+			{
+				int mapX = layer->originX + x;
+
+				distance[x] = (unsigned)mapX < (unsigned)map->width &&
+					getMapCell(map, mapX, mapY) == 0 ? FLOW_UNREACHED : FLOW_WALL;
+			}
+			distance[0] = FLOW_WALL;
+			distance[FLOW_SIZE - 1] = FLOW_WALL;
+		}
+		visited += FLOW_SIZE;
+	}
+	if (field->row == FLOW_SIZE)
+	{
+		int goal = ((layer->goalY - layer->originY) << FLOW_SHIFT) | (layer->goalX - layer->originX);
+
+		/*A goal in a wall or outside the window leaves every cell unreached*/
+		if ((unsigned)(layer->goalX - layer->originX) < FLOW_SIZE &&
+				(unsigned)(layer->goalY - layer->originY) < FLOW_SIZE &&
+				layer->distance[goal] == FLOW_UNREACHED)
+		{
+			field->queue[0] = goal;
+			layer->distance[goal] = 0;
+			layer->reached = 1;
+		}
+		field->phase = FLOW_SPREAD;
+	}
+	return (visited);
+}
+
+/**
+ * pickStep - function picks the step of a cell the search has reached
+ * @layer: pointer to the layer being built
+ * @cell: window index of the cell, not the goal
+ *
+ * Breadth-first order sets every cell nearer the goal before this one is
+ * spread from, so its step can be picked at once. It goes to a side one
+ * step nearer the goal, or to the diagonal between two such sides when
+ * the diagonal is nearer still, so NPCs never cut a wall's corner.
+ *
+ * Return: void
+ */
+static inline void pickStep(FlowLayer *layer, int cell)
+{
+	const Uint16 *distance = layer->distance;
+	Uint16 nearer = distance[cell] - 1;
+	int dx = distance[cell + 1] == nearer ? 1 : distance[cell - 1] == nearer ? -1 : 0;
+	int dy = distance[cell + FLOW_SIZE] == nearer ? 1 : distance[cell - FLOW_SIZE] == nearer ? -1 : 0;
+
+	if (dx != 0 && dy != 0 && distance[cell + dx + dy * FLOW_SIZE] != nearer - 1)
+		dy = 0;
+	layer->step[cell] = (Uint8)((dx + 1) | (dy + 1) << 2);
+}
+
+/**
+ * spreadLayer - function carries the search on from the cells reached last
+ * @field: pointer to the flow field
+ * @layer: pointer to the layer being built
+ * @budget: most cells to spread from
+ *
+ * Return: number of cells spread from
+ */
+static int spreadLayer(FlowField *field, FlowLayer *layer, int budget)
+{
+	int visited = 0;
+
+	while (field->head < layer->reached && visited < budget)
+	{
+		int cell = field->queue[field->head++];
+		Uint16 distance = layer->distance[cell] + 1;
+
+		if (distance > 1)
+			pickStep(layer, cell);
+		for (int i = 0; i < 4; i++)
+		{
+			int next = cell + sideOffset[i];
+
+			if (layer->distance[next] != FLOW_UNREACHED)
+				continue;
+			layer->distance[next] = distance;
+			field->queue[layer->reached++] = next;
+		}
+		visited++;
+	}
+	return (visited);
+}
+
+/**
+ * updateFlowField - function keeps the flow field leading to a goal
+ * @field: pointer to the flow field
+ * @map: map whose walls the NPCs walk around
+ * @goalX: cell column of the goal, usually the player's
+ * @goalY: cell row of the goal
+ * @budget: most cells to visit in this call
+ *
+ * Starts a new layer when the goal has moved to another cell or the map
+ * changed since the last one was started, and carries on building it.
+ * A layer that is finished becomes the one getFlowStep reads.
+ *
+ * Return: number of cells visited
+ */
+int updateFlowField(FlowField *field, const Map *map, int goalX, int goalY, int budget)
+{
+	FlowLayer *layer;
+	int visited = 0;
+
+	if (field->phase == FLOW_IDLE)
+	{
+		const FlowLayer *ready = field->ready < 0 ? NULL : &field->layers[field->ready];
+
+		if (ready && ready->goalX == goalX && ready->goalY == goalY &&
+				ready->mapVersion == map->version)
+			return (0);
+		startLayer(field, map, goalX, goalY);
+	}
+	layer = &field->layers[field->ready == 0];
+	if (field->phase == FLOW_WALLS)
+		visited += copyWalls(field, layer, map, budget);
+	if (field->phase == FLOW_SPREAD)
+		visited += spreadLayer(field, layer, budget - visited);
+	if (field->phase != FLOW_SPREAD || field->head < layer->reached)
+		return (visited);
+	field->ready = field->ready == 0;
+	field->phase = FLOW_IDLE;
+	field->rebuilds++;
+	return (visited);
+}
+
+/**
+ * destroyFlowField - function frees a flow field
+ * @field: pointer to the field, may be NULL
+ *
+ * Return: void
+ */
+void destroyFlowField(FlowField *field)
+{
+	if (!field)
+		return;
+	for (int i = 0; i < 2; i++)
+	{
+		free(field->layers[i].distance);
+		free(field->layers[i].step);
+	}
+	free(field->queue);
+	free(field);
+}
@@ -0,0 +1,102 @@
+#include "../header/framebuffer.h"
+
+/**
+ * createFramebuffer - function allocates the pixel, depth and slice buffers and the texture
+ * @fb: pointer to the framebuffer to initialize
+ * @renderer: SDL renderer pointer, or NULL for a framebuffer that is never presented
+ * @width: framebuffer width in pixels
+ * @height: framebuffer height in pixels
+ *
+ * Return: true on success, false otherwise
+ */
+bool createFramebuffer(Framebuffer *fb, SDL_Renderer *renderer, int width, int height)
+{
+	fb->width = fb->maxWidth = width;
+	fb->height = fb->maxHeight = height;
+	fb->pixels = malloc(sizeof(Uint32) * width * height);
+	fb->depth = malloc(sizeof(double) * width);
+	fb->drawStart = malloc(sizeof(int) * width);
+	fb->drawEnd = malloc(sizeof(int) * width);
+	fb->texture = NULL;
+
+	if (!fb->pixels || !fb->depth || !fb->drawStart || !fb->drawEnd)
+	{
+		fprintf(stderr, "Failed to allocate %dx%d framebuffer\n", width, height);
+		destroyFramebuffer(fb);
+		return (false);
+	}
+	if (!renderer)
+		return (true);
+	fb->texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888,
+			SDL_TEXTUREACCESS_STREAMING, width, height);
+
+	if (!fb->texture)
+	{
+		fprintf(stderr, "Framebuffer texture creation failed: %s\n", SDL_GetError());
+		destroyFramebuffer(fb);
+		return (false);
+	}
+	return (true);
+}
+
+/**
+ * resizeFramebuffer - function changes the size frames are drawn at
+ * @fb: pointer to the framebuffer
+ * @renderer: SDL renderer pointer
+ * @width: new width in pixels
+ * @height: new height in pixels
+ *
+ * Only reallocates when the new size does not fit in the buffers.
+ *
+ * Return: true on success, false if reallocating failed
+ */
+bool resizeFramebuffer(Framebuffer *fb, SDL_Renderer *renderer, int width, int height)
+{
+	if (width <= fb->maxWidth && height <= fb->maxHeight)
+	{
+		fb->width = width;
+		fb->height = height;
+		return (true);
+	}
+	destroyFramebuffer(fb);
+	return (createFramebuffer(fb, renderer, width, height));
+}
+
+/**
+ * presentFramebuffer - function uploads the pixels and copies them to the screen
+ * @fb: pointer to the framebuffer
+ * @renderer: SDL renderer pointer
+ *
+ * The frame is stretched over the whole output in this one copy, which is
+ * where a lowered render resolution is scaled back up.
+ *
+ * Return: void
+ */
+void presentFramebuffer(Framebuffer *fb, SDL_Renderer *renderer)
+{
+	SDL_Rect frame = {0, 0, fb->width, fb->height};
+
+	SDL_UpdateTexture(fb->texture, &frame, fb->pixels, fb->width * sizeof(Uint32));
+	SDL_RenderCopy(renderer, fb->texture, &frame, NULL);
+}
+
+/**
+ * destroyFramebuffer - function releases the framebuffer memory and texture
+ * @fb: pointer to the framebuffer
+ *
+ * Return: void
+ */
+void destroyFramebuffer(Framebuffer *fb)
+{
+	if (fb->texture)
+		SDL_DestroyTexture(fb->texture);
+	free(fb->pixels);
+	free(fb->depth);
+	free(fb->drawStart);
+	free(fb->drawEnd);
+	fb->texture = NULL;
+	fb->pixels = NULL;
+	fb->depth = NULL;
+	fb->drawStart = NULL;
+	fb->drawEnd = NULL;
+}
@@ -1,30 +1,23 @@
 #include <stdbool.h>
 #include "../header/input.h"
+#include "../header/minimap.h"
+#include "../header/camera.h"
+#include "../header/input_log.h"
+#include "../header/weapon.h"
 
 /**
- * handlePLayerInput - Function handles player inputs like movement
+ * handlePLayerInput - Function handles player key presses like toggles
  * @event: SDL event handler
  * @running: game loop control variable
  * @showMiniMap: variable to help toggle minimap display
  * @showRain: variable to help toggle rain
- * @posX: player position on the x axis
- * @posY: player position on the y axis
- * @dirX: player direction on the x axis
- * @dirY: player direction on the y axis
- * @planeX: camera plane on the x axis
- * @planeY: camera plane on the y axis
+ * @options: render settings toggled from the keyboard
  * 
  * Return: has no return value to the caller function
  */
 void handlePlayerInput(SDL_Event *event, bool *running,
-		bool *showMiniMap, bool *showRain, double *posX, double *posY, double *dirX,
-		double *dirY, double *planeX, double *planeY)
+		bool *showMiniMap, bool *showRain, GameOptions *options)
 {
-	/*Declare player movement speed*/
-	const double moveSpeed = 0.06;
-	const double rotSpeed = 0.03;
-	const Uint8 *state;
-
 	/*end game loop when player quits the game*/
 	if (event->type == SDL_QUIT)
 		*running = false;
@@ -45,48 +38,206 @@ void handlePlayerInput(SDL_Event *event, bool *running,
 			case SDLK_r:
 				     *showRain = !*showRain;
 			break;
+			/* Toggle between SDL and software wall rendering */
+			case SDLK_b:
+				     options->renderMode = options->renderMode == RENDER_SDL ?
+					     RENDER_SOFTWARE : RENDER_SDL;
+			break;
+			/* Sky or textured ceiling over the software renderer */
+			case SDLK_k:
+				     options->showSky = !options->showSky;
+			break;
+			/* More or fewer software render threads, at most one per core */
+			case SDLK_EQUALS:
+				     if (options->threadCount < SDL_GetCPUCount())
+					     options->threadCount++;
+			break;
+			case SDLK_MINUS:
+				     if (options->threadCount > 1)
+					     options->threadCount--;
+			break;
+			/* Zoom the minimap in and out */
+			case SDLK_PAGEUP:
+				     if (options->minimapZoom > 0)
+					     options->minimapZoom--;
+			break;
+			case SDLK_PAGEDOWN:
+				     if (options->minimapZoom < MINIMAP_ZOOM_LEVELS - 1)
+					     options->minimapZoom++;
+			break;
+			/* Toggle the profiler overlay */
+			case SDLK_p:
+				     options->showProfiler = !options->showProfiler;
+			break;
 		}
 	}
+}
 
-	state = SDL_GetKeyboardState(NULL);
+/**
+ * readTickInput - Function samples what the player asks of the next tick
+ * @fire: true if the fire key was pressed since the last tick
+ *
+ * Return: INPUT_* bits of the keys held, plus INPUT_FIRE if asked for
+ */
+Uint8 readTickInput(bool fire)
+{
+	const Uint8 *state = SDL_GetKeyboardState(NULL);
+	Uint8 input = fire ? INPUT_FIRE : 0;
 
-	/*Move the player up when the W or arrow up key is pressed*/
 	if (state[SDL_SCANCODE_UP] || state[SDL_SCANCODE_W])
+		input |= INPUT_FORWARD;
+	if (state[SDL_SCANCODE_DOWN] || state[SDL_SCANCODE_S])
+		input |= INPUT_BACKWARD;
+	if (state[SDL_SCANCODE_LEFT] || state[SDL_SCANCODE_A])
+		input |= INPUT_TURN_LEFT;
+	if (state[SDL_SCANCODE_RIGHT] || state[SDL_SCANCODE_D])
+		input |= INPUT_TURN_RIGHT;
+	return (input);
+}
+
+/**
+ * updatePlayerMovement - Function moves the player for one simulation tick
+ * @player: player position, direction and camera plane
+ * @input: INPUT_* bits for the tick, from the keyboard or an input log
+ *
+ * Runs exactly TICK_RATE times per simulated second, so the speeds below
+ * are per tick and do not depend on the frame rate or on how many events
+ * arrived.
+ *
+ * Return: void
+ */
+void updatePlayerMovement(Player *player, Uint8 input)
+{
+	/*Declare player movement speed*/
+	const double moveSpeed = 0.06;
+
+	/*Move the player up when the W or arrow up key is pressed*/
+	if (input & INPUT_FORWARD)
 	{
-		if (worldMap[(int)(*posX + *dirX * moveSpeed)][(int)(*posY)] == 0)
-			*posX += *dirX * moveSpeed;
-		if (worldMap[(int)(*posX)][(int)(*posY + *dirY * moveSpeed)] == 0)
-			*posY += *dirY * moveSpeed;
+		if (getMapCell(&worldMap, (int)(player->posX + player->dirX * moveSpeed),
+					(int)(player->posY)) == 0)
+			player->posX += player->dirX * moveSpeed;
+		if (getMapCell(&worldMap, (int)(player->posX),
+					(int)(player->posY + player->dirY * moveSpeed)) == 0)
+			player->posY += player->dirY * moveSpeed;
 	}
 
     /*Move the player down when the S or arrow down key is pressed*/
-	if (state[SDL_SCANCODE_DOWN] || state[SDL_SCANCODE_S])
+	if (input & INPUT_BACKWARD)
 	{
-		if (worldMap[(int)(*posX - *dirX * moveSpeed)][(int)(*posY)] == 0)
-			*posX -= *dirX * moveSpeed;
-		if (worldMap[(int)(*posX)][(int)(*posY - *dirY * moveSpeed)] == 0)
-			*posY -= *dirY * moveSpeed;
+		if (getMapCell(&worldMap, (int)(player->posX - player->dirX * moveSpeed),
+					(int)(player->posY)) == 0)
+			player->posX -= player->dirX * moveSpeed;
+		if (getMapCell(&worldMap, (int)(player->posX),
+					(int)(player->posY - player->dirY * moveSpeed)) == 0)
+			player->posY -= player->dirY * moveSpeed;
 	}
 
-    /*Rotate the player left when the A or arrow left key is pressed*/
-	if (state[SDL_SCANCODE_RIGHT] || state[SDL_SCANCODE_D])
+	/*Turn by whole table steps, so the same keys always give the same view*/
+	if (input & INPUT_TURN_RIGHT)
+		setPlayerAngle(player, player->angle - ROTATION_STEPS);
+	if (input & INPUT_TURN_LEFT)
+		setPlayerAngle(player, player->angle + ROTATION_STEPS);
+}
+
+/**
+ * interpolatePlayer - Function blends two simulation ticks for rendering
+ * @previous: player state at the previous tick
+ * @current: player state at the latest tick
+ * @alpha: fraction of a tick elapsed since the latest tick, in [0, 1)
+ * @out: receives the blended state
+ *
+ * A tick only turns the view by ROTATION_STEPS, so blending the direction
+ * and plane linearly stays visually indistinguishable from a true rotation.
+ * The blend is only drawn; the simulation keeps the table values.
+ *
+ * Return: void
+ */
+void interpolatePlayer(const Player *previous, const Player *current,
+		double alpha, Player *out)
+{
+	out->posX = previous->posX + (current->posX - previous->posX) * alpha;
+	out->posY = previous->posY + (current->posY - previous->posY) * alpha;
+	out->dirX = previous->dirX + (current->dirX - previous->dirX) * alpha;
+	out->dirY = previous->dirY + (current->dirY - previous->dirY) * alpha;
+	out->planeX = previous->planeX + (current->planeX - previous->planeX) * alpha;
+	out->planeY = previous->planeY + (current->planeY - previous->planeY) * alpha;
+	out->angle = current->angle;
+}
+
+/**
+ * spawnPlayer - Function puts the player where every session starts
+ * @player: receives the start position, direction and camera plane
+ *
+ * The start is the middle of cell SPAWN_X, SPAWN_Y, facing along -x with
+ * the plane along +y. Other maps may have a wall, or nothing, there, so
+ * the nearest empty cell is taken instead.
+ *
+ * Return: true on success, false if the map has no empty cell
+ */
+bool spawnPlayer(Player *player)
+{
+	int spawnX, spawnY;
+
+	*player = (Player){SPAWN_X, SPAWN_Y, 0, 0, 0, 0, 0};
+	setPlayerAngle(player, ANGLE_STEPS / 2);
+	if (!findEmptyCell(&worldMap, SPAWN_X, SPAWN_Y, &spawnX, &spawnY))
 	{
-		double oldDirX = *dirX;
-		*dirX = *dirX * cos(-rotSpeed) - *dirY * sin(-rotSpeed);
-		*dirY = oldDirX * sin(-rotSpeed) + *dirY * cos(-rotSpeed);
-		double oldPlaneX = *planeX;
-		*planeX = *planeX * cos(-rotSpeed) - *planeY * sin(-rotSpeed);
-		*planeY = oldPlaneX * sin(-rotSpeed) + *planeY * cos(-rotSpeed);
+		fprintf(stderr, "The map has no empty cell to start in\n");
+		return (false);
 	}
-
-    /*Rotate the player right when the D or arrow right key is pressed*/
-	if (state[SDL_SCANCODE_LEFT] || state[SDL_SCANCODE_A])
+	if (spawnX != SPAWN_X || spawnY != SPAWN_Y)
 	{
-		double oldDirX = *dirX;
-		*dirX = *dirX * cos(rotSpeed) - *dirY * sin(rotSpeed);
-		*dirY = oldDirX * sin(rotSpeed) + *dirY * cos(rotSpeed);
-		double oldPlaneX = *planeX;
-		*planeX = *planeX * cos(rotSpeed) - *planeY * sin(rotSpeed);
-		*planeY = oldPlaneX * sin(rotSpeed) + *planeY * cos(rotSpeed);
+		player->posX = spawnX + 0.5;
+		player->posY = spawnY + 0.5;
 	}
+	return (true);
+}
+
+/**
+ * initGameState - Function sets up the state of a session before its first tick
+ * @game: state to set up
+ * @sprites: sprites of the session, placed and scattered
+ *
+ * Return: true on success, false if the map has no room or memory ran out
+ */
+bool initGameState(GameState *game, SpriteSet *sprites)
+{
+	if (!spawnPlayer(&game->player))
+		return (false);
+	game->weaponState = WEAPON_AIM;
+	game->weaponStateTime = 0;
+	game->sprites = sprites;
+	game->npcs = createEntityGrid(sprites->count);
+	if (!game->npcs)
+		return (false);
+	for (int i = 0; i < sprites->count; i++)
+		if (sprites->kind[i] >= SPRITE_FIRST_NPC)
+			insertEntity(game->npcs, i, sprites->x[i], sprites->y[i], NPC_RADIUS);
+	return (true);
+}
+
+/**
+ * runTick - Function runs one simulation tick
+ * @game: state of the session
+ * @input: INPUT_* bits for the tick, from the keyboard or an input log
+ * @tick: number of ticks run before this one
+ *
+ * The game and replays both go through here, so a recorded session plays
+ * back through the same movement, collision and weapon code.
+ *
+ * Return: true if the weapon fired this tick, false otherwise
+ */
+bool runTick(GameState *game, Uint8 input, Uint64 tick)
+{
+	Uint32 now = (Uint32)((tick + 1) * 1000 / TICK_RATE);
+	bool fired;
+
+	updatePlayerMovement(&game->player, input);
+	fired = (input & INPUT_FIRE) &&
+		fireWeapon(&game->weaponState, &game->weaponStateTime, now);
+	if (fired)
+		shootNpcs(game->npcs, game->sprites, &game->player);
+	updateWeaponState(&game->weaponState, &game->weaponStateTime, now);
+	return (fired);
 }
@@ -0,0 +1,197 @@
+#include <string.h>
+#include "../header/input_log.h"
+
+/*Ticks one run can stand for*/
+#define INPUT_RUN_MAX 255
+
+/**
+ * getMapChecksum - function identifies the cells a session was played on
+ * @map: pointer to the map
+ *
+ * Return: hash of the cells
+ */
+uint64_t getMapChecksum(const Map *map)
+{
+	return (hashMapCells(map->cells, (size_t)map->tilesX * map->tilesY * MAP_TILE * MAP_TILE));
+}
+
+/**
+ * createInputLog - function starts an empty log for a new session
+ * @seed: seed the session scatters sprites and particles with
+ * @extraSprites: sprites scattered besides the placed ones
+ * @mapChecksum: getMapChecksum of the map played
+ *
+ * Return: pointer to the log, or NULL on failure
+ */
+InputLog *createInputLog(Uint32 seed, int extraSprites, uint64_t mapChecksum)
+{
+	InputLog *log = calloc(1, sizeof(InputLog));
+
+	if (!log)
+		return (NULL);
+	log->seed = seed;
+	log->extraSprites = extraSprites;
+	log->mapChecksum = mapChecksum;
+	return (log);
+}
+
+/**
+ * recordTick - function appends the input of one simulation tick
+ * @log: pointer to the log
+ * @input: INPUT_* bits held or requested during the tick
+ *
+ * Return: true on success, false if the log could not grow
+ */
+bool recordTick(InputLog *log, Uint8 input)
+{
+	if (log->tickCount == log->capacity)
+	{
+		int capacity = log->capacity ? log->capacity * 2 : TICK_RATE * 60;
+		Uint8 *ticks = realloc(log->ticks, capacity);
+
+		if (!ticks)
+		{
+			fprintf(stderr, "Failed to grow the input log past %d ticks\n", log->tickCount);
+			return (false);
+		}
+		log->ticks = ticks;
+		log->capacity = capacity;
+	}
+	log->ticks[log->tickCount++] = input;
+	return (true);
+}
+
+/**
+ * swapInputLogHeader - function converts a log header to or from the file's byte order
+ * @header: pointer to the header, converted in place
+ *
+ * Logs are little-endian, so this does nothing on little-endian hosts.
+ *
+ * Return: void
+ */
+static void swapInputLogHeader(InputLogHeader *header)
+{
+	header->version = SDL_SwapLE16(header->version);
+	header->tickRate = SDL_SwapLE16(header->tickRate);
+	header->seed = SDL_SwapLE32(header->seed);
+	header->extraSprites = SDL_SwapLE32(header->extraSprites);
+	header->tickCount = SDL_SwapLE32(header->tickCount);
+	header->runCount = SDL_SwapLE32(header->runCount);
+	header->mapChecksum = SDL_SwapLE64(header->mapChecksum);
+}
+
+/**
+ * saveInputLog - function writes a log in the input log format
+ * @log: pointer to the log
+ * @path: path of the file to write
+ *
+ * Ticks are written as runs, so a player holding a key, or nothing, for
+ * a second costs a few bytes.
+ *
+ * Return: true on success, false if the file could not be written
+ */
+bool saveInputLog(const InputLog *log, const char *path)
+{
+	FILE *file = fopen(path, "wb");
+	Uint8 *runs = malloc((size_t)log->tickCount * 2 + 1);
+	InputLogHeader header = {0};
+	size_t size = 0;
+	bool written;
+
+	if (!file || !runs)
+	{
+		fprintf(stderr, "Failed to write the input log %s\n", path);
+		free(runs);
+		if (file)
+			fclose(file);
+		return (false);
+	}
+	for (int i = 0; i < log->tickCount;)
+	{
+		int length = 1;
+
+		while (i + length < log->tickCount && length < INPUT_RUN_MAX &&
+				log->ticks[i + length] == log->ticks[i])
+			length++;
+		runs[size++] = log->ticks[i];
+		runs[size++] = (Uint8)length;
+		i += length;
+	}
+	memcpy(header.magic, INPUT_LOG_MAGIC, sizeof(header.magic));
+	header.version = INPUT_LOG_VERSION;
+	header.tickRate = TICK_RATE;
+	header.seed = log->seed;
+	header.extraSprites = log->extraSprites;
+	header.tickCount = log->tickCount;
+	header.runCount = (uint32_t)(size / 2);
+	header.mapChecksum = log->mapChecksum;
+	swapInputLogHeader(&header);
+
+	written = fwrite(&header, sizeof(header), 1, file) == 1 &&
+		fwrite(runs, 1, size, file) == size;
+	free(runs);
+	return (fclose(file) == 0 && written);
+}
+
+/**
+ * loadInputLog - function reads a log written by saveInputLog
+ * @path: path of the file
+ *
+ * Return: pointer to the log, or NULL if the file is missing or not a
+ * log this build can replay
+ */
+InputLog *loadInputLog(const char *path)
+{
+	FILE *file = fopen(path, "rb");
+	InputLogHeader header;
+	InputLog *log = NULL;
+	Uint8 run[2];
+	bool valid;
+
+	if (!file)
+	{
+		fprintf(stderr, "Failed to open input log: %s\n", path);
+		return (NULL);
+	}
+	valid = fread(&header, sizeof(header), 1, file) == 1;
+	swapInputLogHeader(&header);
+	valid = valid && memcmp(header.magic, INPUT_LOG_MAGIC, sizeof(header.magic)) == 0 &&
+		header.version == INPUT_LOG_VERSION && header.tickRate == TICK_RATE &&
+		header.tickCount <= INT32_MAX;
+	if (valid)
+		log = createInputLog(header.seed, (int)header.extraSprites, header.mapChecksum);
+	if (log && header.tickCount > 0)
+	{
+		log->ticks = malloc(header.tickCount);
+		log->capacity = log->ticks ? (int)header.tickCount : 0;
+	}
+	for (uint32_t r = 0; log && r < header.runCount && valid; r++)
+	{
+		valid = fread(run, 1, sizeof(run), file) == sizeof(run) && run[1] > 0 &&
+			log->tickCount + run[1] <= log->capacity;
+		for (int i = 0; valid && i < run[1]; i++)
+			log->ticks[log->tickCount++] = run[0];
+	}
+	fclose(file);
+	if (!valid || !log || log->tickCount != (int)header.tickCount)
+	{
+		fprintf(stderr, "%s is not an input log for %d ticks per second\n", path, TICK_RATE);
+		destroyInputLog(log);
+		return (NULL);
+	}
+	return (log);
+}
+
+/**
+ * destroyInputLog - function frees a log
+ * @log: pointer to the log, may be NULL
+ *
+ * Return: void
+ */
+void destroyInputLog(InputLog *log)
+{
+	if (!log)
+		return;
+	free(log->ticks);
+	free(log);
+}
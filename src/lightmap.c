@@ -0,0 +1,403 @@
+#include <math.h>
+#include "../header/lightmap.h"
+
+/*Light on the walls of worldMap*/
+Lightmap lightmap;
+
+/*Light given off by each sprite kind, radius 0 for none*/
+static const struct {
+	float radius;
+	Uint32 color;
+} spriteLights[SPRITE_KIND_COUNT] = {
+	{6.0f, 0x00FFB060}, /* candlebra */
+	{5.0f, 0x0040FF40}, /* green_light */
+	{5.0f, 0x00FF4030}, /* red_light */
+	{0, 0}, {0, 0}, {0, 0}
+};
+
+/*Outward normal of each face, in getWallFace order*/
+static const int faceNormals[4][2] = {{1, 0}, {-1, 0}, {0, -1}, {0, 1}};
+
+/**
+ * initLightmap - function prepares an unlit lightmap and the fog table
+ * @lights: pointer to the lightmap
+ * @width: map width in cells
+ * @height: map height in cells
+ *
+ * Return: true on success, false if memory ran out
+ */
+bool initLightmap(Lightmap *lights, int width, int height)
+{
+	lights->regionsX = (width + LIGHT_REGION - 1) >> LIGHT_REGION_SHIFT;
+	lights->regionsY = (height + LIGHT_REGION - 1) >> LIGHT_REGION_SHIFT;
+	lights->regions = calloc((size_t)lights->regionsX * lights->regionsY, sizeof(Uint32 *));
+	lights->dirty = calloc((size_t)lights->regionsX * lights->regionsY, sizeof(bool));
+	lights->dirtyCount = 0;
+	lights->mapVersion = worldMap.version;
+	lights->lights = NULL;
+	lights->lightCount = 0;
+	lights->lightCapacity = 0;
+	if (!lights->regions || !lights->dirty)
+	{
+		fprintf(stderr, "Failed to allocate the lightmap for %dx%d cells\n", width, height);
+		destroyLightmap(lights);
+		return (false);
+	}
+	for (int i = 0; i < FOG_STEPS; i++)
+	{
+		double distance = (i + 0.5) / FOG_STEPS_PER_CELL;
+
+		lights->fog[i] = (Uint16)lround(256 * exp(-FOG_DENSITY * SDL_max(distance - FOG_START, 0)));
+	}
+	lights->enabled = true;
+	return (true);
+}
+
+/**
+ * markLightArea - function flags the blocks a square of cells touches for rebaking
+ * @lights: pointer to the lightmap
+ * @x: centre of the square on the x axis
+ * @y: centre of the square on the y axis
+ * @reach: half the side of the square
+ *
+ * Return: void
+ */
+static void markLightArea(Lightmap *lights, float x, float y, float reach)
+{
+	int left = SDL_max((int)floorf(x - reach) >> LIGHT_REGION_SHIFT, 0);
+	int right = SDL_min((int)floorf(x + reach) >> LIGHT_REGION_SHIFT, lights->regionsX - 1);
+	int top = SDL_max((int)floorf(y - reach) >> LIGHT_REGION_SHIFT, 0);
+	int bottom = SDL_min((int)floorf(y + reach) >> LIGHT_REGION_SHIFT, lights->regionsY - 1);
+
+	for (int ry = top; ry <= bottom; ry++)
+	{
+		for (int rx = left; rx <= right; rx++)
+		{
+			bool *dirty = &lights->dirty[ry * lights->regionsX + rx];
+
+			lights->dirtyCount += !*dirty;
+			*dirty = true;
+		}
+	}
+}
+
+/**
+ * addLight - function places a light
+ * @lights: pointer to the lightmap
+ * @x: position on the x axis, in an open cell
+ * @y: position on the y axis
+ * @radius: reach in cells, at most LIGHT_MAX_RADIUS
+ * @color: light added at the light itself, as 0x00RRGGBB
+ *
+ * Return: index of the light, or -1 if memory ran out
+ */
+int addLight(Lightmap *lights, float x, float y, float radius, Uint32 color)
+{
+	if (lights->lightCount == lights->lightCapacity)
+	{
+		int capacity = lights->lightCapacity ? lights->lightCapacity * 2 : 16;
+		Light *grown = realloc(lights->lights, sizeof(Light) * capacity);
+
+		if (!grown)
+		{
+			fprintf(stderr, "Failed to grow the lights to %d\n", capacity);
+			return (-1);
+		}
+		lights->lights = grown;
+		lights->lightCapacity = capacity;
+	}
+	lights->lights[lights->lightCount] = (Light){x, y, SDL_min(radius, LIGHT_MAX_RADIUS), color};
+	markLightArea(lights, x, y, lights->lights[lights->lightCount].radius);
+	return (lights->lightCount++);
+}
+
+/**
+ * moveLight - function moves a light
+ * @lights: pointer to the lightmap
+ * @i: index of the light
+ * @x: new position on the x axis
+ * @y: new position on the y axis
+ *
+ * Return: void
+ */
+void moveLight(Lightmap *lights, int i, float x, float y)
+{
+	Light *light = &lights->lights[i];
+
+	markLightArea(lights, light->x, light->y, light->radius);
+	light->x = x;
+	light->y = y;
+	markLightArea(lights, x, y, light->radius);
+}
+
+/**
+ * removeLight - function takes a light away
+ * @lights: pointer to the lightmap
+ * @i: index of the light; the last light takes its index
+ *
+ * Return: void
+ */
+void removeLight(Lightmap *lights, int i)
+{
+	markLightArea(lights, lights->lights[i].x, lights->lights[i].y, lights->lights[i].radius);
+	lights->lights[i] = lights->lights[--lights->lightCount];
+}
+
+/**
+ * addSpriteLights - function places a light on every lamp sprite
+ * @lights: pointer to the lightmap
+ * @sprites: sprites of the level
+ *
+ * Return: true on success, false if memory ran out
+ */
+bool addSpriteLights(Lightmap *lights, const SpriteSet *sprites)
+{
+	for (int i = 0; i < sprites->count; i++)
+	{
+		int kind = sprites->kind[i];
+
+		if (spriteLights[kind].radius > 0 && addLight(lights, sprites->x[i], sprites->y[i],
+					spriteLights[kind].radius, spriteLights[kind].color) < 0)
+			return (false);
+	}
+	return (true);
+}
+
+/**
+ * updateLightCell - function marks what a changed map cell can relight
+ * @lights: pointer to the lightmap
+ * @x: column of the cell changed with setMapCell
+ * @y: row of the cell
+ *
+ * The cell's own faces and its neighbours' change, and so do the shadows
+ * it casts or stops casting on everything the lights around it reach.
+ * bakeLightmap calls it for every cell setMapCell logged since the last
+ * bake.
+ *
+ * Return: void
+ */
+void updateLightCell(Lightmap *lights, int x, int y)
+{
+	markLightArea(lights, x + 0.5f, y + 0.5f, 1.5f);
+	for (int i = 0; i < lights->lightCount; i++)
+	{
+		const Light *light = &lights->lights[i];
+		/*Anything in the cell is within a cell's diagonal of its centre*/
+		float reach = light->radius + 0.75f;
+
+		if (fabsf(light->x - (x + 0.5f)) < reach && fabsf(light->y - (y + 0.5f)) < reach)
+			markLightArea(lights, light->x, light->y, light->radius);
+	}
+}
+
+/**
+ * visitAnyCell - walkRay visitor that walks on until a wall
+ * @context: unused
+ * @mapX: unused
+ * @mapY: unused
+ * @distance: unused
+ *
+ * Return: true
+ */
+static bool visitAnyCell(void *context, int mapX, int mapY, double distance)
+{
+	(void)context;
+	(void)mapX;
+	(void)mapY;
+	(void)distance;
+	return (true);
+}
+
+/**
+ * lightPoint - function adds up the light falling on a point of a wall face
+ * @lights: pointer to the lightmap
+ * @nearby: indices of the lights that may reach the point
+ * @count: number of nearby lights
+ * @x: point on the x axis, just off the face
+ * @y: point on the y axis
+ * @face: face the point is on, for its normal
+ *
+ * Return: the light as 0x00RRGGBB, each channel clamped to 255
+ */
+static Uint32 lightPoint(const Lightmap *lights, const int *nearby, int count,
+		float x, float y, int face)
+{
+	float channels[3] = {LIGHT_AMBIENT >> 16 & 0xFF, LIGHT_AMBIENT >> 8 & 0xFF,
+		LIGHT_AMBIENT & 0xFF};
+	Uint32 result = 0;
+
+	for (int i = 0; i < count; i++)
+	{
+		const Light *light = &lights->lights[nearby[i]];
+		float dx = light->x - x, dy = light->y - y;
+		float distance = sqrtf(dx * dx + dy * dy), facing, falloff;
+
+		if (distance >= light->radius || distance == 0)
+			continue;
+		facing = (dx * faceNormals[face][0] + dy * faceNormals[face][1]) / distance;
+		if (facing <= 0)
+			continue;
+		/*In shadow when a wall stands between the light and the point*/
+		if (walkRay(light->x, light->y, -dx, -dy, 1, visitAnyCell, NULL) < 0.999)
+			continue;
+		falloff = (1 - distance / light->radius) * facing;
+		for (int c = 0; c < 3; c++)
+			channels[c] += (light->color >> (16 - 8 * c) & 0xFF) * falloff;
+	}
+	for (int c = 0; c < 3; c++)
+		result |= (Uint32)SDL_min(channels[c] + 0.5f, 255) << (16 - 8 * c);
+	return (result);
+}
+
+/**
+ * bakeRegion - function lights every wall face of one block
+ * @lights: pointer to the lightmap
+ * @region: index of the block
+ * @nearby: scratch array with room for every light
+ *
+ * Faces that touch no open cell are never seen and keep the ambient light.
+ * A block no light reaches is freed and reads the ambient light.
+ *
+ * Return: void
+ */
+static void bakeRegion(Lightmap *lights, int region, int *nearby)
+{
+	const int left = (region % lights->regionsX) << LIGHT_REGION_SHIFT;
+	const int top = (region / lights->regionsX) << LIGHT_REGION_SHIFT;
+	Uint32 *block = lights->regions[region];
+	int count = 0;
+
+	for (int i = 0; i < lights->lightCount; i++)
+	{
+		const Light *light = &lights->lights[i];
+
+		if (light->x + light->radius >= left && light->x - light->radius < left + LIGHT_REGION &&
+				light->y + light->radius >= top && light->y - light->radius < top + LIGHT_REGION)
+			nearby[count++] = i;
+	}
+	if (count == 0)
+	{
+		free(block);
+		lights->regions[region] = NULL;
+		return;
+	}
+	if (!block)
+		block = malloc(sizeof(Uint32) * LIGHT_REGION * LIGHT_REGION * 4 * LIGHT_FACE_SAMPLES);
+	if (!block)
+	{
+		fprintf(stderr, "Failed to allocate a lightmap block\n");
+		return;
+	}
+	lights->regions[region] = block;
+	for (int cy = 0; cy < LIGHT_REGION; cy++)
+	{
+		for (int cx = 0; cx < LIGHT_REGION; cx++)
+		{
+			int mapX = left + cx, mapY = top + cy;
+			Uint32 *faces = block + ((cy << LIGHT_REGION_SHIFT) | cx) * 4 * LIGHT_FACE_SAMPLES;
+			bool wall = mapX < worldMap.width && mapY < worldMap.height &&
+				getMapCell(&worldMap, mapX, mapY) != 0;
+
+			for (int face = 0; face < 4; face++)
+			{
+				int nx = faceNormals[face][0], ny = faceNormals[face][1];
+				bool seen = wall && mapX + nx >= 0 && mapX + nx < worldMap.width &&
+					mapY + ny >= 0 && mapY + ny < worldMap.height &&
+					getMapCell(&worldMap, mapX + nx, mapY + ny) == 0;
+
+				for (int s = 0; s < LIGHT_FACE_SAMPLES; s++)
+				{
+					float along = (s + 0.5f) / LIGHT_FACE_SAMPLES;
+					/*On the face, then a hair into the open cell*/
+					float x = nx ? mapX + (nx > 0) + nx * 0.01f : mapX + along;
+					float y = ny ? mapY + (ny > 0) + ny * 0.01f : mapY + along;
+
+					faces[face * LIGHT_FACE_SAMPLES + s] = seen ?
+						lightPoint(lights, nearby, count, x, y, face) : LIGHT_AMBIENT;
+				}
+			}
+		}
+	}
+}
+
+/**
+ * followMapChanges - function marks what the cells changed since the last bake relight
+ * @lights: pointer to the lightmap
+ *
+ * Changes no longer in the map's log, or a map loaded again at the same
+ * size, relight everything any light reaches.
+ *
+ * Return: void
+ */
+static void followMapChanges(Lightmap *lights)
+{
+	int x, y;
+
+	for (; lights->mapVersion != worldMap.version; lights->mapVersion++)
+	{
+		if (!getMapChange(&worldMap, lights->mapVersion + 1, &x, &y))
+		{
+			for (int i = 0; i < lights->lightCount; i++)
+				markLightArea(lights, lights->lights[i].x, lights->lights[i].y,
+						lights->lights[i].radius);
+			lights->mapVersion = worldMap.version;
+			return;
+		}
+		updateLightCell(lights, x, y);
+	}
+}
+
+/**
+ * bakeLightmap - function rebakes the blocks marked since the last bake
+ * @lights: pointer to the lightmap
+ *
+ * Walls changed with setMapCell since the last bake mark their blocks
+ * first. Cheap to call every frame: it returns at once when nothing
+ * changed.
+ *
+ * Return: number of blocks rebaked
+ */
+int bakeLightmap(Lightmap *lights)
+{
+	int baked = 0, *nearby;
+
+	followMapChanges(lights);
+	if (lights->dirtyCount == 0)
+		return (0);
+	nearby = malloc(sizeof(int) * SDL_max(lights->lightCount, 1));
+	if (!nearby)
+		return (0);
+	for (int region = 0; region < lights->regionsX * lights->regionsY; region++)
+	{
+		if (!lights->dirty[region])
+			continue;
+		bakeRegion(lights, region, nearby);
+		lights->dirty[region] = false;
+		baked++;
+	}
+	lights->dirtyCount = 0;
+	free(nearby);
+	return (baked);
+}
+
+/**
+ * destroyLightmap - function frees the lightmap and its lights
+ * @lights: pointer to the lightmap
+ *
+ * Return: void
+ */
+void destroyLightmap(Lightmap *lights)
+{
+	if (lights->regions)
+		for (int i = 0; i < lights->regionsX * lights->regionsY; i++)
+			free(lights->regions[i]);
+	free(lights->regions);
+	free(lights->dirty);
+	free(lights->lights);
+	lights->regions = NULL;
+	lights->dirty = NULL;
+	lights->lights = NULL;
+	lights->lightCount = 0;
+	lights->lightCapacity = 0;
+	lights->enabled = false;
+}
@@ -2,7 +2,22 @@
 #include "../header/textures.h"
 #include "../header/input.h"
 #include "../header/rendering.h"
+#include "../header/floorcast.h"
 #include "../header/weapon.h"
+#include "../header/options.h"
+#include "../header/framebuffer.h"
+#include "../header/threadpool.h"
+#include "../header/timing.h"
+#include "../header/profiler.h"
+#include "../header/assets.h"
+#include "../header/minimap.h"
+#include "../header/particles.h"
+#include "../header/sprites.h"
+#include "../header/entity_grid.h"
+#include "../header/camera.h"
+#include "../header/resolution.h"
+#include "../header/input_log.h"
+#include "../header/lightmap.h"
 
 /**
  * main - main function in the code
@@ -15,12 +30,29 @@
 Mix_Chunk *shotgunSound = NULL;
 int main(int argc, char *argv[])
 {
-	(void)argc;
-	(void)argv;
-
+	GameOptions options;
+	Framebuffer framebuffer;
+	Minimap minimap;
+	RenderResolution resolution;
+	ParticleSystem *particles;
+	SpriteSet *sprites;
+	GameState game;
+	ThreadPool *renderPool;
+	TextureCache *textures;
+	AssetLoader *assets;
+	InputLog *inputLog = NULL;
+	Uint32 seed = (Uint32)SDL_GetPerformanceCounter();
+	int replayFrames = 0;
+	double replayMs = 0, worstFrameMs = 0;
+	char path[64];
+	int outputWidth, outputHeight;
 	bool showRain;
 	bool running;
 	bool showMiniMap;
+	bool spritesPending;
+
+	if (!parseOptions(argc, argv, &options))
+		return (EXIT_FAILURE);
 
 	/* Initialize SDL and create a window */
 	if (SDL_Init(SDL_INIT_VIDEO) < 0 || !(IMG_Init(IMG_INIT_PNG) & IMG_INIT_PNG))
@@ -38,8 +70,9 @@ int main(int argc, char *argv[])
 
     /* Initialize the SDL window*/
 	SDL_Window * window = SDL_CreateWindow("SDL Raycasting", SDL_WINDOWPOS_UNDEFINED,
-			SDL_WINDOWPOS_UNDEFINED, SCREEN_WIDTH,
-			SCREEN_HEIGHT, SDL_WINDOW_SHOWN);
+			SDL_WINDOWPOS_UNDEFINED, options.windowWidth, options.windowHeight,
+			SDL_WINDOW_SHOWN | SDL_WINDOW_RESIZABLE |
+			(options.fullscreen ? SDL_WINDOW_FULLSCREEN_DESKTOP : 0));
 
 	if (!window)
 	/*Raise error if window creation was unsuccesful*/
@@ -49,7 +82,8 @@ int main(int argc, char *argv[])
 	}
 
     /* Create a renderer for the window */
-	SDL_Renderer *renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED);
+	SDL_Renderer *renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED |
+			(options.pacing == PACING_VSYNC ? SDL_RENDERER_PRESENTVSYNC : 0));
 
 	if (!renderer)
 	/*Raise error if renderer creation was unsuccessful*/
@@ -58,36 +92,132 @@ int main(int argc, char *argv[])
 		return (1);
 	}
 
-	/*Load map and initialize player position and direction*/
-	loadMap("./resources/map.txt");
-	/* Initial player position*/
-	double posX = 22, posY = 12;
-	/* Initial player direction */
-	double dirX = -1, dirY = 0;
-	/* 2D raycaster version of camera plane */
-	double planeX = 0, planeY = 0.66;
-
-	/*Load textures for walls, sky, and weapon */
-	TextureData wallTextures[5];
-	wallTextures[0] = loadTextureWithDimensions("./resources/textures/1.png", renderer);
-	wallTextures[1] = loadTextureWithDimensions("./resources/textures/2.png", renderer);
-	wallTextures[2] = loadTextureWithDimensions("./resources/textures/3.png", renderer);
-	wallTextures[3] = loadTextureWithDimensions("./resources/textures/4.png", renderer);
-	wallTextures[4] = loadTextureWithDimensions("./resources/textures/5.png", renderer);
-	TextureData skyTexture = loadTextureWithDimensions("./resources/textures/sky.png", renderer);
+	/*Use the widest DDA kernel this CPU supports*/
+	options.rayKernel = selectRayKernel(options.rayKernel);
+	printf("Ray kernel: %s\n", getRayKernelName(options.rayKernel));
+	rayCache.enabled = options.rayCache;
+
+	/*Render below the output size when asked to, or when frames run over budget*/
+	SDL_GetRendererOutputSize(renderer, &outputWidth, &outputHeight);
+	initRenderResolution(&resolution, outputWidth, outputHeight,
+			options.renderScale, options.frameBudgetMs);
+	/*CPU-side frame for the software render path, big enough for full resolution*/
+	if (!createFramebuffer(&framebuffer, renderer, outputWidth, outputHeight) ||
+			!resizeFramebuffer(&framebuffer, renderer, resolution.width, resolution.height))
+		return (1);
+	/*Workers that share the software render columns*/
+	renderPool = createThreadPool(options.threadCount);
+
+	if (!renderPool)
+		return (1);
+	options.threadCount = renderPool->threadCount;
+
+	/*Every texture is shared through the cache, within the memory budget*/
+	textures = createTextureCache(renderer, (size_t)options.textureBudgetMB << 20);
+	if (!textures)
+		return (1);
+	/*Decode textures and audio on worker threads while the map loads*/
+	assets = createAssetLoader(ASSET_MANIFEST, textures, true);
+	if (!assets)
+		return (1);
+
+	/*Load map*/
+	PROFILE_BEGIN(ZONE_MAP_LOAD);
+	loadMap(options.mapPath);
+	PROFILE_END(ZONE_MAP_LOAD);
+	/*A replay takes the map, seed and sprites of the session it was recorded in*/
+	if (options.replayPath)
+	{
+		inputLog = loadInputLog(options.replayPath);
+		if (!inputLog)
+			return (1);
+		if (inputLog->mapChecksum != getMapChecksum(&worldMap))
+		{
+			fprintf(stderr, "%s was recorded on another map than %s\n",
+					options.replayPath, options.mapPath);
+			return (1);
+		}
+		seed = inputLog->seed;
+		options.extraSprites = inputLog->extraSprites;
+	}
+	else if (options.recordPath)
+	{
+		inputLog = createInputLog(seed, options.extraSprites, getMapChecksum(&worldMap));
+		if (!inputLog)
+			return (1);
+	}
+	/*Directions and 2D raycaster version of camera plane for every angle and column*/
+	if (!initCameraTables(resolution.width, resolution.height))
+		return (1);
+	/*Decorations and NPCs placed for resources/map.txt, plus any extra ones asked for*/
+	sprites = createSpriteSet();
+	if (!sprites)
+		return (1);
+	loadSprites(sprites, SPRITE_PLACEMENTS);
+	scatterSprites(sprites, options.extraSprites, seed);
+	/*Player at the start, weapon ready, and NPCs indexed by map cell for hit-scan*/
+	if (!initGameState(&game, sprites))
+		return (1);
+	/*The lamps' light baked onto the walls once, then only where something changes*/
+	if (!initLightmap(&lightmap, worldMap.width, worldMap.height) ||
+			!addSpriteLights(&lightmap, sprites))
+		return (1);
+	bakeLightmap(&lightmap);
+	lightmap.enabled = options.lighting;
+	/*Minimap cached in a texture, with fog over what has not been seen yet*/
+	if (!createMinimap(&minimap, renderer))
+		return (1);
+	/*Player state at the previous tick and blended for the current frame*/
+	Player previousPlayer = game.player, view;
+
+	/*Wait for the assets needed by the first frame; the rest keep loading*/
+	PROFILE_BEGIN(ZONE_TEXTURE_LOAD);
+	if (!waitForAssets(assets, true))
+	{
+		fprintf(stderr, "Failed to load the assets listed in %s\n", ASSET_MANIFEST);
+		return (EXIT_FAILURE);
+	}
+	PROFILE_END(ZONE_TEXTURE_LOAD);
+	/*Textures for walls, sky, and weapon, held until the game exits*/
+	TextureData wallTextures[WALL_TEXTURE_COUNT];
+	for (int i = 0; i < WALL_TEXTURE_COUNT; i++)
+	{
+		snprintf(path, sizeof(path), "./resources/textures/%d.png", i + 1);
+		wallTextures[i] = acquireTexture(textures, path);
+	}
+	/*Transposed copy of the wall textures and their mip levels for the software renderer*/
+	WallAtlas wallAtlas;
+	if (!createWallAtlas(&wallAtlas, wallTextures))
+		return (1);
+	/*The same levels as textures for the SDL renderer*/
+	WallMipmaps wallMipmaps;
+	if (!createWallMipmaps(&wallMipmaps, &wallAtlas, wallTextures, renderer))
+		return (1);
+	/*Row-major mip chains of the floor and ceiling for the software renderer*/
+	FloorTextures floorTextures;
+	if (!createFloorTextures(&floorTextures, &wallAtlas))
+		return (1);
+	TextureData skyTexture = acquireTexture(textures, "./resources/textures/sky.png");
 	TextureData weaponTextures[4];
-	weaponTextures[0] = loadTextureWithDimensions("./resources/sprites/weapon/shotgun/0.png", renderer);
-	weaponTextures[1] = loadTextureWithDimensions("./resources/sprites/weapon/shotgun/1.png", renderer);
-	weaponTextures[2] = loadTextureWithDimensions("./resources/sprites/weapon/shotgun/4.png", renderer);
-	weaponTextures[3] = loadTextureWithDimensions("./resources/sprites/weapon/shotgun/5.png", renderer);
+	weaponTextures[0] = acquireTexture(textures, "./resources/sprites/weapon/shotgun/0.png");
+	weaponTextures[1] = acquireTexture(textures, "./resources/sprites/weapon/shotgun/1.png");
+	weaponTextures[2] = acquireTexture(textures, "./resources/sprites/weapon/shotgun/4.png");
+	weaponTextures[3] = acquireTexture(textures, "./resources/sprites/weapon/shotgun/5.png");
+#ifndef NDEBUG
+	if (!loadProfilerOverlay(textures))
+		fprintf(stderr, "Profiler overlay digits could not be loaded\n");
+#endif
 
-	/* Initialize raindrops */
-	initializeRaindrops();
+	/*Rain, splashes and muzzle smoke; drops land and make splashes, so leave room for both*/
+	particles = createParticleSystem(options.rainDrops * 2 + MUZZLE_SMOKE_PUFFS * 8, seed);
+	if (!particles)
+		return (1);
+	setParticleArea(particles, outputWidth, outputHeight);
 
-	/* Load audio files */
-	Mix_Music *themeMusic = Mix_LoadMUS("./resources/sound/theme.mp3");
+	/* Audio decoded alongside the textures */
+	Mix_Music *themeMusic = getMusicAsset(assets, "./resources/sound/theme.mp3");
 
-	shotgunSound = Mix_LoadWAV("./resources/sound/shotgun.wav");
+	shotgunSound = getSoundAsset(assets, "./resources/sound/shotgun.wav");
 
 	if (!themeMusic)
 	/*raise an error if music was not loaded*/
@@ -108,84 +238,233 @@ int main(int argc, char *argv[])
 	showRain = false;
 	running = true;
 	showMiniMap = true;
-	/*Weapon default state*/
-	WeaponState weaponState = WEAPON_AIM;
-	/*Store the time when the weapon was last fired*/
-	Uint32 lastFireTime = 0;
-	/*Time in (ms) between firing and recoil*/
-	Uint32 fireCooldown = 300;
+	/*Sprite frames are deferred assets; the atlas is built once they are all in*/
+	spritesPending = true;
+	bool fireRequested = false;
+	/*Fixed simulation step and the time still waiting to be simulated*/
+	const double tickSeconds = 1.0 / TICK_RATE;
+	double accumulator = 0;
+	Uint64 tick = 0;
+	Uint64 previousTime = SDL_GetPerformanceCounter();
 
 	while (running)
 	{
+		Uint64 frameStart = SDL_GetPerformanceCounter();
 		SDL_Event event;
+
+		/*Never try to catch up on more than a quarter second, e.g. after a stall*/
+		double elapsed = SDL_min(getSecondsBetween(previousTime, frameStart), 0.25);
+
+		accumulator += elapsed;
+		previousTime = frameStart;
+
 		while (SDL_PollEvent(&event))
 		{
-			handlePlayerInput(&event, &running, &showMiniMap, &showRain,
-					 &posX, &posY, &dirX, &dirY, &planeX, &planeY);
-			/*Handle weapon firing */
+			handlePlayerInput(&event, &running, &showMiniMap, &showRain, &options);
+			/*Render targets lose their contents when the device resets*/
+			if (event.type == SDL_RENDER_TARGETS_RESET)
+				invalidateMinimap(&minimap);
+			/*Follow the window; the render resolution keeps its scale of the output*/
+			if (event.type == SDL_WINDOWEVENT &&
+					event.window.event == SDL_WINDOWEVENT_SIZE_CHANGED)
+			{
+				SDL_GetRendererOutputSize(renderer, &outputWidth, &outputHeight);
+				setOutputSize(&resolution, outputWidth, outputHeight);
+				setParticleArea(particles, outputWidth, outputHeight);
+			}
+			/*Handle weapon firing on the next simulation tick*/
 			if (event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_SPACE)
+				fireRequested = true;
+		}
+
+		/*Advance the simulation in fixed steps, however long the frame took*/
+		while (accumulator >= tickSeconds)
+		{
+			Uint8 input;
+
+			/*Ticks come from the keyboard, or from the log until it runs out*/
+			if (options.replayPath)
 			{
-				if (weaponState == WEAPON_AIM)
+				if (tick >= (Uint64)inputLog->tickCount)
 				{
-					weaponState = WEAPON_FIRE;
-					/*Play gunshot sound*/
-					Mix_PlayChannel(-1, shotgunSound, 0);
-					/*Update last fired time to current time*/
-					lastFireTime = SDL_GetTicks();
+					running = false;
+					break;
 				}
+				input = inputLog->ticks[tick];
+			}
+			else
+			{
+				input = readTickInput(fireRequested);
+				if (inputLog && !recordTick(inputLog, input))
+					return (1);
 			}
+			previousPlayer = game.player;
+			if (runTick(&game, input, tick++))
+			{
+				float muzzleX, muzzleY;
+
+				getMuzzlePosition(renderer, &muzzleX, &muzzleY);
+				emitMuzzleSmoke(particles, muzzleX, muzzleY, MUZZLE_SMOKE_PUFFS);
+			}
+			fireRequested = false;
+			accumulator -= tickSeconds;
 		}
+		/*Render between the last two ticks so motion stays smooth at any frame rate*/
+		interpolatePlayer(&previousPlayer, &game.player, accumulator / tickSeconds, &view);
 
-		/*Update weapon state*/
-		updateWeaponState(&weaponState, &lastFireTime, fireCooldown);
+		/*Columns and framebuffer follow the resolution chosen last frame*/
+		if (resolution.width != cameraTables.width || resolution.height != cameraTables.height)
+		{
+			if (!initCameraTables(resolution.width, resolution.height) ||
+					!resizeFramebuffer(&framebuffer, renderer,
+						resolution.width, resolution.height))
+				return (1);
+		}
+		fitViewToAspect(&view, resolution.width, resolution.height);
+
+		/*Restart the render workers if the thread count was changed*/
+		if (options.threadCount != renderPool->threadCount)
+		{
+			destroyThreadPool(renderPool);
+			renderPool = createThreadPool(options.threadCount);
+			if (!renderPool)
+				return (1);
+			options.threadCount = renderPool->threadCount;
+		}
+
+		/*Upload a few more deferred assets, so no single frame stalls on them*/
+		if (pumpAssetUploads(assets, ASSET_UPLOADS_PER_FRAME) == 0 && spritesPending)
+		{
+			spritesPending = false;
+			if (!createSpriteAtlas(sprites, textures))
+				fprintf(stderr, "Sprites will not be drawn\n");
+		}
 
 		/*Clear screen and render scene*/
+		Uint64 renderStart = SDL_GetPerformanceCounter();
+
+		/*Rebake the blocks of any wall or light changed since the last frame*/
+		bakeLightmap(&lightmap);
+
+		PROFILE_BEGIN(ZONE_RAYCASTING);
 		SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
 		SDL_RenderClear(renderer);
-		performRaycasting(renderer, wallTextures, &skyTexture, posX, posY, dirX,
-				dirY, planeX, planeY);
+		/*The SDL path draws at the render resolution, scaled up to the output*/
+		if (options.renderMode == RENDER_SDL)
+			SDL_RenderSetScale(renderer, (float)outputWidth / resolution.width,
+					(float)outputHeight / resolution.height);
+		if (options.renderMode == RENDER_SOFTWARE)
+			performRaycastingSoftware(&framebuffer, renderPool, &wallAtlas,
+					options.showSky ? &skyTexture : NULL,
+					view.posX, view.posY, view.dirX, view.dirY, view.planeX, view.planeY);
+		else
+			performRaycasting(renderer, &wallMipmaps, &skyTexture, view.posX, view.posY,
+					view.dirX, view.dirY, view.planeX, view.planeY);
+		PROFILE_END(ZONE_RAYCASTING);
+
+		/*Floor, and ceiling unless the sky is shown, around the software renderer's walls*/
+		if (options.renderMode == RENDER_SOFTWARE)
+		{
+			PROFILE_BEGIN(ZONE_FLOOR);
+			performFloorCasting(&framebuffer, renderPool, &floorTextures, !options.showSky,
+					view.posX, view.posY, view.dirX, view.dirY, view.planeX, view.planeY);
+			PROFILE_END(ZONE_FLOOR);
+		}
+
+		/*Sprites over the walls, wherever they are nearer than the wall*/
+		PROFILE_BEGIN(ZONE_SPRITES);
+		prepareSprites(sprites, (double)tick / TICK_RATE, view.posX, view.posY,
+				view.dirX, view.dirY, view.planeX, view.planeY);
+		if (options.renderMode == RENDER_SOFTWARE)
+		{
+			drawSpritesSoftware(sprites, &framebuffer, renderPool);
+			presentFramebuffer(&framebuffer, renderer);
+		}
+		else
+		{
+			drawSprites(sprites, renderer);
+			SDL_RenderSetScale(renderer, 1, 1);
+		}
+		PROFILE_END(ZONE_SPRITES);
+		/*Lower the render resolution if the world took too long, raise it if there is room*/
+		updateRenderResolution(&resolution,
+				getSecondsBetween(renderStart, SDL_GetPerformanceCounter()) * 1000);
 
 		/*Render mini-map if enabled*/
+		PROFILE_BEGIN(ZONE_MINIMAP);
+		revealMinimapCells(&minimap, columnHits, view.posX, view.posY,
+				view.dirX, view.dirY, view.planeX, view.planeY);
 		if (showMiniMap)
-			drawMiniMap(renderer, posX, posY, dirX, dirY);
+			drawMiniMap(renderer, &minimap, options.minimapZoom,
+					view.posX, view.posY, view.dirX, view.dirY);
+		PROFILE_END(ZONE_MINIMAP);
 
 		/*Render weapon*/
-		renderWeapon(renderer, weaponTextures, weaponState);
+		PROFILE_BEGIN(ZONE_WEAPON);
+		renderWeapon(renderer, weaponTextures, game.weaponState);
+		PROFILE_END(ZONE_WEAPON);
 
-		/*Update weapon state*/
-		if (weaponState == WEAPON_FIRE)
-		{
-			/*Delay time to manage weapon cooldown time and recoil*/
-			SDL_Delay(100);
-			/*Return weapon to default aim state after firing*/
-			weaponState = WEAPON_AIM;
-		}
-		/* Draw rain if enabled*/
-		if (showRain)
-			drawRain(renderer);
+		/*Rain if enabled, splashes and smoke, moved by the real time that passed*/
+		PROFILE_BEGIN(ZONE_PARTICLES);
+		setRainDensity(particles, showRain ? options.rainDrops : 0);
+		updateParticles(particles, (float)elapsed);
+		drawParticles(particles, renderer);
+		PROFILE_END(ZONE_PARTICLES);
+#ifndef NDEBUG
+		if (options.showProfiler)
+			drawProfilerOverlay(renderer);
+#endif
 		/*Present everything on the screen*/
+		PROFILE_BEGIN(ZONE_PRESENT);
 		SDL_RenderPresent(renderer);
-		/*Manage frame rates(for 60fps)*/
-		SDL_Delay(16);
-	}
-
-	/* Clean up resources by freeing the heap */
-	Mix_FreeMusic(themeMusic);
-	Mix_FreeChunk(shotgunSound);
+		PROFILE_END(ZONE_PRESENT);
+		if (options.replayPath)
+		{
+			double frameMs = getSecondsBetween(frameStart, SDL_GetPerformanceCounter()) * 1000;
 
-	/*free wall textures recursively*/
-	for (int i = 0; i < 5; i++)
-		SDL_DestroyTexture(wallTextures[i].texture);
+			replayFrames++;
+			replayMs += frameMs;
+			worstFrameMs = SDL_max(worstFrameMs, frameMs);
+		}
+		/*Hold the frame rate at the cap; vsync already waits inside the present*/
+		if (options.pacing == PACING_CAP)
+			waitUntil(frameStart + SDL_GetPerformanceFrequency() / options.fpsCap);
+		PROFILE_END_FRAME();
+	}
 
-	/*free the weapon textures recursively*/
-	for (int i = 0; i < 4; i++)
+#ifndef NDEBUG
+	writeProfileTrace(options.tracePath);
+#endif
+	if (options.replayPath && replayFrames > 0)
+		printf("Replayed %d ticks in %d frames: %.3f ms mean, %.3f ms worst\n",
+				inputLog->tickCount, replayFrames, replayMs / replayFrames, worstFrameMs);
+	else if (options.recordPath)
 	{
-		SDL_DestroyTexture(weaponTextures[i].texture);
+		if (saveInputLog(inputLog, options.recordPath))
+			printf("Recorded %d ticks to %s\n", inputLog->tickCount, options.recordPath);
 	}
-	SDL_DestroyTexture(skyTexture.texture);
+	destroyInputLog(inputLog);
+
+	/* Clean up resources by freeing the heap */
+	destroyWallMipmaps(&wallMipmaps);
+	destroyWallAtlas(&wallAtlas);
+	destroyFloorTextures(&floorTextures);
+	destroyCameraTables();
+	printTextureCacheStats(textures, stdout);
+	/*Music and sounds belong to the asset loader, textures to the cache*/
+	destroyAssetLoader(assets);
+	destroyTextureCache(textures);
+	destroyMinimap(&minimap);
+	destroyParticleSystem(particles);
+	destroyLightmap(&lightmap);
+	destroySpriteSet(sprites);
+	destroyEntityGrid(game.npcs);
+	destroyFramebuffer(&framebuffer);
+	destroyThreadPool(renderPool);
 	SDL_DestroyRenderer(renderer);
 	SDL_DestroyWindow(window);
 	IMG_Quit();
+	freeMap(&worldMap);
 	SDL_Quit();
 	return (0);
 }
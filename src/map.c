@@ -1,35 +1,660 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <SDL2/SDL_endian.h>
 #include "../header/map.h"
 #include "../header/constants.h"
 
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#define MAP_USE_MMAP
+#endif
+
+Map worldMap;
+
+/**
+ * allocateMapOccupancy - function allocates the occupancy pyramid of a map
+ * @map: pointer to a map whose width and height are set
+ *
+ * Return: true on success, false if the counts could not be allocated
+ */
+static bool allocateMapOccupancy(Map *map)
+{
+	map->regionsX = (map->width + MAP_REGION - 1) >> MAP_REGION_SHIFT;
+	map->regionsY = (map->height + MAP_REGION - 1) >> MAP_REGION_SHIFT;
+	map->sectorsX = (map->width + MAP_SECTOR - 1) >> MAP_SECTOR_SHIFT;
+	map->sectorsY = (map->height + MAP_SECTOR - 1) >> MAP_SECTOR_SHIFT;
+	map->regionWalls = calloc((size_t)map->regionsX * map->regionsY,
+			sizeof(*map->regionWalls));
+	map->sectorWalls = calloc((size_t)map->sectorsX * map->sectorsY,
+			sizeof(*map->sectorWalls));
+	return (map->regionWalls != NULL && map->sectorWalls != NULL);
+}
+
+/**
+ * createMap - function allocates an empty map of the given size
+ * @map: pointer to the map to initialize
+ * @width: number of cells along x
+ * @height: number of cells along y
+ *
+ * Return: true on success, false if the cells could not be allocated
+ */
+bool createMap(Map *map, int width, int height)
+{
+	map->width = width;
+	map->height = height;
+	map->tilesX = (width + MAP_TILE - 1) >> MAP_TILE_SHIFT;
+	map->tilesY = (height + MAP_TILE - 1) >> MAP_TILE_SHIFT;
+	map->mapping = NULL;
+	map->mappingSize = 0;
+	map->cells = calloc((size_t)map->tilesX * map->tilesY * MAP_TILE * MAP_TILE
+			+ MAP_PADDING, 1);
+	return (map->cells != NULL && allocateMapOccupancy(map));
+}
+
+/**
+ * freeMap - function releases the cells of a map
+ * @map: pointer to the map
+ *
+ * Return: void
+ */
+void freeMap(Map *map)
+{
+#ifdef MAP_USE_MMAP
+	if (map->mapping)
+		munmap(map->mapping, map->mappingSize);
+	else
+#endif
+		free(map->cells);
+	free(map->regionWalls);
+	free(map->sectorWalls);
+	map->cells = NULL;
+	map->mapping = NULL;
+	map->regionWalls = NULL;
+	map->sectorWalls = NULL;
+	map->width = map->height = 0;
+}
+
+/**
+ * readFile - function reads a whole file into a NUL-terminated buffer
+ * @filename: path of the file
+ *
+ * Return: pointer to the buffer, or NULL on failure
+ */
+static char *readFile(const char *filename)
+{
+	FILE *file = fopen(filename, "rb");
+	char *text;
+	long size;
+
+	if (!file)
+		return (NULL);
+	fseek(file, 0, SEEK_END);
+	size = ftell(file);
+	fseek(file, 0, SEEK_SET);
+	text = malloc(size + 1);
+	if (text && fread(text, 1, size, file) != (size_t)size)
+	{
+		free(text);
+		text = NULL;
+	}
+	if (text)
+		text[size] = '\0';
+	fclose(file);
+	return (text);
+}
+
+/**
+ * measureMap - function finds the size of a text map
+ * @text: contents of the map file
+ * @width: receives the number of values on the first row
+ * @height: receives the number of non-empty rows
+ *
+ * Return: true if every row has the same number of values, false otherwise
+ */
+static bool measureMap(const char *text, int *width, int *height)
+{
+	int count = 0;
+	bool inNumber = false;
+
+	*width = 0;
+	*height = 0;
+	for (const char *c = text;; c++)
+	{
+		if (isdigit((unsigned char)*c))
+		{
+			if (!inNumber)
+				count++;
+			inNumber = true;
+			continue;
+		}
+		inNumber = false;
+		if (*c != '\n' && *c != '\0')
+			continue;
+		if (count > 0)
+		{
+			if (*height == 0)
+				*width = count;
+			else if (count != *width)
+				return (false);
+			(*height)++;
+		}
+		count = 0;
+		if (*c == '\0')
+			break;
+	}
+	return (*width > 0);
+}
+
+/**
+ * hashMapCells - function computes the checksum stored in binary maps
+ * @cells: tiled cells
+ * @size: number of bytes, a multiple of 8
+ *
+ * FNV-1a taken over 64-bit words rather than bytes, so checking a large
+ * map costs about as much as reading it. The words are read
+ * little-endian, so a map has the same checksum on every host.
+ *
+ * Return: 64-bit hash of the cells
+ */
+uint64_t hashMapCells(const uint8_t *cells, size_t size)
+{
+	uint64_t hash = 0xCBF29CE484222325ULL, word;
+
+	for (size_t i = 0; i < size; i += sizeof(word))
+	{
+		memcpy(&word, cells + i, sizeof(word));
+		hash = (hash ^ SDL_SwapLE64(word)) * 0x100000001B3ULL;
+	}
+	return (hash);
+}
+
+/**
+ * cellsInRange - function checks that no cell names a missing texture
+ * @cells: tiled cells
+ * @size: number of bytes, a multiple of 8
+ *
+ * Eight cells are tested at once: adding 0x7F - WALL_TEXTURE_COUNT to a
+ * byte sets its top bit exactly when the byte is above WALL_TEXTURE_COUNT
+ * (bytes with the top bit already set are caught by the OR).
+ *
+ * Return: true if every cell is between 0 and WALL_TEXTURE_COUNT
+ */
+static bool cellsInRange(const uint8_t *cells, size_t size)
+{
+	const uint64_t bias = (0x7F - WALL_TEXTURE_COUNT) * 0x0101010101010101ULL;
+	uint64_t word, over = 0;
+
+	for (size_t i = 0; i < size; i += sizeof(word))
+	{
+		memcpy(&word, cells + i, sizeof(word));
+		over |= word | (word + bias);
+	}
+	return ((over & 0x8080808080808080ULL) == 0);
+}
+
+/**
+ * findOpenBorder - function looks for an empty cell on the map border
+ * @map: pointer to the map
+ * @x: receives the column of the first open cell
+ * @y: receives the row of the first open cell
+ *
+ * Return: true if the border has a hole, false if it is all walls
+ */
+static bool findOpenBorder(const Map *map, int *x, int *y)
+{
+	int right = map->width - 1, bottom = map->height - 1;
+
+	for (*y = 0; *y <= bottom; (*y)++)
+	{
+		for (*x = 0; *x <= right; (*x)++)
+		{
+			if (getMapCell(map, *x, *y) == 0)
+				return (true);
+			/*Inside rows only need their first and last cell checked*/
+			if (*y != 0 && *y != bottom && *x == 0 && right > 0)
+				*x = right - 1;
+		}
+	}
+	return (false);
+}
+
+/**
+ * loadTextMap - function parses a map.txt style file
+ * @filename: path of the map file
+ * @map: pointer to the map to fill in
+ *
+ * The map size is taken from the file: one row of whitespace-separated
+ * wall types per line. Anything else, such as a sign, other characters
+ * or a type past WALL_TEXTURE_COUNT, is reported with its cell and
+ * stops the load.
+ *
+ * Return: void
+ */
+static void loadTextMap(const char *filename, Map *map)
+{
+	char *text = readFile(filename);
+	char *c, *start;
+	int width, height, value;
+
+	if (!text)
+	{
+		fprintf(stderr, "Failed to open map file: %s\n", filename);
+		exit(EXIT_FAILURE);
+	}
+	if (!measureMap(text, &width, &height))
+	{
+		fprintf(stderr, "Map rows in %s do not all have the same length\n", filename);
+		exit(EXIT_FAILURE);
+	}
+	if (width > MAP_MAX_SIZE || height > MAP_MAX_SIZE)
+	{
+		fprintf(stderr, "Map %s is %dx%d, larger than %dx%d\n", filename,
+				width, height, MAP_MAX_SIZE, MAP_MAX_SIZE);
+		exit(EXIT_FAILURE);
+	}
+	if (!createMap(map, width, height))
+	{
+		fprintf(stderr, "Failed to allocate %dx%d map\n", width, height);
+		exit(EXIT_FAILURE);
+	}
+
+	c = text;
+	for (int y = 0; y < height; y++)
+	{
+		for (int x = 0; x < width; x++)
+		{
+			while (isspace((unsigned char)*c))
+				c++;
+			start = c;
+			/*Stop accumulating once out of range, so long digit runs cannot overflow*/
+			for (value = 0; isdigit((unsigned char)*c); c++)
+				if (value <= WALL_TEXTURE_COUNT)
+					value = value * 10 + (*c - '0');
+			/*Only unsigned wall types separated by whitespace*/
+			if (c == start || value > WALL_TEXTURE_COUNT ||
+					(*c != '\0' && !isspace((unsigned char)*c)))
+			{
+				fprintf(stderr, "Error reading map data at %d, %d: expected a wall type"
+						" from 0 to %d\n", x, y, WALL_TEXTURE_COUNT);
+				exit(EXIT_FAILURE);
+			}
+			map->cells[getMapCellIndex(map, x, y)] = value;
+		}
+	}
+	while (isspace((unsigned char)*c))
+		c++;
+	if (*c != '\0')
+	{
+		fprintf(stderr, "Unexpected text after the last row of %s\n", filename);
+		exit(EXIT_FAILURE);
+	}
+	free(text);
+}
+
+/**
+ * swapMapHeader - function converts a binary map header to or from the file's byte order
+ * @header: pointer to the header, converted in place
+ *
+ * The file is little-endian, so this does nothing on little-endian hosts.
+ * Swapping twice gives the header back, so writing and reading share it.
+ *
+ * Return: void
+ */
+static void swapMapHeader(MapFileHeader *header)
+{
+	header->version = SDL_SwapLE16(header->version);
+	header->width = SDL_SwapLE32(header->width);
+	header->height = SDL_SwapLE32(header->height);
+	header->dataOffset = SDL_SwapLE32(header->dataOffset);
+	header->flags = SDL_SwapLE32(header->flags);
+	header->dataSize = SDL_SwapLE64(header->dataSize);
+	header->checksum = SDL_SwapLE64(header->checksum);
+}
+
+/**
+ * loadBinaryMap - function maps a binary map file into memory
+ * @filename: path of the map file
+ * @map: pointer to the map to fill in
+ *
+ * The payload is mapped copy-on-write and used in place; where mmap is
+ * not available it is read into a heap buffer in one call. Either way
+ * the header, checksum and cell values are checked before use.
+ *
+ * Return: void
+ */
+static void loadBinaryMap(const char *filename, Map *map)
+{
+	FILE *file = fopen(filename, "rb");
+	MapFileHeader header;
+	size_t dataSize;
+	long fileSize;
+
+	if (!file || fread(&header, sizeof(header), 1, file) != 1 ||
+			fseek(file, 0, SEEK_END) != 0 || (fileSize = ftell(file)) < 0)
+	{
+		fprintf(stderr, "Failed to read map file: %s\n", filename);
+		exit(EXIT_FAILURE);
+	}
+	swapMapHeader(&header);
+	map->width = header.width;
+	map->height = header.height;
+	map->tilesX = (header.width + MAP_TILE - 1) >> MAP_TILE_SHIFT;
+	map->tilesY = (header.height + MAP_TILE - 1) >> MAP_TILE_SHIFT;
+	dataSize = (size_t)map->tilesX * map->tilesY * MAP_TILE * MAP_TILE;
+	if (header.version != MAP_FILE_VERSION || header.cellType != MAP_CELL_UINT8 ||
+			header.tileShift != MAP_TILE_SHIFT || header.width == 0 ||
+			header.height == 0 || header.width > MAP_MAX_SIZE || header.height > MAP_MAX_SIZE ||
+			header.dataOffset < sizeof(header) || header.dataSize != dataSize ||
+			(size_t)fileSize < header.dataOffset + dataSize + MAP_PADDING)
+	{
+		fprintf(stderr, "Unsupported or truncated binary map: %s\n", filename);
+		exit(EXIT_FAILURE);
+	}
+
+	map->mapping = NULL;
+	map->mappingSize = 0;
+#ifdef MAP_USE_MMAP
+	map->mapping = mmap(NULL, fileSize, PROT_READ | PROT_WRITE, MAP_PRIVATE,
+			fileno(file), 0);
+	if (map->mapping == MAP_FAILED)
+		map->mapping = NULL;
+	if (map->mapping)
+	{
+		map->mappingSize = fileSize;
+		map->cells = (uint8_t *)map->mapping + header.dataOffset;
+	}
+	else
+#endif
+	{
+		map->cells = calloc(dataSize + MAP_PADDING, 1);
+		if (!map->cells || fseek(file, header.dataOffset, SEEK_SET) != 0 ||
+				fread(map->cells, 1, dataSize, file) != dataSize)
+		{
+			fprintf(stderr, "Failed to read map file: %s\n", filename);
+			exit(EXIT_FAILURE);
+		}
+	}
+	fclose(file);
+	if (!allocateMapOccupancy(map))
+	{
+		fprintf(stderr, "Failed to allocate %dx%d map\n", map->width, map->height);
+		exit(EXIT_FAILURE);
+	}
+
+	if (hashMapCells(map->cells, dataSize) != header.checksum)
+	{
+		fprintf(stderr, "Map file %s is corrupt: checksum mismatch\n", filename);
+		exit(EXIT_FAILURE);
+	}
+	if (!cellsInRange(map->cells, dataSize))
+	{
+		fprintf(stderr, "Map file %s has wall types above %d\n", filename,
+				WALL_TEXTURE_COUNT);
+		exit(EXIT_FAILURE);
+	}
+}
+
 /**
  * loadMap- funtion to loap map from a file
  * @filename: pointer containing path to the map file
- * 
+ *
+ * Both map.txt style text maps and binary maps written by mapconvert
+ * are accepted; the format is recognised from the first bytes. The level
+ * must be enclosed by walls so that rays and movement never leave it.
+ *
  * return: null
  */
-int worldMap[MAP_WIDTH][MAP_HEIGHT];
 void loadMap(const char *filename)
 {
-	FILE *file = fopen(filename, "r");
+	FILE *file = fopen(filename, "rb");
+	char magic[4] = {0};
+	uint32_t version = worldMap.version + 1;
+	int x, y;
 
 	if (!file)
 	{
 		fprintf(stderr, "Failed to open map file: %s\n", filename);
 		exit(EXIT_FAILURE);
 	}
-	for (int y = 0; y < MAP_HEIGHT; y++)
+	if (fread(magic, 1, sizeof(magic), file) != sizeof(magic))
+		magic[0] = '\0';
+	fclose(file);
+
+	freeMap(&worldMap);
+	if (memcmp(magic, MAP_FILE_MAGIC, sizeof(magic)) == 0)
+		loadBinaryMap(filename, &worldMap);
+	else
+		loadTextMap(filename, &worldMap);
+	buildMapOccupancy(&worldMap);
+	worldMap.version = version;
+	worldMap.logStart = version;
+
+	/*Rays and movement rely on a closed border*/
+	if (findOpenBorder(&worldMap, &x, &y))
 	{
-		for (int x = 0; x < MAP_WIDTH; x++)
+		fprintf(stderr, "Map border is open at %d, %d\n", x, y);
+		exit(EXIT_FAILURE);
+	}
+}
+
+/**
+ * markRegion - function sets or clears MAP_CELL_OPEN on a region without walls
+ * @map: pointer to the map
+ * @regionX: region column
+ * @regionY: region row
+ * @open: true to mark the cells, false to clear them
+ *
+ * Return: void
+ */
+static void markRegion(Map *map, int regionX, int regionY, bool open)
+{
+	const int tilesPerRegion = MAP_REGION / MAP_TILE;
+	int lastX = regionX * tilesPerRegion + tilesPerRegion;
+	int lastY = regionY * tilesPerRegion + tilesPerRegion;
+
+	if (lastX > map->tilesX)
+		lastX = map->tilesX;
+	if (lastY > map->tilesY)
+		lastY = map->tilesY;
+	/*Every cell of the region is empty, so whole tiles can be rewritten*/
+	for (int ty = regionY * tilesPerRegion; ty < lastY; ty++)
+	{
+		int first = ty * map->tilesX + regionX * tilesPerRegion;
+
+		memset(map->cells + ((size_t)first << (2 * MAP_TILE_SHIFT)),
+				open ? MAP_CELL_OPEN : 0,
+				(size_t)(lastX - regionX * tilesPerRegion) << (2 * MAP_TILE_SHIFT));
+	}
+}
+
+/**
+ * buildMapOccupancy - function counts the walls of every region and sector
+ * @map: pointer to a map whose cells are loaded
+ *
+ * Also marks the cells of every region without walls as MAP_CELL_OPEN.
+ *
+ * Return: void
+ */
+void buildMapOccupancy(Map *map)
+{
+	const int regionTiles = MAP_REGION_SHIFT - MAP_TILE_SHIFT;
+	const int sectorRegions = MAP_SECTOR_SHIFT - MAP_REGION_SHIFT;
+	const uint8_t *tile = map->cells;
+
+	memset(map->regionWalls, 0, (size_t)map->regionsX * map->regionsY *
+			sizeof(*map->regionWalls));
+	memset(map->sectorWalls, 0, (size_t)map->sectorsX * map->sectorsY *
+			sizeof(*map->sectorWalls));
+	for (int ty = 0; ty < map->tilesY; ty++)
+	{
+		for (int tx = 0; tx < map->tilesX; tx++, tile += MAP_TILE * MAP_TILE)
 		{
-			if (fscanf(file, "%d", &worldMap[x][y]) != 1)
+			int walls = 0;
+			uint64_t word;
+
+			/*
+			 * Eight cells at a time: adding 0x7F sets the top bit of every
+			 * byte holding a wall, and the multiply adds those bits up.
+			 */
+			for (int i = 0; i < MAP_TILE * MAP_TILE; i += sizeof(word))
 			{
-				fprintf(stderr, "Error reading map data at %d, %d\n", x, y);
-				fclose(file);
-				exit(EXIT_FAILURE);
+				memcpy(&word, tile + i, sizeof(word));
+				word = ((word & 0x7F7F7F7F7F7F7F7FULL) + 0x7F7F7F7F7F7F7F7FULL)
+					& 0x8080808080808080ULL;
+				walls += ((word >> 7) * 0x0101010101010101ULL) >> 56;
 			}
+			map->regionWalls[(ty >> regionTiles) * map->regionsX + (tx >> regionTiles)]
+				+= walls;
 		}
 	}
-	fclose(file);
+	for (int ry = 0; ry < map->regionsY; ry++)
+	{
+		for (int rx = 0; rx < map->regionsX; rx++)
+		{
+			int walls = map->regionWalls[ry * map->regionsX + rx];
+
+			map->sectorWalls[(ry >> sectorRegions) * map->sectorsX
+				+ (rx >> sectorRegions)] += walls;
+			if (walls == 0)
+				markRegion(map, rx, ry, true);
+		}
+	}
+}
+
+/**
+ * setMapCell - function changes one cell, e.g. to open a door
+ * @map: pointer to the map
+ * @x: cell column
+ * @y: cell row
+ * @value: 0 for empty space, otherwise the wall type
+ *
+ * Keeps the occupancy pyramid in step: the counts change in constant
+ * time, and a region's open marks are rewritten only when it gains its
+ * first wall or loses its last one. The map's version moves on, so
+ * anything cached from the old cells is thrown away, and the cell is
+ * logged under the new version for getMapChange.
+ *
+ * Return: void
+ */
+void setMapCell(Map *map, int x, int y, int value)
+{
+	uint8_t *cell = &map->cells[getMapCellIndex(map, x, y)];
+	int change = (value != 0) - ((*cell & MAP_WALL_MASK) != 0);
+	int regionX = x >> MAP_REGION_SHIFT, regionY = y >> MAP_REGION_SHIFT;
+	uint16_t *regionWalls = &map->regionWalls[regionY * map->regionsX + regionX];
+
+	map->version++;
+	map->changedX[map->version % MAP_CHANGE_LOG] = (uint16_t)x;
+	map->changedY[map->version % MAP_CHANGE_LOG] = (uint16_t)y;
+	map->sectorWalls[(y >> MAP_SECTOR_SHIFT) * map->sectorsX + (x >> MAP_SECTOR_SHIFT)]
+		+= change;
+	*regionWalls += change;
+	if (change > 0 && *regionWalls == 1)
+		markRegion(map, regionX, regionY, false);
+	*cell = value;
+	if (change < 0 && *regionWalls == 0)
+		markRegion(map, regionX, regionY, true);
+	else if (value == 0 && *regionWalls == 0)
+		*cell = MAP_CELL_OPEN;
+}
+
+/**
+ * getMapChange - function finds the cell a change to the map was made in
+ * @map: pointer to the map
+ * @version: version the change brought the map to
+ * @x: receives the column of the changed cell
+ * @y: receives the row of the changed cell
+ *
+ * A cache made at some version catches up by asking for every version
+ * after it, up to map->version. When a change is no longer logged, or
+ * came from loading a map, the cache has to be rebuilt instead.
+ *
+ * Return: true if the change is logged, false otherwise
+ */
+bool getMapChange(const Map *map, uint32_t version, int *x, int *y)
+{
+	/*Unsigned differences, so versions may wrap around*/
+	if (version - map->logStart - 1 >= map->version - map->logStart ||
+			map->version - version >= MAP_CHANGE_LOG)
+		return (false);
+	*x = map->changedX[version % MAP_CHANGE_LOG];
+	*y = map->changedY[version % MAP_CHANGE_LOG];
+	return (true);
+}
+
+/**
+ * findEmptyCell - function finds a cell the player can stand in
+ * @map: pointer to the map
+ * @x: preferred column
+ * @y: preferred row
+ * @foundX: receives the column of the empty cell
+ * @foundY: receives the row of the empty cell
+ *
+ * The preferred cell is used when it is inside the map and empty,
+ * otherwise the first empty cell in row order.
+ *
+ * Return: true if an empty cell was found, false if the map has none
+ */
+bool findEmptyCell(const Map *map, int x, int y, int *foundX, int *foundY)
+{
+	if (x >= 0 && y >= 0 && x < map->width && y < map->height &&
+			getMapCell(map, x, y) == 0)
+	{
+		*foundX = x;
+		*foundY = y;
+		return (true);
+	}
+	for (*foundY = 0; *foundY < map->height; (*foundY)++)
+		for (*foundX = 0; *foundX < map->width; (*foundX)++)
+			if (getMapCell(map, *foundX, *foundY) == 0)
+				return (true);
+	return (false);
+}
+
+/**
+ * saveMapBinary - function writes a map in the binary map format
+ * @map: pointer to the map
+ * @filename: path of the file to write
+ *
+ * Return: true on success, false if the file could not be written
+ */
+bool saveMapBinary(const Map *map, const char *filename)
+{
+	static const uint8_t zeros[MAP_FILE_ALIGN];
+	size_t size = (size_t)map->tilesX * map->tilesY * MAP_TILE * MAP_TILE + MAP_PADDING;
+	/*Open marks are rebuilt on load, files only hold the wall types*/
+	uint8_t *cells = malloc(size);
+	FILE *file = fopen(filename, "wb");
+	MapFileHeader header = {0};
+	bool written;
+
+	if (!file || !cells)
+	{
+		free(cells);
+		if (file)
+			fclose(file);
+		return (false);
+	}
+	for (size_t i = 0; i < size; i++)
+		cells[i] = map->cells[i] & MAP_WALL_MASK;
+	memcpy(header.magic, MAP_FILE_MAGIC, sizeof(header.magic));
+	header.version = MAP_FILE_VERSION;
+	header.cellType = MAP_CELL_UINT8;
+	header.tileShift = MAP_TILE_SHIFT;
+	header.width = map->width;
+	header.height = map->height;
+	header.dataOffset = MAP_FILE_ALIGN;
+	header.dataSize = (uint64_t)map->tilesX * map->tilesY * MAP_TILE * MAP_TILE;
+	header.checksum = hashMapCells(cells, header.dataSize);
+	swapMapHeader(&header);
+
+	/*Cells keep their padding bytes, which are always zero*/
+	written = fwrite(&header, sizeof(header), 1, file) == 1 &&
+		fwrite(zeros, 1, MAP_FILE_ALIGN - sizeof(header), file) ==
+		MAP_FILE_ALIGN - sizeof(header) &&
+		fwrite(cells, 1, size, file) == size;
+	free(cells);
+	return (fclose(file) == 0 && written);
 }
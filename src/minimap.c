@@ -0,0 +1,371 @@
+#include "../header/minimap.h"
+#include "../header/camera.h"
+
+/*Rectangles collected per colour before one SDL_RenderFillRects call*/
+#define MINIMAP_BATCH 256
+
+/*How a cell is drawn*/
+typedef enum {
+	SHADE_FOG,
+	SHADE_FLOOR,
+	SHADE_WALL,
+	SHADE_COUNT
+} CellShade;
+
+typedef struct {
+	SDL_Rect rects[MINIMAP_BATCH];
+	int count;
+} RectBatch;
+
+static const SDL_Color shadeColors[SHADE_COUNT] = {
+	{48, 48, 48, 255}, {0, 0, 0, 255}, {255, 0, 0, 255}
+};
+static RectBatch batches[SHADE_COUNT];
+
+/**
+ * isExplored - function tells whether the raycaster has seen a cell
+ * @minimap: pointer to the minimap
+ * @x: cell column
+ * @y: cell row
+ *
+ * Return: true if the cell has been seen, false otherwise
+ */
+static inline bool isExplored(const Minimap *minimap, int x, int y)
+{
+	size_t index = (size_t)y * worldMap.width + x;
+
+	return (minimap->explored[index >> 3] & (1 << (index & 7)));
+}
+
+/**
+ * exploreCell - function uncovers a cell and queues it for drawing
+ * @minimap: pointer to the minimap
+ * @x: cell column
+ * @y: cell row
+ *
+ * Return: void
+ */
+static void exploreCell(Minimap *minimap, int x, int y)
+{
+	size_t index = (size_t)y * worldMap.width + x;
+
+	if ((unsigned int)x >= (unsigned int)worldMap.width ||
+			(unsigned int)y >= (unsigned int)worldMap.height || isExplored(minimap, x, y))
+		return;
+	minimap->explored[index >> 3] |= 1 << (index & 7);
+	invalidateMinimapCell(minimap, x, y);
+}
+
+/**
+ * revealRay - function uncovers the cells a ray crossed up to its wall
+ * @minimap: pointer to the minimap
+ * @posX: player position on the x axis
+ * @posY: player position on the y axis
+ * @rayDirX: ray direction on the x axis
+ * @rayDirY: ray direction on the y axis
+ * @hit: pointer to the wall the raycaster found for this ray
+ *
+ * Walks the same cells as the raycaster's DDA, but stops at
+ * MINIMAP_REVEAL_RADIUS so the cost does not grow with open maps.
+ *
+ * Return: void
+ */
+static void revealRay(Minimap *minimap, double posX, double posY,
+		double rayDirX, double rayDirY, const RayHit *hit)
+{
+	int mapX = (int)posX, mapY = (int)posY;
+	double deltaDistX = rayDirX == 0 ? 1e30 : fabs(1 / rayDirX);
+	double deltaDistY = rayDirY == 0 ? 1e30 : fabs(1 / rayDirY);
+	int stepX = rayDirX < 0 ? -1 : 1, stepY = rayDirY < 0 ? -1 : 1;
+	double sideDistX = (rayDirX < 0 ? posX - mapX : mapX + 1.0 - posX) * deltaDistX;
+	double sideDistY = (rayDirY < 0 ? posY - mapY : mapY + 1.0 - posY) * deltaDistY;
+
+	for (int steps = 0; steps < 2 * MINIMAP_REVEAL_RADIUS; steps++)
+	{
+		exploreCell(minimap, mapX, mapY);
+		if (mapX == hit->mapX && mapY == hit->mapY)
+			return;
+		if (sideDistX < sideDistY)
+		{
+			if (sideDistX > MINIMAP_REVEAL_RADIUS)
+				return;
+			sideDistX += deltaDistX;
+			mapX += stepX;
+		}
+		else
+		{
+			if (sideDistY > MINIMAP_REVEAL_RADIUS)
+				return;
+			sideDistY += deltaDistY;
+			mapY += stepY;
+		}
+	}
+}
+
+/**
+ * revealMinimapCells - function lifts the fog from what the last frame saw
+ * @minimap: pointer to the minimap
+ * @hits: one ray hit per rendered column, as left by the raycaster
+ * @posX: player position on the x axis
+ * @posY: player position on the y axis
+ * @dirX: player direction on the x axis
+ * @dirY: player direction on the y axis
+ * @planeX: camera plane on the x axis
+ * @planeY: camera plane on the y axis
+ *
+ * Every nearby wall a column hit is uncovered, and every
+ * MINIMAP_REVEAL_STRIDE'th column of a SCREEN_WIDTH wide view also uncovers
+ * the floor in front of it, so wider render resolutions cast no more rays.
+ *
+ * Return: void
+ */
+void revealMinimapCells(Minimap *minimap, const RayHit hits[], double posX, double posY,
+		double dirX, double dirY, double planeX, double planeY)
+{
+	const int stride = SDL_max(MINIMAP_REVEAL_STRIDE * cameraTables.width / SCREEN_WIDTH, 1);
+
+	for (int x = 0; x < cameraTables.width; x++)
+	{
+		double cameraX = cameraTables.cameraX[x];
+
+		if (x % stride == 0)
+			revealRay(minimap, posX, posY, dirX + planeX * cameraX,
+					dirY + planeY * cameraX, &hits[x]);
+		else if (hits[x].perpWallDist <= MINIMAP_REVEAL_RADIUS)
+			exploreCell(minimap, hits[x].mapX, hits[x].mapY);
+	}
+}
+
+/**
+ * createMinimap - function sets up the cached minimap for worldMap
+ * @minimap: pointer to the minimap
+ * @renderer: SDL renderer pointer
+ *
+ * Return: true on success, false otherwise
+ */
+bool createMinimap(Minimap *minimap, SDL_Renderer *renderer)
+{
+	memset(minimap, 0, sizeof(Minimap));
+	minimap->texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888,
+			SDL_TEXTUREACCESS_TARGET, MINIMAP_CACHE_CELLS, MINIMAP_CACHE_CELLS);
+	if (!minimap->texture)
+	{
+		fprintf(stderr, "Minimap texture creation failed: %s\n", SDL_GetError());
+		return (false);
+	}
+	minimap->explored = calloc(((size_t)worldMap.width * worldMap.height + 7) / 8, 1);
+	if (!minimap->explored)
+	{
+		destroyMinimap(minimap);
+		return (false);
+	}
+	minimap->redraw = true;
+	return (true);
+}
+
+/**
+ * invalidateMinimapCell - function queues a cell to be drawn again
+ * @minimap: pointer to the minimap
+ * @x: cell column
+ * @y: cell row
+ *
+ * Call after changing a cell with setMapCell. Cells outside the cached
+ * window are drawn when the window reaches them.
+ *
+ * Return: void
+ */
+void invalidateMinimapCell(Minimap *minimap, int x, int y)
+{
+	if (minimap->redraw || x < minimap->originX || y < minimap->originY ||
+			x >= minimap->originX + MINIMAP_CACHE_CELLS ||
+			y >= minimap->originY + MINIMAP_CACHE_CELLS)
+		return;
+	if (minimap->dirtyCount == MINIMAP_DIRTY_MAX)
+	{
+		minimap->redraw = true;
+		return;
+	}
+	minimap->dirty[minimap->dirtyCount++] = (SDL_Point){x, y};
+}
+
+/**
+ * invalidateMinimap - function has the whole cached window drawn again
+ * @minimap: pointer to the minimap
+ *
+ * Needed when the renderer loses its render targets.
+ *
+ * Return: void
+ */
+void invalidateMinimap(Minimap *minimap)
+{
+	minimap->redraw = true;
+}
+
+/**
+ * getCellShade - function picks how a cell is drawn
+ * @minimap: pointer to the minimap
+ * @x: cell column
+ * @y: cell row
+ *
+ * Return: shade of the cell
+ */
+static CellShade getCellShade(const Minimap *minimap, int x, int y)
+{
+	if (!isExplored(minimap, x, y))
+		return (SHADE_FOG);
+	return (getMapCell(&worldMap, x, y) > 0 ? SHADE_WALL : SHADE_FLOOR);
+}
+
+/**
+ * flushBatch - function draws the rectangles collected for a shade
+ * @renderer: SDL renderer pointer
+ * @shade: shade to draw
+ *
+ * Return: void
+ */
+static void flushBatch(SDL_Renderer *renderer, CellShade shade)
+{
+	SDL_Color c = shadeColors[shade];
+
+	if (batches[shade].count == 0)
+		return;
+	SDL_SetRenderDrawColor(renderer, c.r, c.g, c.b, c.a);
+	SDL_RenderFillRects(renderer, batches[shade].rects, batches[shade].count);
+	batches[shade].count = 0;
+}
+
+/**
+ * addRect - function queues a rectangle of cached texels in a shade
+ * @renderer: SDL renderer pointer
+ * @shade: shade of the rectangle
+ * @rect: texels to fill
+ *
+ * Return: void
+ */
+static void addRect(SDL_Renderer *renderer, CellShade shade, SDL_Rect rect)
+{
+	if (batches[shade].count == MINIMAP_BATCH)
+		flushBatch(renderer, shade);
+	batches[shade].rects[batches[shade].count++] = rect;
+}
+
+/**
+ * updateCache - function draws the queued cells, or the whole window, into the cache
+ * @renderer: SDL renderer pointer
+ * @minimap: pointer to the minimap
+ *
+ * A full redraw merges each row into runs of one shade, so it needs far
+ * fewer rectangles than cells.
+ *
+ * Return: void
+ */
+static void updateCache(SDL_Renderer *renderer, Minimap *minimap)
+{
+	const int endX = SDL_min(minimap->originX + MINIMAP_CACHE_CELLS, worldMap.width);
+	const int endY = SDL_min(minimap->originY + MINIMAP_CACHE_CELLS, worldMap.height);
+
+	if (!minimap->redraw && minimap->dirtyCount == 0)
+		return;
+	SDL_SetRenderTarget(renderer, minimap->texture);
+	if (minimap->redraw)
+	{
+		for (int y = minimap->originY; y < endY; y++)
+		{
+			for (int x = minimap->originX, run; x < endX; x += run)
+			{
+				CellShade shade = getCellShade(minimap, x, y);
+
+				for (run = 1; x + run < endX && getCellShade(minimap, x + run, y) == shade; run++)
+					;
+				addRect(renderer, shade, (SDL_Rect){x - minimap->originX,
+						y - minimap->originY, run, 1});
+			}
+		}
+	}
+	else
+	{
+		for (int i = 0; i < minimap->dirtyCount; i++)
+		{
+			SDL_Point cell = minimap->dirty[i];
+
+			addRect(renderer, getCellShade(minimap, cell.x, cell.y),
+					(SDL_Rect){cell.x - minimap->originX, cell.y - minimap->originY, 1, 1});
+		}
+	}
+	for (int shade = 0; shade < SHADE_COUNT; shade++)
+		flushBatch(renderer, shade);
+	SDL_SetRenderTarget(renderer, NULL);
+	minimap->redraw = false;
+	minimap->dirtyCount = 0;
+}
+
+/**
+ * drawMiniMap - function draws the part of the map around the player
+ * @renderer: SDL renderer
+ * @minimap: pointer to the minimap
+ * @zoom: 0 to MINIMAP_ZOOM_LEVELS - 1, showing 12 << zoom cells across
+ * @posX: player position on the x axis
+ * @posY: player position on the y axis
+ * @dirX: player direction on the x axis
+ * @dirY: player direction on the y axis
+ *
+ * The view follows the player on maps larger than it and costs one blit
+ * from the cache plus the player marker, however large the map is.
+ *
+ * Return: void
+ */
+void drawMiniMap(SDL_Renderer *renderer, Minimap *minimap, int zoom,
+		double posX, double posY, double dirX, double dirY)
+{
+	const int cells = 12 << zoom;
+	const double scale = (double)MINIMAP_SIZE / cells;
+	const int viewW = SDL_min(cells, worldMap.width), viewH = SDL_min(cells, worldMap.height);
+	const int viewX = SDL_clamp((int)posX - viewW / 2, 0, worldMap.width - viewW);
+	const int viewY = SDL_clamp((int)posY - viewH / 2, 0, worldMap.height - viewH);
+
+	/*Move the cached window once the view leaves it*/
+	if (viewX < minimap->originX || viewY < minimap->originY ||
+			viewX + viewW > minimap->originX + MINIMAP_CACHE_CELLS ||
+			viewY + viewH > minimap->originY + MINIMAP_CACHE_CELLS)
+	{
+		minimap->originX = SDL_clamp(viewX + viewW / 2 - MINIMAP_CACHE_CELLS / 2, 0,
+				SDL_max(worldMap.width - MINIMAP_CACHE_CELLS, 0));
+		minimap->originY = SDL_clamp(viewY + viewH / 2 - MINIMAP_CACHE_CELLS / 2, 0,
+				SDL_max(worldMap.height - MINIMAP_CACHE_CELLS, 0));
+		minimap->redraw = true;
+	}
+	updateCache(renderer, minimap);
+
+	SDL_Rect src = {viewX - minimap->originX, viewY - minimap->originY, viewW, viewH};
+	SDL_Rect dst = {0, 0, (int)(viewW * scale), (int)(viewH * scale)};
+
+	SDL_RenderCopy(renderer, minimap->texture, &src, &dst);
+
+	/*Draw player position*/
+	int playerX = (int)((posX - viewX) * scale), playerY = (int)((posY - viewY) * scale);
+
+	SDL_SetRenderDrawColor(renderer, 255, 0, 0, 255);
+	SDL_Rect playerRect = {playerX - 2, playerY - 2, 4, 4};
+
+	SDL_RenderFillRect(renderer, &playerRect);
+	/*Draw direction line*/
+	SDL_SetRenderDrawColor(renderer, 0, 255, 0, 255);
+	SDL_RenderDrawLine(renderer, playerX, playerY,
+			(int)(playerX + dirX * 5 * MINIMAP_SCALE),
+			(int)(playerY + dirY * 5 * MINIMAP_SCALE));
+}
+
+/**
+ * destroyMinimap - function releases the cached texture and the fog
+ * @minimap: pointer to the minimap
+ *
+ * Return: void
+ */
+void destroyMinimap(Minimap *minimap)
+{
+	if (minimap->texture)
+		SDL_DestroyTexture(minimap->texture);
+	free(minimap->explored);
+	minimap->texture = NULL;
+	minimap->explored = NULL;
+}
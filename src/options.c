@@ -0,0 +1,182 @@
+#include <string.h>
+#include "../header/options.h"
+#include "../header/texture_cache.h"
+#include "../header/minimap.h"
+#include "../header/particles.h"
+#include "../header/resolution.h"
+
+/**
+ * printUsage - function prints the supported command line options
+ * @program: name the game was started with
+ *
+ * Return: void
+ */
+static void printUsage(const char *program)
+{
+	fprintf(stderr, "Usage: %s [--software | --sdl] [--threads N]\n"
+			"       [--kernel scalar|avx2] [--vsync | --fps-cap N | --uncapped]\n"
+			"       [--trace FILE] [--map FILE] [--texture-budget MB]\n"
+			"       [--rain N] [--sprites N] [--sky]\n"
+			"       [--window WxH] [--fullscreen] [--render-scale S] [--frame-budget MS]\n"
+			"       [--no-ray-cache] [--no-lighting] [--record FILE | --replay FILE]\n",
+			program);
+	fprintf(stderr, "  --software  render walls into a CPU framebuffer\n");
+	fprintf(stderr, "  --sdl       render walls with one SDL_RenderCopy per column\n");
+	fprintf(stderr, "  --threads N software render threads, 0 for one per core\n");
+	fprintf(stderr, "  --kernel K  widest DDA kernel to use, if the CPU supports it\n");
+	fprintf(stderr, "  --vsync     present in step with the display (default)\n");
+	fprintf(stderr, "  --fps-cap N present at most N frames per second\n");
+	fprintf(stderr, "  --uncapped  present frames as fast as they are rendered\n");
+	fprintf(stderr, "  --trace F   write the profiler's Chrome trace to F on exit\n");
+	fprintf(stderr, "  --map F     play the text or binary map F\n");
+	fprintf(stderr, "  --rain N    keep N drops falling while rain is on\n");
+	fprintf(stderr, "  --sprites N scatter N more sprites over the map\n");
+	fprintf(stderr, "  --sky       draw the sky instead of a textured ceiling in software\n");
+	fprintf(stderr, "  --texture-budget MB\n"
+			"              keep at most MB of textures cached before evicting unused ones\n");
+	fprintf(stderr, "  --window WxH open a W by H window, which can be resized\n");
+	fprintf(stderr, "  --fullscreen fill the desktop at its own resolution\n");
+	fprintf(stderr, "  --render-scale S\n"
+			"              render at S times the output width, 0 to follow the budget\n");
+	fprintf(stderr, "  --frame-budget MS\n"
+			"              render time the dynamic resolution aims to stay under\n");
+	fprintf(stderr, "  --no-ray-cache cast every column every frame, even when the camera stands still\n");
+	fprintf(stderr, "  --no-lighting draw walls without baked light and distance fog\n");
+	fprintf(stderr, "  --record F  write every tick's input to the log F on exit\n");
+	fprintf(stderr, "  --replay F  play the session recorded in F, then quit\n");
+}
+
+/**
+ * parseRayKernel - function converts a kernel name into a RayKernel
+ * @name: kernel name given on the command line
+ * @kernel: pointer receiving the kernel
+ *
+ * Return: true if the name is known, false otherwise
+ */
+static bool parseRayKernel(const char *name, RayKernel *kernel)
+{
+	for (RayKernel k = RAY_KERNEL_SCALAR; k <= RAY_KERNEL_AVX2; k++)
+	{
+		if (strcmp(name, getRayKernelName(k)) == 0)
+		{
+			*kernel = k;
+			return (true);
+		}
+	}
+	return (false);
+}
+
+/**
+ * parseWindowSize - function reads a window size written as WIDTHxHEIGHT
+ * @text: size given on the command line
+ * @options: pointer to the options receiving the size
+ *
+ * Return: true if the size is well formed and positive, false otherwise
+ */
+static bool parseWindowSize(const char *text, GameOptions *options)
+{
+	int width, height;
+	char end;
+
+	if (sscanf(text, "%dx%d%c", &width, &height, &end) != 2 || width <= 0 || height <= 0)
+		return (false);
+	options->windowWidth = width;
+	options->windowHeight = height;
+	return (true);
+}
+
+/**
+ * parseOptions - function reads the command line into the game options
+ * @argc: arguments counter
+ * @argv: pointer to argument array
+ * @options: pointer to the options to fill in
+ *
+ * Return: true when every argument was understood, false otherwise
+ */
+bool parseOptions(int argc, char *argv[], GameOptions *options)
+{
+	options->renderMode = RENDER_SDL;
+	options->threadCount = 0;
+	options->rayKernel = RAY_KERNEL_AVX2;
+	options->pacing = PACING_VSYNC;
+	options->fpsCap = 0;
+	options->showProfiler = false;
+	options->showSky = false;
+	options->minimapZoom = MINIMAP_DEFAULT_ZOOM;
+	options->tracePath = "profile_trace.json";
+	options->mapPath = "./resources/map.txt";
+	options->rainDrops = DEFAULT_RAIN_DROPS;
+	options->extraSprites = 0;
+	options->textureBudgetMB = TEXTURE_BUDGET_MB;
+	options->windowWidth = SCREEN_WIDTH;
+	options->windowHeight = SCREEN_HEIGHT;
+	options->fullscreen = false;
+	options->renderScale = 0;
+	options->frameBudgetMs = DEFAULT_FRAME_BUDGET_MS;
+	options->rayCache = true;
+	options->lighting = true;
+	options->recordPath = NULL;
+	options->replayPath = NULL;
+
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--software") == 0)
+			options->renderMode = RENDER_SOFTWARE;
+		else if (strcmp(argv[i], "--sdl") == 0)
+			options->renderMode = RENDER_SDL;
+		else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+			options->threadCount = atoi(argv[++i]);
+		else if (strcmp(argv[i], "--kernel") == 0 && i + 1 < argc &&
+				parseRayKernel(argv[i + 1], &options->rayKernel))
+			i++;
+		else if (strcmp(argv[i], "--vsync") == 0)
+			options->pacing = PACING_VSYNC;
+		else if (strcmp(argv[i], "--fps-cap") == 0 && i + 1 < argc &&
+				atoi(argv[i + 1]) > 0)
+		{
+			options->pacing = PACING_CAP;
+			options->fpsCap = atoi(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--uncapped") == 0)
+			options->pacing = PACING_UNCAPPED;
+		else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc)
+			options->tracePath = argv[++i];
+		else if (strcmp(argv[i], "--map") == 0 && i + 1 < argc)
+			options->mapPath = argv[++i];
+		else if (strcmp(argv[i], "--rain") == 0 && i + 1 < argc && atoi(argv[i + 1]) >= 0)
+			options->rainDrops = atoi(argv[++i]);
+		else if (strcmp(argv[i], "--sprites") == 0 && i + 1 < argc && atoi(argv[i + 1]) >= 0)
+			options->extraSprites = atoi(argv[++i]);
+		else if (strcmp(argv[i], "--sky") == 0)
+			options->showSky = true;
+		else if (strcmp(argv[i], "--texture-budget") == 0 && i + 1 < argc &&
+				atoi(argv[i + 1]) > 0)
+			options->textureBudgetMB = atoi(argv[++i]);
+		else if (strcmp(argv[i], "--window") == 0 && i + 1 < argc &&
+				parseWindowSize(argv[i + 1], options))
+			i++;
+		else if (strcmp(argv[i], "--fullscreen") == 0)
+			options->fullscreen = true;
+		else if (strcmp(argv[i], "--render-scale") == 0 && i + 1 < argc &&
+				atof(argv[i + 1]) >= 0 && atof(argv[i + 1]) <= 1)
+			options->renderScale = atof(argv[++i]);
+		else if (strcmp(argv[i], "--frame-budget") == 0 && i + 1 < argc &&
+				atof(argv[i + 1]) > 0)
+			options->frameBudgetMs = atof(argv[++i]);
+		else if (strcmp(argv[i], "--no-ray-cache") == 0)
+			options->rayCache = false;
+		else if (strcmp(argv[i], "--no-lighting") == 0)
+			options->lighting = false;
+		else if (strcmp(argv[i], "--record") == 0 && i + 1 < argc)
+			options->recordPath = argv[++i];
+		else if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc)
+			options->replayPath = argv[++i];
+		else
+		{
+			fprintf(stderr, "Unknown option: %s\n", argv[i]);
+			printUsage(argv[0]);
+			return (false);
+		}
+	}
+	return (true);
+}
@@ -0,0 +1,496 @@
+#include "../header/particles.h"
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+/*Rain falls this many pixels per second, and draws the distance it covers in this time*/
+#define RAIN_SPEED_MIN 360.0f
+#define RAIN_SPEED_MAX 720.0f
+#define RAIN_STREAK_SECONDS 0.012f
+#define SPLASH_GRAVITY 900.0f
+#define SMOKE_SIZE 6.0f
+#define SMOKE_GROWTH 12.0f
+/*Lifetime of unused slots, so the vector update never sees them expire*/
+#define PADDING_LIFE 1e30f
+
+/*Float fields of a particle, allocated, moved and freed together*/
+#define PARTICLE_FIELDS 10
+
+static const SDL_Color particleColors[] = {
+	{135, 206, 250, 255}, {170, 210, 240, 220}, {190, 190, 190, 150}
+};
+
+/**
+ * listFields - function collects the particle system's float fields
+ * @particles: pointer to the particle system
+ * @fields: array receiving a pointer to each field
+ *
+ * Return: void
+ */
+static void listFields(ParticleSystem *particles, float **fields[PARTICLE_FIELDS])
+{
+	fields[0] = &particles->x;
+	fields[1] = &particles->y;
+	fields[2] = &particles->vx;
+	fields[3] = &particles->vy;
+	fields[4] = &particles->ay;
+	fields[5] = &particles->age;
+	fields[6] = &particles->life;
+	fields[7] = &particles->size;
+	fields[8] = &particles->grow;
+	fields[9] = &particles->stretch;
+}
+
+/**
+ * nextRandom - function advances the particle system's xorshift32 generator
+ * @state: pointer to the generator state, never 0
+ *
+ * Return: next 32 random bits
+ */
+static inline Uint32 nextRandom(Uint32 *state)
+{
+	Uint32 x = *state;
+
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	return (*state = x);
+}
+
+/**
+ * randomRange - function draws a uniformly distributed float
+ * @state: pointer to the generator state
+ * @low: smallest value
+ * @high: largest value
+ *
+ * Return: value between low and high
+ */
+static inline float randomRange(Uint32 *state, float low, float high)
+{
+	return (low + (high - low) * (nextRandom(state) >> 8) * (1.0f / 16777216.0f));
+}
+
+/**
+ * spawnParticle - function adds a particle if there is room
+ * @particles: pointer to the particle system
+ * @kind: kind of particle
+ * @x: screen position on the x axis
+ * @y: screen position on the y axis
+ * @vx: velocity on the x axis, in pixels per second
+ * @vy: velocity on the y axis, in pixels per second
+ * @ay: acceleration on the y axis, in pixels per second squared
+ * @life: seconds the particle lives
+ *
+ * The kind sets the particle's size, growth, streak and colour.
+ *
+ * Return: void
+ */
+static void spawnParticle(ParticleSystem *particles, ParticleKind kind, float x, float y,
+		float vx, float vy, float ay, float life)
+{
+	int i = particles->count;
+	SDL_Color *colors;
+
+	if (i == particles->capacity)
+		return;
+	colors = particles->colors + i * 4;
+	particles->x[i] = x;
+	particles->y[i] = y;
+	particles->vx[i] = vx;
+	particles->vy[i] = vy;
+	particles->ay[i] = ay;
+	particles->age[i] = 0;
+	particles->life[i] = life;
+	particles->size[i] = kind == PARTICLE_RAIN ? 1 : kind == PARTICLE_SPLASH ? 2 : SMOKE_SIZE;
+	particles->grow[i] = kind == PARTICLE_SMOKE ? SMOKE_GROWTH : 0;
+	particles->stretch[i] = kind == PARTICLE_RAIN ? RAIN_STREAK_SECONDS : 0;
+	particles->kind[i] = kind;
+	colors[0] = colors[1] = colors[2] = colors[3] = particleColors[kind];
+	particles->count++;
+	if (kind == PARTICLE_RAIN)
+		particles->rainCount++;
+	else if (kind == PARTICLE_SMOKE)
+		particles->smokeCount++;
+}
+
+/**
+ * spawnRain - function adds one rain drop
+ * @particles: pointer to the particle system
+ * @anywhere: true to start anywhere above its landing point, false at the top
+ *
+ * Each drop lands on a random row of the floor half of the screen, so
+ * nearer drops fall further.
+ *
+ * Return: void
+ */
+static void spawnRain(ParticleSystem *particles, bool anywhere)
+{
+	Uint32 *random = &particles->random;
+	float ground = randomRange(random, particles->height / 2, particles->height);
+	/*Taller outputs fall faster so drops take as long to land*/
+	float speed = randomRange(random, RAIN_SPEED_MIN, RAIN_SPEED_MAX) *
+		particles->height / SCREEN_HEIGHT;
+	float y = anywhere ? randomRange(random, -10, ground) : randomRange(random, -40, -10);
+
+	spawnParticle(particles, PARTICLE_RAIN, randomRange(random, 0, particles->width), y,
+			0, speed, 0, (ground - y) / speed);
+}
+
+/**
+ * createParticleSystem - function allocates the particle buffers
+ * @capacity: most particles alive at once
+ * @seed: seed of the random generator, the same seed gives the same weather
+ *
+ * Return: pointer to the particle system, or NULL on failure
+ */
+ParticleSystem *createParticleSystem(int capacity, Uint32 seed)
+{
+	ParticleSystem *particles = calloc(1, sizeof(ParticleSystem));
+	/*Round up so the update can always work on four particles at once*/
+	int padded = (capacity + 3) & ~3;
+	float **fields[PARTICLE_FIELDS];
+	bool failed = false;
+
+	if (!particles)
+		return (NULL);
+	particles->capacity = capacity;
+	particles->random = seed ? seed : 1;
+	particles->width = SCREEN_WIDTH;
+	particles->height = SCREEN_HEIGHT;
+	listFields(particles, fields);
+	for (int f = 0; f < PARTICLE_FIELDS; f++)
+		failed |= !(*fields[f] = calloc(padded, sizeof(float)));
+	particles->kind = calloc(padded, sizeof(Uint8));
+	particles->corners = malloc((size_t)padded * 8 * sizeof(float));
+	particles->colors = calloc((size_t)padded * 4, sizeof(SDL_Color));
+	particles->indices = malloc((size_t)capacity * 6 * sizeof(int));
+	if (failed || !particles->kind || !particles->corners || !particles->colors ||
+			!particles->indices)
+	{
+		destroyParticleSystem(particles);
+		return (NULL);
+	}
+	for (int i = 0; i < padded; i++)
+		particles->life[i] = PADDING_LIFE;
+	/*Two triangles per quad*/
+	for (int i = 0; i < capacity; i++)
+	{
+		int *quad = particles->indices + i * 6;
+
+		quad[0] = i * 4;
+		quad[1] = i * 4 + 1;
+		quad[2] = i * 4 + 2;
+		quad[3] = i * 4 + 2;
+		quad[4] = i * 4 + 1;
+		quad[5] = i * 4 + 3;
+	}
+	return (particles);
+}
+
+/**
+ * setRainDensity - function sets how many rain drops keep falling
+ * @particles: pointer to the particle system
+ * @drops: drops to keep falling, 0 to let the rain stop
+ *
+ * Drops already falling land normally when the density goes down.
+ *
+ * Return: void
+ */
+void setRainDensity(ParticleSystem *particles, int drops)
+{
+	particles->rainTarget = SDL_min(drops, particles->capacity);
+}
+
+/**
+ * setParticleArea - function sets the size of the output the rain falls over
+ * @particles: pointer to the particle system
+ * @width: output width in pixels
+ * @height: output height in pixels
+ *
+ * Drops already falling keep their course and land normally.
+ *
+ * Return: void
+ */
+void setParticleArea(ParticleSystem *particles, int width, int height)
+{
+	particles->width = width;
+	particles->height = height;
+}
+
+/**
+ * emitMuzzleSmoke - function releases a cloud of smoke puffs
+ * @particles: pointer to the particle system
+ * @x: screen position of the muzzle on the x axis
+ * @y: screen position of the muzzle on the y axis
+ * @puffs: number of puffs
+ *
+ * Return: void
+ */
+void emitMuzzleSmoke(ParticleSystem *particles, float x, float y, int puffs)
+{
+	Uint32 *random = &particles->random;
+
+	for (int i = 0; i < puffs; i++)
+		spawnParticle(particles, PARTICLE_SMOKE, x - SMOKE_SIZE / 2 + randomRange(random, -12, 12),
+				y - SMOKE_SIZE / 2 + randomRange(random, -6, 6), randomRange(random, -25, 25),
+				randomRange(random, -70, -30), 25, randomRange(random, 0.6f, 1.1f));
+}
+
+/**
+ * integrateParticles - function moves every particle forward in time
+ * @particles: pointer to the particle system
+ * @seconds: time step
+ *
+ * Return: true if any particle reached the end of its life
+ */
+static bool integrateParticles(ParticleSystem *particles, float seconds)
+{
+	const int count = particles->count;
+	int i = 0, expired = 0;
+
+#ifdef __SSE2__
+	const __m128 dt = _mm_set1_ps(seconds);
+
+	/*Buffers are padded to a multiple of four with lanes that never expire*/
+	for (; i < count; i += 4)
+	{
+		__m128 vy = _mm_loadu_ps(particles->vy + i);
+		__m128 age = _mm_add_ps(_mm_loadu_ps(particles->age + i), dt);
+
+		vy = _mm_add_ps(vy, _mm_mul_ps(_mm_loadu_ps(particles->ay + i), dt));
+		_mm_storeu_ps(particles->x + i, _mm_add_ps(_mm_loadu_ps(particles->x + i),
+					_mm_mul_ps(_mm_loadu_ps(particles->vx + i), dt)));
+		_mm_storeu_ps(particles->y + i, _mm_add_ps(_mm_loadu_ps(particles->y + i),
+					_mm_mul_ps(vy, dt)));
+		_mm_storeu_ps(particles->vy + i, vy);
+		_mm_storeu_ps(particles->age + i, age);
+		expired |= _mm_movemask_ps(_mm_cmpge_ps(age, _mm_loadu_ps(particles->life + i)));
+	}
+	return (expired != 0);
+#else
+	for (; i < count; i++)
+	{
+		particles->vy[i] += particles->ay[i] * seconds;
+		particles->x[i] += particles->vx[i] * seconds;
+		particles->y[i] += particles->vy[i] * seconds;
+		particles->age[i] += seconds;
+		expired |= particles->age[i] >= particles->life[i];
+	}
+	return (expired != 0);
+#endif
+}
+
+/**
+ * removeParticle - function replaces a particle with the last one
+ * @particles: pointer to the particle system
+ * @i: index of the particle
+ *
+ * Return: void
+ */
+static void removeParticle(ParticleSystem *particles, int i)
+{
+	int last = --particles->count;
+	float **fields[PARTICLE_FIELDS];
+
+	if (particles->kind[i] == PARTICLE_RAIN)
+		particles->rainCount--;
+	else if (particles->kind[i] == PARTICLE_SMOKE)
+		particles->smokeCount--;
+	listFields(particles, fields);
+	for (int f = 0; f < PARTICLE_FIELDS; f++)
+		(*fields[f])[i] = (*fields[f])[last];
+	particles->kind[i] = particles->kind[last];
+	memcpy(particles->colors + i * 4, particles->colors + last * 4, 4 * sizeof(SDL_Color));
+	/*The freed slot becomes padding*/
+	particles->life[last] = PADDING_LIFE;
+}
+
+/**
+ * groupExpired - function tells whether a group of four particles holds a dead one
+ * @particles: pointer to the particle system
+ * @i: index of the group's first particle, a multiple of four
+ *
+ * Return: true if any of the four reached the end of its life
+ */
+static inline bool groupExpired(const ParticleSystem *particles, int i)
+{
+#ifdef __SSE2__
+	return (_mm_movemask_ps(_mm_cmpge_ps(_mm_loadu_ps(particles->age + i),
+					_mm_loadu_ps(particles->life + i))) != 0);
+#else
+	int expired = 0;
+
+	for (int k = i; k < i + 4; k++)
+		expired |= particles->age[k] >= particles->life[k];
+	return (expired != 0);
+#endif
+}
+
+/**
+ * updateParticles - function advances all particles by a frame's time
+ * @particles: pointer to the particle system
+ * @seconds: time since the last update
+ *
+ * Landed rain drops break into two splashes, and new drops start at the
+ * top of the screen to keep the rain at its density.
+ *
+ * Return: void
+ */
+void updateParticles(ParticleSystem *particles, float seconds)
+{
+	Uint32 *random = &particles->random;
+	bool fill = particles->rainCount == 0;
+
+	if (integrateParticles(particles, seconds))
+	{
+		for (int i = 0; i < particles->count;)
+		{
+			/*Most groups have nothing dead, skip them four at a time*/
+			if ((i & 3) == 0 && !groupExpired(particles, i))
+			{
+				i += 4;
+				continue;
+			}
+			if (particles->age[i] < particles->life[i])
+			{
+				i++;
+				continue;
+			}
+			if (particles->kind[i] == PARTICLE_RAIN)
+			{
+				float x = particles->x[i], y = particles->y[i];
+
+				removeParticle(particles, i);
+				for (int s = -1; s <= 1; s += 2)
+					spawnParticle(particles, PARTICLE_SPLASH, x, y,
+							s * randomRange(random, 20, 60), randomRange(random, -140, -70),
+							SPLASH_GRAVITY, randomRange(random, 0.15f, 0.25f));
+			}
+			else
+				removeParticle(particles, i);
+			/*The particle moved into slot i is checked on the next pass*/
+		}
+	}
+	/*Rain that starts from nothing fills the screen at once*/
+	while (particles->rainCount < particles->rainTarget && particles->count < particles->capacity)
+		spawnRain(particles, fill);
+}
+
+/**
+ * buildCorners - function computes the four vertices of every particle's quad
+ * @particles: pointer to the particle system
+ *
+ * A quad starts size pixels wide, grows by grow pixels per second on each
+ * side and is stretched down by the distance fallen in stretch seconds,
+ * which covers rain streaks, splashes and smoke without branching on kind.
+ *
+ * Return: void
+ */
+static void buildCorners(ParticleSystem *particles)
+{
+	float *corners = particles->corners;
+	int i = 0;
+
+#ifdef __SSE2__
+	/*Padding lanes produce garbage corners past the end that are never drawn*/
+	for (; i < particles->count; i += 4, corners += 32)
+	{
+		__m128 spread = _mm_mul_ps(_mm_loadu_ps(particles->grow + i),
+				_mm_loadu_ps(particles->age + i));
+		__m128 width = _mm_add_ps(_mm_loadu_ps(particles->size + i), _mm_add_ps(spread, spread));
+		__m128 x0 = _mm_sub_ps(_mm_loadu_ps(particles->x + i), spread);
+		__m128 y0 = _mm_sub_ps(_mm_loadu_ps(particles->y + i), spread);
+		__m128 x1 = _mm_add_ps(x0, width);
+		__m128 y1 = _mm_add_ps(_mm_add_ps(y0, width), _mm_mul_ps(
+					_mm_loadu_ps(particles->stretch + i), _mm_loadu_ps(particles->vy + i)));
+		/*Interleave into x0 y0, x1 y0, x0 y1, x1 y1 for each particle*/
+		__m128 topLeftLow = _mm_unpacklo_ps(x0, y0), topLeftHigh = _mm_unpackhi_ps(x0, y0);
+		__m128 topRightLow = _mm_unpacklo_ps(x1, y0), topRightHigh = _mm_unpackhi_ps(x1, y0);
+		__m128 bottomLeftLow = _mm_unpacklo_ps(x0, y1), bottomLeftHigh = _mm_unpackhi_ps(x0, y1);
+		__m128 bottomRightLow = _mm_unpacklo_ps(x1, y1), bottomRightHigh = _mm_unpackhi_ps(x1, y1);
+
+		_mm_storeu_ps(corners, _mm_movelh_ps(topLeftLow, topRightLow));
+		_mm_storeu_ps(corners + 4, _mm_movelh_ps(bottomLeftLow, bottomRightLow));
+		_mm_storeu_ps(corners + 8, _mm_movehl_ps(topRightLow, topLeftLow));
+		_mm_storeu_ps(corners + 12, _mm_movehl_ps(bottomRightLow, bottomLeftLow));
+		_mm_storeu_ps(corners + 16, _mm_movelh_ps(topLeftHigh, topRightHigh));
+		_mm_storeu_ps(corners + 20, _mm_movelh_ps(bottomLeftHigh, bottomRightHigh));
+		_mm_storeu_ps(corners + 24, _mm_movehl_ps(topRightHigh, topLeftHigh));
+		_mm_storeu_ps(corners + 28, _mm_movehl_ps(bottomRightHigh, bottomLeftHigh));
+	}
+#else
+	for (; i < particles->count; i++, corners += 8)
+	{
+		float spread = particles->grow[i] * particles->age[i];
+		float width = particles->size[i] + 2 * spread;
+		float x0 = particles->x[i] - spread, y0 = particles->y[i] - spread;
+		float x1 = x0 + width, y1 = y0 + width + particles->stretch[i] * particles->vy[i];
+
+		corners[0] = x0;
+		corners[1] = y0;
+		corners[2] = x1;
+		corners[3] = y0;
+		corners[4] = x0;
+		corners[5] = y1;
+		corners[6] = x1;
+		corners[7] = y1;
+	}
+#endif
+}
+
+/**
+ * drawParticles - function draws every particle with one geometry call
+ * @particles: pointer to the particle system
+ * @renderer: SDL renderer pointer
+ *
+ * Rain is a one pixel wide streak as long as the distance it falls in
+ * RAIN_STREAK_SECONDS, a splash a small square and smoke a square that
+ * grows and fades with age.
+ *
+ * Return: void
+ */
+void drawParticles(ParticleSystem *particles, SDL_Renderer *renderer)
+{
+	if (particles->count == 0)
+		return;
+	buildCorners(particles);
+	/*Only smoke changes colour after it spawns*/
+	for (int i = 0; particles->smokeCount > 0 && i < particles->count; i++)
+	{
+		SDL_Color *colors = particles->colors + i * 4;
+		Uint8 alpha;
+
+		if (particles->kind[i] != PARTICLE_SMOKE)
+			continue;
+		alpha = (Uint8)(particleColors[PARTICLE_SMOKE].a *
+				SDL_max(0, 1 - particles->age[i] / particles->life[i]));
+		colors[0].a = colors[1].a = colors[2].a = colors[3].a = alpha;
+	}
+	SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+	SDL_RenderGeometryRaw(renderer, NULL, particles->corners, 2 * sizeof(float),
+			particles->colors, sizeof(SDL_Color), NULL, 0, particles->count * 4,
+			particles->indices, particles->count * 6, sizeof(int));
+	SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_NONE);
+}
+
+/**
+ * destroyParticleSystem - function frees the particle buffers
+ * @particles: pointer to the particle system, may be NULL
+ *
+ * Return: void
+ */
+void destroyParticleSystem(ParticleSystem *particles)
+{
+	float **fields[PARTICLE_FIELDS];
+
+	if (!particles)
+		return;
+	listFields(particles, fields);
+	for (int f = 0; f < PARTICLE_FIELDS; f++)
+		free(*fields[f]);
+	free(particles->kind);
+	free(particles->corners);
+	free(particles->colors);
+	free(particles->indices);
+	free(particles);
+}
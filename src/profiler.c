@@ -0,0 +1,299 @@
+#include "../header/profiler.h"
+
+#ifndef NDEBUG
+
+/*One timed stretch of a zone*/
+typedef struct {
+	ProfileZone zone;
+	Uint64 start;
+	Uint64 end;
+} ProfileEvent;
+
+/*Everything recorded between two profileEndFrame calls*/
+typedef struct {
+	Uint64 start;
+	Uint64 end;
+	int eventCount;
+	ProfileEvent events[PROFILE_MAX_EVENTS];
+} ProfileFrame;
+
+static const char *zoneNames[ZONE_COUNT] = {
+	"map load", "texture load", "raycasting", "floor", "sprites", "minimap", "weapon", "particles", "present"
+};
+
+static const SDL_Color zoneColors[ZONE_COUNT] = {
+	{160, 160, 160, 255}, {255, 255, 255, 255}, {255, 80, 80, 255},
+	{180, 110, 110, 255}, {255, 150, 60, 255}, {80, 200, 80, 255}, {240, 200, 60, 255},
+	{90, 160, 255, 255}, {200, 90, 255, 255}
+};
+
+/*Ring buffer of finished frames, plus the first frame which holds startup loading*/
+static ProfileFrame frames[PROFILE_FRAMES];
+static ProfileFrame startupFrame;
+static ProfileFrame current;
+static int frameCount;
+static Uint64 zoneStart[ZONE_COUNT];
+static Uint64 traceOrigin;
+static TextureData digitTextures[10];
+
+/**
+ * profileBegin - function marks the start of a zone
+ * @zone: zone being entered
+ *
+ * Return: void
+ */
+void profileBegin(ProfileZone zone)
+{
+	zoneStart[zone] = SDL_GetPerformanceCounter();
+	if (!traceOrigin)
+		traceOrigin = current.start = zoneStart[zone];
+}
+
+/**
+ * profileEnd - function records a zone that started with profileBegin
+ * @zone: zone being left
+ *
+ * Return: void
+ */
+void profileEnd(ProfileZone zone)
+{
+	ProfileEvent *event;
+
+	if (current.eventCount == PROFILE_MAX_EVENTS)
+		return;
+	event = &current.events[current.eventCount++];
+	event->zone = zone;
+	event->start = zoneStart[zone];
+	event->end = SDL_GetPerformanceCounter();
+}
+
+/**
+ * profileEndFrame - function closes the current frame and stores it
+ *
+ * Return: void
+ */
+void profileEndFrame(void)
+{
+	current.end = SDL_GetPerformanceCounter();
+	if (!traceOrigin)
+		traceOrigin = current.start = current.end;
+	if (frameCount == 0)
+		startupFrame = current;
+	frames[frameCount % PROFILE_FRAMES] = current;
+	frameCount++;
+	current.start = current.end;
+	current.eventCount = 0;
+}
+
+/**
+ * getZoneMs - function adds up a zone's time within a frame
+ * @frame: pointer to the frame
+ * @zone: zone to add up
+ *
+ * Return: time spent in the zone in milliseconds
+ */
+static double getZoneMs(const ProfileFrame *frame, ProfileZone zone)
+{
+	Uint64 ticks = 0;
+
+	for (int i = 0; i < frame->eventCount; i++)
+		if (frame->events[i].zone == zone)
+			ticks += frame->events[i].end - frame->events[i].start;
+	return (ticks * 1000.0 / SDL_GetPerformanceFrequency());
+}
+
+/**
+ * loadProfilerOverlay - function acquires the digit glyphs used by the overlay
+ * @textures: pointer to the texture cache
+ *
+ * Return: true if every glyph loaded, false otherwise
+ */
+bool loadProfilerOverlay(TextureCache *textures)
+{
+	char path[64];
+
+	for (int i = 0; i < 10; i++)
+	{
+		snprintf(path, sizeof(path), "./resources/textures/digits/%d.png", i);
+		digitTextures[i] = acquireTexture(textures, path);
+		if (!digitTextures[i].texture)
+			return (false);
+	}
+	return (true);
+}
+
+/**
+ * drawMilliseconds - function writes a time as digits with two decimals
+ * @renderer: SDL renderer pointer
+ * @x: left edge of the text
+ * @y: top edge of the text
+ * @ms: time in milliseconds
+ *
+ * Return: void
+ */
+static void drawMilliseconds(SDL_Renderer *renderer, int x, int y, double ms)
+{
+	const int size = 14;
+	char text[16];
+
+	snprintf(text, sizeof(text), "%.2f", ms);
+	SDL_SetRenderDrawColor(renderer, 200, 30, 30, 255);
+	for (char *c = text; *c; c++)
+	{
+		if (*c == '.')
+		{
+			/*There is no glyph for the decimal point*/
+			SDL_Rect dot = {x + 1, y + size - 4, 3, 3};
+
+			SDL_RenderFillRect(renderer, &dot);
+			x += 6;
+			continue;
+		}
+		SDL_Rect dst = {x, y, size, size};
+
+		SDL_RenderCopy(renderer, digitTextures[*c - '0'].texture, NULL, &dst);
+		x += size - 2;
+	}
+}
+
+/**
+ * drawProfilerOverlay - function draws the frame-time graph and zone times
+ * @renderer: SDL renderer pointer
+ *
+ * The graph stacks each zone's time per frame in its own colour, with one
+ * batched rectangle call per zone; below it every zone shows its colour and
+ * its average time over the frames in the ring buffer.
+ *
+ * Return: void
+ */
+void drawProfilerOverlay(SDL_Renderer *renderer)
+{
+	const int barWidth = 2, graphHeight = 60, rowHeight = 16;
+	/*The top of the graph is two frames at 60 fps*/
+	const double msPerPixel = 33.3 / graphHeight;
+	const int shown = SDL_min(frameCount, PROFILE_FRAMES / 2);
+	const int top = 8;
+	int outputWidth, left;
+	static SDL_Rect bars[ZONE_COUNT][PROFILE_FRAMES / 2];
+	double average[ZONE_COUNT + 1] = {0};
+	int barCount[ZONE_COUNT] = {0};
+
+	if (shown == 0)
+		return;
+	SDL_GetRendererOutputSize(renderer, &outputWidth, NULL);
+	left = outputWidth - PROFILE_FRAMES / 2 * barWidth - 8;
+	for (int i = 0; i < shown; i++)
+	{
+		const ProfileFrame *frame = &frames[(frameCount - shown + i) % PROFILE_FRAMES];
+		int y = top + graphHeight;
+
+		for (int zone = 0; zone < ZONE_COUNT; zone++)
+		{
+			double ms = getZoneMs(frame, zone);
+			int height = (int)(ms / msPerPixel);
+
+			average[zone] += ms / shown;
+			if (height <= 0)
+				continue;
+			y -= height;
+			bars[zone][barCount[zone]++] = (SDL_Rect){left + i * barWidth, y, barWidth, height};
+		}
+		average[ZONE_COUNT] += (frame->end - frame->start) * 1000.0 /
+			SDL_GetPerformanceFrequency() / shown;
+	}
+
+	/*Translucent backdrop*/
+	SDL_Rect backdrop = {left - 4, top - 4, PROFILE_FRAMES / 2 * barWidth + 8,
+		graphHeight + (ZONE_COUNT + 1) * rowHeight + 12};
+
+	SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+	SDL_SetRenderDrawColor(renderer, 0, 0, 0, 170);
+	SDL_RenderFillRect(renderer, &backdrop);
+	SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_NONE);
+
+	for (int zone = 0; zone < ZONE_COUNT; zone++)
+	{
+		SDL_Color c = zoneColors[zone];
+
+		SDL_SetRenderDrawColor(renderer, c.r, c.g, c.b, 255);
+		SDL_RenderFillRects(renderer, bars[zone], barCount[zone]);
+	}
+
+	/*One row per zone plus the whole frame, each with its colour swatch*/
+	for (int row = 0; row <= ZONE_COUNT; row++)
+	{
+		int y = top + graphHeight + 6 + row * rowHeight;
+		SDL_Color c = row < ZONE_COUNT ? zoneColors[row] : (SDL_Color){0, 0, 0, 255};
+		SDL_Rect swatch = {left, y + 2, 10, 10};
+
+		SDL_SetRenderDrawColor(renderer, c.r, c.g, c.b, 255);
+		if (row < ZONE_COUNT)
+			SDL_RenderFillRect(renderer, &swatch);
+		else
+		{
+			SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
+			SDL_RenderDrawRect(renderer, &swatch);
+		}
+		drawMilliseconds(renderer, left + 16, y, average[row]);
+	}
+}
+
+/**
+ * writeFrameEvents - function writes a frame's zones as trace events
+ * @out: stream receiving the events
+ * @frame: pointer to the frame
+ * @first: pointer to a flag telling whether a comma is needed
+ *
+ * Return: void
+ */
+static void writeFrameEvents(FILE *out, const ProfileFrame *frame, bool *first)
+{
+	const double usPerTick = 1e6 / SDL_GetPerformanceFrequency();
+
+	fprintf(out, "%s\n{\"name\": \"frame\", \"ph\": \"X\", \"pid\": 1, \"tid\": 1, "
+			"\"ts\": %.3f, \"dur\": %.3f}", *first ? "" : ",",
+			(frame->start - traceOrigin) * usPerTick,
+			(frame->end - frame->start) * usPerTick);
+	*first = false;
+	for (int i = 0; i < frame->eventCount; i++)
+	{
+		const ProfileEvent *event = &frame->events[i];
+
+		fprintf(out, ",\n{\"name\": \"%s\", \"ph\": \"X\", \"pid\": 1, \"tid\": 1, "
+				"\"ts\": %.3f, \"dur\": %.3f}", zoneNames[event->zone],
+				(event->start - traceOrigin) * usPerTick,
+				(event->end - event->start) * usPerTick);
+	}
+}
+
+/**
+ * writeProfileTrace - function exports the recorded frames for chrome://tracing
+ * @path: file to write the Chrome trace-event JSON to
+ *
+ * Writes the startup frame with the loading zones followed by the frames
+ * still in the ring buffer.
+ *
+ * Return: true on success, false if the file could not be written
+ */
+bool writeProfileTrace(const char *path)
+{
+	FILE *out = fopen(path, "w");
+	bool first = true;
+	int oldest = SDL_max(frameCount - PROFILE_FRAMES, 1);
+
+	if (!out)
+	{
+		fprintf(stderr, "Failed to open trace file: %s\n", path);
+		return (false);
+	}
+	fprintf(out, "{\"traceEvents\": [");
+	if (frameCount > 0)
+		writeFrameEvents(out, &startupFrame, &first);
+	for (int i = oldest; i < frameCount; i++)
+		writeFrameEvents(out, &frames[i % PROFILE_FRAMES], &first);
+	fprintf(out, "\n], \"displayTimeUnit\": \"ms\"}\n");
+	fclose(out);
+	return (true);
+}
+
+#endif
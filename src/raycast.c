@@ -0,0 +1,244 @@
+#include "../header/raycast.h"
+
+/*Kernel used by castRays, chosen once by selectRayKernel*/
+static RayKernel activeKernel = RAY_KERNEL_SCALAR;
+
+/**
+ * castRay - function walks a ray through worldMap with DDA until it hits a wall
+ * @posX: ray origin on the x axis
+ * @posY: ray origin on the y axis
+ * @rayDirX: ray direction on the x axis
+ * @rayDirY: ray direction on the y axis
+ * @result: pointer to the structure that receives the hit information
+ *
+ * A cell marked MAP_CELL_OPEN lies in a region without walls: the ray
+ * then jumps straight to the first cell outside that region (or its
+ * sector), landing on the same cell and side as stepping through every
+ * cell would.
+ *
+ * Return: void
+ */
+void castRay(double posX, double posY, double rayDirX, double rayDirY, RayHit *result)
+{
+	RayWalk walk;
+	/*Was a NS or a EW wall hit*/
+	int side = 0;
+	int cell;
+
+	startRayWalk(&walk, posX, posY, rayDirX, rayDirY);
+
+	/*Perform DDA*/
+	cell = worldMap.cells[getMapCellIndex(&worldMap, walk.mapX, walk.mapY)];
+	while (!(cell & MAP_WALL_MASK))
+	{
+		/*Open region: go to its last cell, the next step leaves it*/
+		if (cell)
+			crossOpenBlock(&walk);
+		/*Jump to next map square, OR in x-direction, OR in y-direction*/
+		if (walk.sideDistX < walk.sideDistY)
+		{
+			walk.sideDistX += walk.deltaDistX;
+			walk.mapX += walk.stepX;
+			side = 0;
+		} else
+		{
+			walk.sideDistY += walk.deltaDistY;
+			walk.mapY += walk.stepY;
+			side = 1;
+		}
+		cell = worldMap.cells[getMapCellIndex(&worldMap, walk.mapX, walk.mapY)];
+	}
+
+	completeRayHit(posX, posY, rayDirX, rayDirY, walk.mapX, walk.mapY, side, result);
+}
+
+/**
+ * walkRay - function visits every cell a ray crosses until it reaches a wall
+ * @posX: ray origin on the x axis
+ * @posY: ray origin on the y axis
+ * @rayDirX: ray direction on the x axis
+ * @rayDirY: ray direction on the y axis
+ * @maxDistance: distance along the ray after which the walk gives up
+ * @visit: called for each open cell with the distance at which the ray enters it
+ * @context: passed to visit
+ *
+ * Steps through every cell with the same DDA as castRay, but never jumps
+ * across open regions, since the caller wants to see the cells. Distances
+ * are in multiples of the ray direction, starting with 0 for the origin.
+ *
+ * Return: distance at which the walk stopped: where the ray enters the
+ * wall, where visit returned false, or maxDistance
+ */
+double walkRay(double posX, double posY, double rayDirX, double rayDirY,
+		double maxDistance, RayCellVisitor visit, void *context)
+{
+	RayWalk walk;
+	int64_t distance = 0, limit = toRayDistance(maxDistance);
+
+	startRayWalk(&walk, posX, posY, rayDirX, rayDirY);
+	while (distance <= limit && getMapCell(&worldMap, walk.mapX, walk.mapY) == 0)
+	{
+		if (!visit(context, walk.mapX, walk.mapY, distance / DDA_ONE))
+			return (distance / DDA_ONE);
+		/*Jump to next map square, OR in x-direction, OR in y-direction*/
+		if (walk.sideDistX < walk.sideDistY)
+		{
+			distance = walk.sideDistX;
+			walk.sideDistX += walk.deltaDistX;
+			walk.mapX += walk.stepX;
+		} else
+		{
+			distance = walk.sideDistY;
+			walk.sideDistY += walk.deltaDistY;
+			walk.mapY += walk.stepY;
+		}
+	}
+	return (SDL_min(distance, limit) / DDA_ONE);
+}
+
+/**
+ * completeRayHit - function fills in a hit from the wall cell a ray reached
+ * @posX: ray origin on the x axis
+ * @posY: ray origin on the y axis
+ * @rayDirX: ray direction on the x axis
+ * @rayDirY: ray direction on the y axis
+ * @mapX: x index of the wall cell that was hit
+ * @mapY: y index of the wall cell that was hit
+ * @side: 0 if an x-side was crossed last, 1 for a y-side
+ * @result: pointer to the structure that receives the hit information
+ *
+ * Always runs in double precision, so every DDA kernel that lands on the
+ * same cell and side reports exactly the same distance and texture column.
+ *
+ * Return: void
+ */
+void completeRayHit(double posX, double posY, double rayDirX, double rayDirY,
+		int mapX, int mapY, int side, RayHit *result)
+{
+	int stepX = rayDirX < 0 ? -1 : 1;
+	int stepY = rayDirY < 0 ? -1 : 1;
+	double perpWallDist, wallX;
+
+	/*Calculate distance projected on camera direction
+	 * (Euclidean distance will give fisheye effect!)*/
+	if (side == 0)
+		perpWallDist = (mapX - posX + (1 - stepX) / 2) / rayDirX;
+	else
+		perpWallDist = (mapY - posY + (1 - stepY) / 2) / rayDirY;
+
+	/*Where exactly the wall was hit*/
+	if (side == 0)
+		wallX = posY + perpWallDist * rayDirY;
+	else
+		wallX = posX + perpWallDist * rayDirX;
+	wallX -= floor((wallX));
+
+	result->perpWallDist = perpWallDist;
+	result->wallX = wallX;
+	result->mapX = mapX;
+	result->mapY = mapY;
+	result->side = side;
+	result->flipTex = (side == 0 && rayDirX > 0) || (side == 1 && rayDirY < 0);
+}
+
+/**
+ * getColumnExtent - function computes the on-screen span of a wall slice
+ * @perpWallDist: distance to the wall projected on the camera direction
+ * @screenHeight: rows of the view the slice is drawn in
+ * @lineHeight: receives the unclipped height of the slice
+ * @drawStart: receives the first screen row of the slice
+ * @drawEnd: receives the last screen row of the slice
+ *
+ * Return: void
+ */
+void getColumnExtent(double perpWallDist, int screenHeight, int *lineHeight,
+		int *drawStart, int *drawEnd)
+{
+	/* Calculate height of line to draw on screen*/
+	*lineHeight = (int)(screenHeight / perpWallDist);
+	/*Calculate lowest and highest pixel to fill in current stripe*/
+	*drawStart = -*lineHeight / 2 + screenHeight / 2;
+
+	if (*drawStart < 0)
+		*drawStart = 0;
+	*drawEnd = *lineHeight / 2 + screenHeight / 2;
+
+	if (*drawEnd >= screenHeight)
+		*drawEnd = screenHeight - 1;
+}
+
+/**
+ * getTextureX - function maps a ray hit to a texture column
+ * @hit: pointer to the ray hit
+ * @texWidth: width of the wall texture
+ *
+ * Return: x-coordinate on the texture
+ */
+int getTextureX(const RayHit *hit, int texWidth)
+{
+	int texX = (int)(hit->wallX * (double)texWidth);
+
+	if (hit->flipTex)
+		texX = texWidth - texX - 1;
+	return (texX);
+}
+
+/**
+ * castRays - function casts a run of rays with the selected DDA kernel
+ * @posX: ray origin on the x axis
+ * @posY: ray origin on the y axis
+ * @rayDirX: array of ray directions on the x axis
+ * @rayDirY: array of ray directions on the y axis
+ * @count: number of rays
+ * @results: array receiving one hit per ray
+ *
+ * Return: void
+ */
+void castRays(double posX, double posY, const double *rayDirX,
+		const double *rayDirY, int count, RayHit *results)
+{
+	int i = 0;
+	RayKernel kernel = activeKernel;
+
+	if (kernel == RAY_KERNEL_AVX2)
+		for (; i + 8 <= count; i += 8)
+			castRayPacketAVX2(posX, posY, rayDirX + i, rayDirY + i, results + i);
+	/*Leftover rays that do not fill a packet*/
+	for (; i < count; i++)
+		castRay(posX, posY, rayDirX[i], rayDirY[i], &results[i]);
+}
+
+/**
+ * selectRayKernel - function picks the DDA kernel castRays will use
+ * @requested: widest kernel wanted; the CPU may only support a narrower one
+ *
+ * Return: the kernel actually selected
+ */
+RayKernel selectRayKernel(RayKernel requested)
+{
+	activeKernel = RAY_KERNEL_SCALAR;
+#if defined(__x86_64__) || defined(__i386__)
+	if (requested >= RAY_KERNEL_AVX2 && SDL_HasAVX2())
+		activeKernel = RAY_KERNEL_AVX2;
+#else
+	(void)requested;
+#endif
+	return (activeKernel);
+}
+
+/**
+ * getRayKernelName - function names a DDA kernel for messages
+ * @kernel: the kernel
+ *
+ * Return: constant string with the kernel name
+ */
+const char *getRayKernelName(RayKernel kernel)
+{
+	switch (kernel)
+	{
+		case RAY_KERNEL_AVX2:
+			return ("avx2");
+		default:
+			return ("scalar");
+	}
+}
@@ -0,0 +1,190 @@
+#include "../header/raycast.h"
+
+/*
+ * Ray-packet DDA kernel. Adjacent rays are walked together in SIMD
+ * lanes: every iteration each lane takes one step in x or y, selected
+ * with a mask instead of a branch, and looks up its new cell. The first
+ * wall a lane meets is recorded and the lane retired, but it keeps
+ * stepping with the others until the whole packet is done. The lanes
+ * keep castRay's 32.32 fixed point distances and cross MAP_CELL_OPEN
+ * regions with the same crossOpenBlock, so every lane reaches exactly the
+ * wall cell and side castRay does; completeRayHit then works out the
+ * distance in double precision.
+ */
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+
+/*
+ * The 64-bit distances of the 8 rays fill two registers, rays 0-3 and
+ * rays 4-7. Blending their compare masks dword by dword gives the 32-bit
+ * lanes the order 0, 4, 1, 5, 2, 6, 3, 7, which the cell coordinates keep.
+ */
+#define PACKET_LANE(ray) (((ray) & 3) << 1 | (ray) >> 2)
+#define PACKET_RAY(lane) ((lane) >> 1 | ((lane) & 1) << 2)
+
+/**
+ * castRayPacketAVX2 - function casts 8 adjacent rays with AVX2
+ * @posX: ray origin on the x axis
+ * @posY: ray origin on the y axis
+ * @rayDirX: 8 ray directions on the x axis
+ * @rayDirY: 8 ray directions on the y axis
+ * @results: array receiving the 8 hits
+ *
+ * Return: void
+ */
+__attribute__((target("avx2")))
+void castRayPacketAVX2(double posX, double posY, const double *rayDirX,
+		const double *rayDirY, RayHit *results)
+{
+	const __m256i unit = _mm256_set1_epi32(1);
+	const __m256i tilesX = _mm256_set1_epi32(worldMap.tilesX);
+	const __m256i tileMask = _mm256_set1_epi32(MAP_TILE_MASK);
+	const __m256i wallMask = _mm256_set1_epi32(MAP_WALL_MASK);
+	const __m256i cellMask = _mm256_set1_epi32(MAP_WALL_MASK | MAP_CELL_OPEN);
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i maxX = _mm256_set1_epi32(worldMap.width - 1);
+	const __m256i maxY = _mm256_set1_epi32(worldMap.height - 1);
+	int start = worldMap.cells[getMapCellIndex(&worldMap, (int)posX, (int)posY)];
+	int64_t sidesX[8], sidesY[8], deltasX[8], deltasY[8];
+	int stepsX[8], stepsY[8], lanesX[8], lanesY[8], lanesSide[8];
+	__m256i sideDistX[2], sideDistY[2], deltaDistX[2], deltaDistY[2];
+	__m256i mapX, mapY, stepX, stepY, hitX, hitY, side, active;
+	RayWalk walk;
+
+	/*castRay stops at once in a wall cell; no lane would ever look at it*/
+	if (start & MAP_WALL_MASK)
+	{
+		for (int i = 0; i < 8; i++)
+			castRay(posX, posY, rayDirX[i], rayDirY[i], &results[i]);
+		return;
+	}
+	for (int i = 0; i < 8; i++)
+	{
+		startRayWalk(&walk, posX, posY, rayDirX[i], rayDirY[i]);
+		if (start)
+			crossOpenBlock(&walk);
+		sidesX[i] = walk.sideDistX;
+		sidesY[i] = walk.sideDistY;
+		deltasX[i] = walk.deltaDistX;
+		deltasY[i] = walk.deltaDistY;
+		lanesX[PACKET_LANE(i)] = walk.mapX;
+		lanesY[PACKET_LANE(i)] = walk.mapY;
+		stepsX[PACKET_LANE(i)] = walk.stepX;
+		stepsY[PACKET_LANE(i)] = walk.stepY;
+	}
+	for (int h = 0; h < 2; h++)
+	{
+		sideDistX[h] = _mm256_loadu_si256((const __m256i *)(sidesX + 4 * h));
+		sideDistY[h] = _mm256_loadu_si256((const __m256i *)(sidesY + 4 * h));
+		deltaDistX[h] = _mm256_loadu_si256((const __m256i *)(deltasX + 4 * h));
+		deltaDistY[h] = _mm256_loadu_si256((const __m256i *)(deltasY + 4 * h));
+	}
+	mapX = hitX = _mm256_loadu_si256((const __m256i *)lanesX);
+	mapY = hitY = _mm256_loadu_si256((const __m256i *)lanesY);
+	stepX = _mm256_loadu_si256((const __m256i *)stepsX);
+	stepY = _mm256_loadu_si256((const __m256i *)stepsY);
+	side = _mm256_setzero_si256();
+	active = _mm256_cmpeq_epi32(unit, unit);
+
+	/*
+	 * Finished lanes keep stepping so that the next step never waits on
+	 * this step's gather; only their recorded hit is frozen. Their cell
+	 * coordinates are clamped into the map before the lookup. Most steps
+	 * land on empty cells, which one compare rules out for every lane.
+	 */
+	for (;;)
+	{
+		/*Jump to next map square, OR in x-direction, OR in y-direction*/
+		__m256i takeXLow = _mm256_cmpgt_epi64(sideDistY[0], sideDistX[0]);
+		__m256i takeXHigh = _mm256_cmpgt_epi64(sideDistY[1], sideDistX[1]);
+		__m256i takeX = _mm256_blend_epi32(takeXLow, takeXHigh, 0xAA);
+		__m256i cellX, cellY, index, cell, hit;
+		int entered, open;
+
+		sideDistX[0] = _mm256_add_epi64(sideDistX[0], _mm256_and_si256(takeXLow, deltaDistX[0]));
+		sideDistY[0] = _mm256_add_epi64(sideDistY[0], _mm256_andnot_si256(takeXLow, deltaDistY[0]));
+		sideDistX[1] = _mm256_add_epi64(sideDistX[1], _mm256_and_si256(takeXHigh, deltaDistX[1]));
+		sideDistY[1] = _mm256_add_epi64(sideDistY[1], _mm256_andnot_si256(takeXHigh, deltaDistY[1]));
+		mapX = _mm256_add_epi32(mapX, _mm256_and_si256(takeX, stepX));
+		mapY = _mm256_add_epi32(mapY, _mm256_andnot_si256(takeX, stepY));
+
+		cellX = _mm256_min_epi32(_mm256_max_epi32(mapX, zero), maxX);
+		cellY = _mm256_min_epi32(_mm256_max_epi32(mapY, zero), maxY);
+		/*Tiled cell offset, as getMapCellIndex computes it*/
+		index = _mm256_add_epi32(_mm256_mullo_epi32(_mm256_srli_epi32(cellY,
+						MAP_TILE_SHIFT), tilesX), _mm256_srli_epi32(cellX, MAP_TILE_SHIFT));
+		index = _mm256_or_si256(_mm256_slli_epi32(index, 2 * MAP_TILE_SHIFT),
+				_mm256_or_si256(_mm256_slli_epi32(_mm256_and_si256(cellY, tileMask),
+						MAP_TILE_SHIFT), _mm256_and_si256(cellX, tileMask)));
+
+		/*Each gather reads 4 bytes, keep the first's wall type and open flag*/
+		cell = _mm256_and_si256(_mm256_i32gather_epi32((const int *)worldMap.cells,
+					index, 1), cellMask);
+		entered = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_and_si256(active,
+						_mm256_cmpgt_epi32(cell, zero))));
+		if (!entered)
+			continue;
+
+		/* Check if rays have hit a wall*/
+		hit = _mm256_and_si256(active, _mm256_cmpgt_epi32(_mm256_and_si256(cell,
+						wallMask), zero));
+		hitX = _mm256_blendv_epi8(hitX, mapX, hit);
+		hitY = _mm256_blendv_epi8(hitY, mapY, hit);
+		side = _mm256_blendv_epi8(side, _mm256_andnot_si256(takeX, unit), hit);
+		active = _mm256_andnot_si256(hit, active);
+		if (_mm256_testz_si256(active, active))
+			break;
+
+		/*Lanes still walking that entered an open region cross it now*/
+		open = entered & ~_mm256_movemask_ps(_mm256_castsi256_ps(hit));
+		if (!open)
+			continue;
+		_mm256_storeu_si256((__m256i *)lanesX, mapX);
+		_mm256_storeu_si256((__m256i *)lanesY, mapY);
+		for (int h = 0; h < 2; h++)
+		{
+			_mm256_storeu_si256((__m256i *)(sidesX + 4 * h), sideDistX[h]);
+			_mm256_storeu_si256((__m256i *)(sidesY + 4 * h), sideDistY[h]);
+		}
+		for (int i = 0; i < 8; i++)
+		{
+			int ray = PACKET_RAY(i);
+
+			if (!(open & (1 << i)))
+				continue;
+			walk = (RayWalk){lanesX[i], lanesY[i], stepsX[i], stepsY[i],
+				deltasX[ray], deltasY[ray], sidesX[ray], sidesY[ray]};
+			crossOpenBlock(&walk);
+			lanesX[i] = walk.mapX;
+			lanesY[i] = walk.mapY;
+			sidesX[ray] = walk.sideDistX;
+			sidesY[ray] = walk.sideDistY;
+		}
+		mapX = _mm256_loadu_si256((const __m256i *)lanesX);
+		mapY = _mm256_loadu_si256((const __m256i *)lanesY);
+		for (int h = 0; h < 2; h++)
+		{
+			sideDistX[h] = _mm256_loadu_si256((const __m256i *)(sidesX + 4 * h));
+			sideDistY[h] = _mm256_loadu_si256((const __m256i *)(sidesY + 4 * h));
+		}
+	}
+
+	_mm256_storeu_si256((__m256i *)lanesX, hitX);
+	_mm256_storeu_si256((__m256i *)lanesY, hitY);
+	_mm256_storeu_si256((__m256i *)lanesSide, side);
+	for (int i = 0; i < 8; i++)
+		completeRayHit(posX, posY, rayDirX[PACKET_RAY(i)], rayDirY[PACKET_RAY(i)],
+				lanesX[i], lanesY[i], lanesSide[i], &results[PACKET_RAY(i)]);
+}
+
+#else
+
+/*No packet kernel on this architecture; selectRayKernel keeps the scalar one*/
+void castRayPacketAVX2(double posX, double posY, const double *rayDirX,
+		const double *rayDirY, RayHit *results)
+{
+	for (int i = 0; i < 8; i++)
+		castRay(posX, posY, rayDirX[i], rayDirY[i], &results[i]);
+}
+
+#endif
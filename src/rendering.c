@@ -1,75 +1,172 @@
 #include "../header/rendering.h"
-#include "../header/raindrops.h"
+#include "../header/raycast.h"
+#include "../header/camera.h"
+#include "../header/lightmap.h"
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+/*Wall hit of every screen column in the last frame drawn*/
+RayHit columnHits[MAX_RENDER_WIDTH];
+RayCache rayCache = {.enabled = true};
+
+/*What castColumns can take from the last frame*/
+typedef enum {
+	RAY_CACHE_MISS,  /* cast every column */
+	RAY_CACHE_SAME,  /* same camera: columnHits already holds the hits */
+	RAY_CACHE_TURN   /* same position: complete hits from previousHits */
+} RayCacheMode;
+
+static RayCacheMode cacheMode;
+/*Hits and view of the last frame, kept while this frame overwrites them on a turn*/
+static RayHit previousHits[MAX_RENDER_WIDTH];
+static double previousDirX, previousDirY, previousPlaneX, previousPlaneY;
 
 /**
- * drawScene - Function draws the scene to the screen
- * @renderer: SDL renderer
- * @texture: texture for the player
+ * prepareRayCache - Function decides what this frame can reuse from the last
  * @posX: player position on the x axis
  * @posY: player position on the y axis
  * @dirX: player direction on the x axis
- * 
+ * @dirY: player direction on the y axis
+ * @planeX: camera plane on the x axis
+ * @planeY: camera plane on the y axis
+ *
+ * Called once per frame before any column is cast, then records this
+ * frame's camera as the one columnHits will hold.
+ *
  * Return: void
  */
-Raindrop raindrops[MAX_RAINDROPS];
-void drawMiniMap(SDL_Renderer *renderer, double posX, double posY, double dirX, double dirY)
+static void prepareRayCache(double posX, double posY, double dirX, double dirY,
+		double planeX, double planeY)
 {
-	for (int y = 0; y < MAP_HEIGHT; y++)
+	const int width = cameraTables.width;
+
+	cacheMode = RAY_CACHE_MISS;
+	if (rayCache.enabled && rayCache.valid && rayCache.width == width &&
+			rayCache.mapVersion == worldMap.version &&
+			rayCache.posX == posX && rayCache.posY == posY)
 	{
-		for (int x = 0; x < MAP_WIDTH; x++)
+		if (rayCache.dirX == dirX && rayCache.dirY == dirY &&
+				rayCache.planeX == planeX && rayCache.planeY == planeY)
+			cacheMode = RAY_CACHE_SAME;
+		else
 		{
-			SDL_SetRenderDrawColor(renderer, worldMap[x][y] > 0 ? 255 : 0, 0, 0, 255);
-			SDL_Rect rect = {x * MINIMAP_SCALE, y * MINIMAP_SCALE, MINIMAP_SCALE, MINIMAP_SCALE};
-			SDL_RenderFillRect(renderer, &rect);
+			cacheMode = RAY_CACHE_TURN;
+			memcpy(previousHits, columnHits, width * sizeof(RayHit));
+			previousDirX = rayCache.dirX;
+			previousDirY = rayCache.dirY;
+			previousPlaneX = rayCache.planeX;
+			previousPlaneY = rayCache.planeY;
 		}
 	}
+	SDL_AtomicSet(&rayCache.reused, cacheMode == RAY_CACHE_SAME ? width : 0);
+	rayCache.valid = true;
+	rayCache.posX = posX;
+	rayCache.posY = posY;
+	rayCache.dirX = dirX;
+	rayCache.dirY = dirY;
+	rayCache.planeX = planeX;
+	rayCache.planeY = planeY;
+	rayCache.width = width;
+	rayCache.mapVersion = worldMap.version;
+}
 
-	/*Draw player position*/
-	SDL_SetRenderDrawColor(renderer, 255, 0, 0, 255);
-	SDL_Rect playerRect = {(int)(posX * MINIMAP_SCALE) - 2,
-		(int)(posY * MINIMAP_SCALE) - 2, 4, 4};
-
-	SDL_RenderFillRect(renderer, &playerRect);
-	/*Draw direction line*/
-	SDL_SetRenderDrawColor(renderer, 0, 255, 0, 255);
-	SDL_RenderDrawLine(renderer, (int)(posX * MINIMAP_SCALE), (int)(posY * MINIMAP_SCALE),
-			(int)(posX * MINIMAP_SCALE + dirX * 5 * MINIMAP_SCALE),
-			(int)(posY * MINIMAP_SCALE + dirY * 5 * MINIMAP_SCALE));
+/**
+ * reuseTurnedHit - Function completes a ray from the last frame's hits around it
+ * @rayDirX: ray direction on the x axis
+ * @rayDirY: ray direction on the y axis
+ * @hit: pointer receiving the hit
+ *
+ * The ray is expressed in the last frame's camera, which gives the
+ * fractional column it would have been cast in there.
+ *
+ * Return: true if the hit was filled in, false if the ray must be cast
+ */
+static bool reuseTurnedHit(double rayDirX, double rayDirY, RayHit *hit)
+{
+	const double dirX = previousDirX, dirY = previousDirY;
+	const double planeX = previousPlaneX, planeY = previousPlaneY;
+	/*ray = k * (dir + plane * cameraX), solved with cross products*/
+	double across = dirX * rayDirY - dirY * rayDirX;
+	double along = rayDirX * planeY - rayDirY * planeX;
+	double column;
+	const RayHit *left, *right;
+	int j;
+
+	if (along * (dirX * planeY - dirY * planeX) <= 0)
+		return (false);
+	column = (across / along + 1) * rayCache.width / 2;
+	if (!(column >= 0 && column < rayCache.width - 1))
+		return (false);
+	j = (int)column;
+	left = &previousHits[j];
+	right = &previousHits[j + 1];
+	if (left->mapX != right->mapX || left->mapY != right->mapY || left->side != right->side)
+		return (false);
+	completeRayHit(rayCache.posX, rayCache.posY, rayDirX, rayDirY,
+			left->mapX, left->mapY, left->side, hit);
+	return (true);
 }
 
 /**
- * drawRain - function to draw rain 
- * @renderer: SDL pointer to render scene
- * 
+ * castColumns - Function casts the rays of a run of screen columns
+ * @cameraX: camera-space x of each column of the run
+ * @mode: what can be taken from the last frame, RAY_CACHE_MISS for nothing
+ * @first: first screen column of the run
+ * @count: number of columns, at most COLUMN_STRIP
+ * @posX: player position on the x axis
+ * @posY: player position on the y axis
+ * @dirX: player direction on the x axis
+ * @dirY: player direction on the y axis
+ * @planeX: camera plane on the x axis
+ * @planeY: camera plane on the y axis
+ * @hits: array receiving one hit per column
+ *
+ * Takes what it can from the last frame, as prepareRayCache decided, and
+ * casts the remaining rays together.
+ *
  * Return: void
  */
-void drawRain(SDL_Renderer *renderer)
+static void castColumns(const double *cameraX, RayCacheMode mode, int first,
+		int count, double posX, double posY, double dirX, double dirY,
+		double planeX, double planeY, RayHit *hits)
 {
-	/*Light blue color for raindrops*/
-	SDL_SetRenderDrawColor(renderer, 135, 206, 250, 255);
+	double rayDirX[COLUMN_STRIP], rayDirY[COLUMN_STRIP];
+	RayHit cast[COLUMN_STRIP];
+	int missed[COLUMN_STRIP];
+	int missCount = 0;
 
-	for (int i = 0; i < MAX_RAINDROPS; i++)
+	if (mode == RAY_CACHE_SAME)
 	{
-		/*Draw each raindrop as a small line*/
-		SDL_RenderDrawLine(renderer, raindrops[i].x, raindrops[i].y,
-				raindrops[i].x, raindrops[i].y + 5);
-		/*Move rain drop down*/
-		raindrops[i].y += raindrops[i].speed;
-
-		/*If raindrop goes off the screen, reset its position to the top*/
-		if (raindrops[i].y > SCREEN_HEIGHT)
-		{
-			raindrops[i].x = rand() % SCREEN_WIDTH;
-			raindrops[i].y = -5;
-		}
+		memcpy(hits, &columnHits[first], count * sizeof(RayHit));
+		return;
 	}
-}
+	for (int i = 0; i < count; i++)
+	{
+		double x = dirX + planeX * cameraX[i], y = dirY + planeY * cameraX[i];
 
+		if (mode == RAY_CACHE_TURN && reuseTurnedHit(x, y, &hits[i]))
+			continue;
+		rayDirX[missCount] = x;
+		rayDirY[missCount] = y;
+		missed[missCount++] = i;
+	}
+	if (missCount == count)
+	{
+		castRays(posX, posY, rayDirX, rayDirY, count, hits);
+		return;
+	}
+	SDL_AtomicAdd(&rayCache.reused, count - missCount);
+	if (missCount > 0)
+		castRays(posX, posY, rayDirX, rayDirY, missCount, cast);
+	for (int i = 0; i < missCount; i++)
+		hits[missed[i]] = cast[i];
+}
 
 /**
  * performRaycasting - Function performs raycasting and draws the scene
  * @renderer: SDL renderer
- * @wallTextures: array of textures for the walls
+ * @wallMipmaps: mip levels of the wall textures
  * @skyTexture: pointer to sky texture 
  * @posX: player position on the x axis
  * @posY: player position on the y axis
@@ -77,152 +174,273 @@ void drawRain(SDL_Renderer *renderer)
  * @dirY: player direction on the y axis
  * @planeX: camera plane on the x axis
  * @planeY: camera plane on the y axis
+ *
+ * Draws cameraTables.width columns in a view cameraTables.height tall;
+ * the caller scales the renderer so that this fills the output. Each
+ * slice is copied from the mip level with about one texel per row, and
+ * lit and fogged through the texture's colour modulation.
  * 
  * Return: void
  */
-void performRaycasting(SDL_Renderer *renderer, TextureData wallTextures[],
+void performRaycasting(SDL_Renderer *renderer, const WallMipmaps *wallMipmaps,
 		TextureData *skyTexture, double posX, double posY, double dirX,
 		double dirY, double planeX, double planeY)
 {
-	int lineHeight, drawStart, drawEnd, texID, texWidth, texHeight, texX;
+	const int screenWidth = cameraTables.width, screenHeight = cameraTables.height;
+	int lineHeight, drawStart, drawEnd, texID, texWidth, texHeight, level, x;
+	Uint32 shade;
+	RayHit hits[COLUMN_STRIP];
 
+	prepareRayCache(posX, posY, dirX, dirY, planeX, planeY);
 	/* Draw the sky (top half of the screen)*/
-	SDL_Rect skyRect = {0, 0, SCREEN_WIDTH, SCREEN_HEIGHT / 2};
+	SDL_Rect skyRect = {0, 0, screenWidth, screenHeight / 2};
 
 	SDL_RenderCopy(renderer, skyTexture->texture, NULL, &skyRect);
 
-	for (int x = 0; x < SCREEN_WIDTH; x++)
+	for (int first = 0; first < screenWidth; first += COLUMN_STRIP)
 	{
-		/*X-coordinate in camera space*/
-		double cameraX = 2 * x / (double)SCREEN_WIDTH - 1;
-		double rayDirX = dirX + planeX * cameraX;
-		double rayDirY = dirY + planeY * cameraX;
-		int mapX = (int)posX;
-		int mapY = (int)posY;
-		/*Length of ray from current position to next x or y-side*/
-		double sideDistX, sideDistY;
-		/*Length of ray from one x or y-side to the next x or y-side*/
-		double deltaDistX = fabs(1 / rayDirX);
-		double deltaDistY = fabs(1 / rayDirY);
-		double perpWallDist;
-		/*Direction to go in x and y (+1 or -1)*/
-		int stepX, stepY;
-		/*Was there a wall hit*/
-		int hit = 0;
-		/*Was a NS or a EW wall hit*/
-		int side;
-
-		/* Calculate step and initial sideDist*/
-		if (rayDirX < 0)
-		{
-			stepX = -1;
-			sideDistX = (posX - mapX) * deltaDistX;
-		} else
-		{
-			stepX = 1;
-			sideDistX = (mapX + 1.0 - posX) * deltaDistX;
-		}
+		int count = SDL_min(COLUMN_STRIP, screenWidth - first);
 
-		if (rayDirY < 0)
-		{
-			stepY = -1;
-			sideDistY = (posY - mapY) * deltaDistY;
-		} else
+		castColumns(cameraTables.cameraX + first, cacheMode, first, count,
+				posX, posY, dirX, dirY, planeX, planeY, hits);
+		memcpy(&columnHits[first], hits, count * sizeof(RayHit));
+		for (int i = 0; i < count; i++)
 		{
-			stepY = 1;
-			sideDistY = (mapY + 1.0 - posY) * deltaDistY;
+			const RayHit *hit = &hits[i];
+
+			x = first + i;
+			getColumnExtent(hit->perpWallDist, screenHeight, &lineHeight, &drawStart, &drawEnd);
+			/*Texture coordinates*/
+			/*Adjust for 0-based index*/
+			texID = getMapCell(&worldMap, hit->mapX, hit->mapY) - 1;
+			level = pickWallLevel(lineHeight, wallMipmaps->height[texID],
+					wallMipmaps->levelCount[texID]);
+			/*Use dynamic width*/
+			texWidth = wallMipmaps->width[texID] >> level;
+			/*Use dynamic height*/
+			texHeight = wallMipmaps->height[texID] >> level;
+			SDL_Rect srcRect = {0, 0, texWidth, texHeight};
+			SDL_Rect destRect = {x, drawStart, 1, drawEnd - drawStart};
+
+			/* X-coordinate on the texture*/
+			srcRect.x = getTextureX(hit, texWidth);
+
+			/*Light and fog as the texture's colour modulation*/
+			shade = getColumnShade(&lightmap, hit);
+			SDL_SetTextureColorMod(wallMipmaps->levels[texID][level],
+					shade >> 16 & 0xFF, shade >> 8 & 0xFF, shade & 0xFF);
+
+			/*Draw the wall slice*/
+
+			SDL_RenderCopy(renderer, wallMipmaps->levels[texID][level],
+					&srcRect, &destRect);
 		}
+	}
+}
+
+/*Everything a worker needs to draw its strip of columns*/
+typedef struct {
+	Framebuffer *fb;
+	const WallAtlas *wallAtlas;
+	TextureData *skyTexture;
+	const double *cameraX; /* camera-space x of every framebuffer column */
+	RayCacheMode cacheMode;
+	RayHit *hits;          /* receives every column's hit, or NULL */
+	double posX, posY, dirX, dirY, planeX, planeY;
+} ColumnJob;
+
+/**
+ * shadeColumn - Function lights a texture column once for a whole slice
+ * @texels: the atlas column
+ * @shaded: receives the lit texels
+ * @count: texels in the column
+ * @shade: per channel multipliers from getColumnShade
+ *
+ * A slice reads each texel of its column about once or more, so lighting
+ * the column up front costs no more multiplies than lighting the slice,
+ * and takes them four texels at a time.
+ *
+ * Return: void
+ */
+static void shadeColumn(const Uint32 *texels, Uint32 *shaded, int count, Uint32 shade)
+{
+	int i = 0;
+
+#ifdef __SSE2__
+	const __m128i zero = _mm_setzero_si128();
+	/*Lanes hold shade + 1 like shadeTexel, and 256 for alpha*/
+	const __m128i factor = _mm_add_epi16(_mm_unpacklo_epi8(
+				_mm_set1_epi32((int)(shade | 0xFF000000)), zero), _mm_set1_epi16(1));
+
+	for (; i + 4 <= count; i += 4)
+	{
+		__m128i texel = _mm_loadu_si128((const __m128i *)(texels + i));
+		__m128i low = _mm_mullo_epi16(_mm_unpacklo_epi8(texel, zero), factor);
+		__m128i high = _mm_mullo_epi16(_mm_unpackhi_epi8(texel, zero), factor);
+
+		_mm_storeu_si128((__m128i *)(shaded + i),
+				_mm_packus_epi16(_mm_srli_epi16(low, 8), _mm_srli_epi16(high, 8)));
+	}
+#endif
+	for (; i < count; i++)
+		shaded[i] = shadeTexel(texels[i], shade);
+}
 
-		/*Perform DDA*/
-		while (hit == 0)
+/**
+ * drawColumns - Function raycasts and draws a strip of framebuffer columns
+ * @context: pointer to the ColumnJob describing the frame
+ * @begin: first column of the strip
+ * @end: one past the last column of the strip
+ *
+ * Every column only depends on the camera and the map, so strips can be
+ * drawn by any thread in any order and the frame comes out the same.
+ *
+ * Return: void
+ */
+static void drawColumns(void *context, int begin, int end)
+{
+	const ColumnJob *job = context;
+	Framebuffer *fb = job->fb;
+	const int horizon = fb->height / 2;
+	const WallAtlas *atlas = job->wallAtlas;
+	const TextureData *sky = job->skyTexture;
+	int lineHeight, drawStart, drawEnd, texID, texX, texHeight, texelMask, level, x, y;
+	RayHit hits[COLUMN_STRIP];
+	Uint32 shaded[SHADED_COLUMN_TEXELS];
+
+	for (int first = begin; first < end; first += COLUMN_STRIP)
+	{
+		int count = SDL_min(COLUMN_STRIP, end - first);
+
+		castColumns(job->cameraX + first, job->cacheMode, first, count,
+				job->posX, job->posY, job->dirX, job->dirY, job->planeX, job->planeY, hits);
+		if (job->hits)
+			memcpy(&job->hits[first], hits, count * sizeof(RayHit));
+		for (int i = 0; i < count; i++)
 		{
-			/*Jump to next map square, OR in x-direction, OR in y-direction*/
-			if (sideDistX < sideDistY)
-			{
-				sideDistX += deltaDistX;
-				mapX += stepX;
-				side = 0;
-			} else
-			{
-				sideDistY += deltaDistY;
-				mapY += stepY;
-				side = 1;
-			}
+			const RayHit *hit = &hits[i];
 
-			/* Check if ray has hit a wall*/
-			if (worldMap[mapX][mapY] > 0)
-				hit = 1;
-		}
+			x = first + i;
+			Uint32 *dst = fb->pixels + x;
 
-		/*Calculate distance projected on camera direction
-		 * (Euclidean distance will give fisheye effect!)*/
-		if (side == 0)
-			perpWallDist = (mapX - posX + (1 - stepX) / 2) / rayDirX;
-		else
-			perpWallDist = (mapY - posY + (1 - stepY) / 2) / rayDirY;
-		/* Calculate height of line to draw on screen*/
-		lineHeight = (int)(SCREEN_HEIGHT / perpWallDist);
-		/*Calculate lowest and highest pixel to fill in current stripe*/
-		drawStart = -lineHeight / 2 + SCREEN_HEIGHT / 2;
-
-		if (drawStart < 0)
-			drawStart = 0;
-		drawEnd = lineHeight / 2 + SCREEN_HEIGHT / 2;
-
-		if (drawEnd >= SCREEN_HEIGHT)
-			drawEnd = SCREEN_HEIGHT - 1;
-		/*Texture coordinates*/
-		/*Adjust for 0-based index*/
-		texID = worldMap[mapX][mapY] - 1;
-		/*Use dynamic width*/
-		texWidth = wallTextures[texID].width;
-		/*Use dynamic height*/
-		texHeight = wallTextures[texID].height;
-		SDL_Rect srcRect = {0, 0, texWidth, texHeight};
-		SDL_Rect destRect = {x, drawStart, 1, drawEnd - drawStart};
-
-		/* X-coordinate on the texture*/
-		/*Where exactly the wall was hit*/
-		double wallX;
-
-		if (side == 0)
-			wallX = posY + perpWallDist * rayDirY;
-		else
-			wallX = posX + perpWallDist * rayDirX;
-		wallX -= floor((wallX));
+			getColumnExtent(hit->perpWallDist, fb->height, &lineHeight, &drawStart, &drawEnd);
+			fb->depth[x] = hit->perpWallDist;
+			fb->drawStart[x] = drawStart;
+			fb->drawEnd[x] = drawEnd;
+			texID = getMapCell(&worldMap, hit->mapX, hit->mapY) - 1;
 
-		texX = (int)(wallX * (double)texWidth);
+			const Uint32 *texColumn;
+			int sliceHeight = drawEnd - drawStart;
 
-		if (side == 0 && rayDirX > 0)
-			texX = texWidth - texX - 1;
+			/*About one texel per row, so a distant wall reads a small level*/
+			level = pickWallLevel(lineHeight, atlas->height[texID], atlas->textureLevels[texID]);
+			texHeight = atlas->height[texID] >> level;
+			texelMask = (1 << (atlas->heightShift - level)) - 1;
+			/*Atlas columns are contiguous, so the slice reads consecutive texels*/
+			texX = getTextureX(hit, atlas->width[texID] >> level);
+			texColumn = getAtlasColumn(atlas, level, texID, texX);
 
-		if (side == 1 && rayDirY < 0)
-			texX = texWidth - texX - 1;
+			/*Sky stretched over the top half, as the SDL path does*/
+			if (sky)
+			{
+				const Uint32 *skyColumn = (const Uint32 *)sky->surface->pixels
+					+ x * sky->width / fb->width;
+				const int skyPitch = sky->surface->pitch / sizeof(Uint32);
 
-		srcRect.x = texX;
+				for (y = 0; y < drawStart; y++)
+					dst[y * fb->width] = skyColumn[(y * sky->height / horizon) * skyPitch];
+			}
 
-		/*Draw the wall slice*/
+			/*Wall slice, squeezing the whole texture column into the slice*/
+			if (sliceHeight > 0)
+			{
+				Uint32 step = ((Uint32)texHeight << 16) / sliceHeight;
+				Uint32 texPos = 0;
+				Uint32 shade = getColumnShade(&lightmap, hit);
 
-		SDL_RenderCopy(renderer, wallTextures[texID].texture,
-				&srcRect, &destRect);
+				if (shade != LIGHT_FULL && texHeight > SHADED_COLUMN_TEXELS)
+				{
+					for (y = drawStart; y < drawEnd; y++)
+					{
+						dst[y * fb->width] = shadeTexel(texColumn[(texPos >> 16) & texelMask], shade);
+						texPos += step;
+					}
+					continue;
+				}
+				if (shade != LIGHT_FULL)
+				{
+					shadeColumn(texColumn, shaded, texHeight, shade);
+					texColumn = shaded;
+				}
+				for (y = drawStart; y < drawEnd; y++)
+				{
+					dst[y * fb->width] = texColumn[(texPos >> 16) & texelMask];
+					texPos += step;
+				}
+			}
+		}
 	}
 }
+
 /**
- * initializeRaindrops - function to make it rain
- * 
+ * performRaycastingSoftware - Function raycasts the scene into a framebuffer
+ * @fb: framebuffer receiving the pixels and the per-column wall depth and slice
+ * @pool: worker threads sharing the columns, or NULL for the caller only
+ * @wallAtlas: wall textures transposed by createWallAtlas
+ * @skyTexture: pointer to sky texture, or NULL to leave the ceiling to performFloorCasting
+ * @posX: player position on the x axis
+ * @posY: player position on the y axis
+ * @dirX: player direction on the x axis
+ * @dirY: player direction on the y axis
+ * @planeX: camera plane on the x axis
+ * @planeY: camera plane on the y axis
+ *
+ * Produces the same walls and sky as performRaycasting, but every pixel is
+ * written once on the CPU and the frame reaches the GPU in a single upload.
+ * The floor, and the ceiling when there is no sky, are left for
+ * performFloorCasting, which fills the rows around the wall slices.
+ * Columns are handed out in strips of COLUMN_STRIP so that strips which
+ * look down long corridors do not hold up the rest of the frame. The
+ * framebuffer must be at the camera tables' resolution.
+ *
  * Return: void
  */
+void performRaycastingSoftware(Framebuffer *fb, ThreadPool *pool,
+		const WallAtlas *wallAtlas, TextureData *skyTexture, double posX,
+		double posY, double dirX, double dirY, double planeX, double planeY)
+{
+	ColumnJob job = {fb, wallAtlas, skyTexture, cameraTables.cameraX, RAY_CACHE_MISS,
+		columnHits, posX, posY, dirX, dirY, planeX, planeY};
+
+	prepareRayCache(posX, posY, dirX, dirY, planeX, planeY);
+	job.cacheMode = cacheMode;
+	runParallel(pool, fb->width, COLUMN_STRIP, drawColumns, &job);
+}
 
-/* Initialize raindrops*/
-void initializeRaindrops(void)
+/**
+ * performRaycastingView - Function raycasts the walls of one view on the calling thread
+ * @fb: framebuffer receiving the pixels and the per-column wall depth and slice
+ * @wallAtlas: wall textures transposed by createWallAtlas
+ * @cameraX: camera-space x of each of the framebuffer's columns
+ * @posX: camera position on the x axis
+ * @posY: camera position on the y axis
+ * @dirX: camera direction on the x axis
+ * @dirY: camera direction on the y axis
+ * @planeX: camera plane on the x axis
+ * @planeY: camera plane on the y axis
+ *
+ * The walls of performRaycastingSoftware without its sky, the ray cache
+ * or columnHits: nothing outside the arguments is written, so any number
+ * of threads can each draw a different view at once.
+ *
+ * Return: void
+ */
+void performRaycastingView(Framebuffer *fb, const WallAtlas *wallAtlas,
+		const double *cameraX, double posX, double posY, double dirX,
+		double dirY, double planeX, double planeY)
 {
-	int i;
+	ColumnJob job = {fb, wallAtlas, NULL, cameraX, RAY_CACHE_MISS,
+		NULL, posX, posY, dirX, dirY, planeX, planeY};
 
-	for (i = 0; i < MAX_RAINDROPS; i++)
-	{
-		raindrops[i].x = rand() % SCREEN_WIDTH;
-		raindrops[i].y = rand() % SCREEN_HEIGHT;
-		/*Rain speed between 0.5 and 1.0*/
-		raindrops[i].speed = (rand() % 5 + 5) / 10.0f;
-	}
+	drawColumns(&job, 0, fb->width);
 }
@@ -0,0 +1,108 @@
+#include <math.h>
+#include "../header/resolution.h"
+
+/**
+ * applyScale - function sets the internal resolution from the scale
+ * @resolution: pointer to the render resolution
+ *
+ * The width is rounded to a whole number of column strips and the height
+ * follows it at the output's aspect ratio.
+ *
+ * Return: true if the internal resolution changed, false otherwise
+ */
+static bool applyScale(RenderResolution *resolution)
+{
+	int width = (int)lround(resolution->outputWidth * resolution->scale /
+			RENDER_WIDTH_STEP) * RENDER_WIDTH_STEP;
+	int height;
+
+	width = SDL_clamp(width, RENDER_WIDTH_STEP, MAX_RENDER_WIDTH);
+	height = (int)lround((double)width * resolution->outputHeight / resolution->outputWidth);
+	height = SDL_clamp(height, 1, MAX_RENDER_HEIGHT);
+	if (width == resolution->width && height == resolution->height)
+		return (false);
+	resolution->width = width;
+	resolution->height = height;
+	/*Times measured at the old size say little about the new one*/
+	resolution->averageMs = 0;
+	resolution->settle = RESOLUTION_SETTLE_FRAMES;
+	return (true);
+}
+
+/**
+ * initRenderResolution - function picks the first internal resolution
+ * @resolution: pointer to the render resolution
+ * @outputWidth: width of the window's drawable area in pixels
+ * @outputHeight: height of the window's drawable area in pixels
+ * @scale: fraction of the output width to render, 0 to follow the budget
+ * @budgetMs: render time per frame a dynamic scale aims to stay under
+ *
+ * A dynamic scale starts at full resolution and only drops once frames
+ * are measured over budget.
+ *
+ * Return: void
+ */
+void initRenderResolution(RenderResolution *resolution, int outputWidth, int outputHeight,
+		double scale, double budgetMs)
+{
+	resolution->outputWidth = SDL_max(outputWidth, 1);
+	resolution->outputHeight = SDL_max(outputHeight, 1);
+	resolution->dynamic = scale <= 0;
+	resolution->scale = resolution->dynamic ? 1 : SDL_clamp(scale, MIN_RENDER_SCALE, 1);
+	resolution->budgetMs = budgetMs;
+	resolution->width = resolution->height = 0;
+	applyScale(resolution);
+}
+
+/**
+ * setOutputSize - function follows the window to a new size
+ * @resolution: pointer to the render resolution
+ * @outputWidth: new width of the drawable area in pixels
+ * @outputHeight: new height of the drawable area in pixels
+ *
+ * The scale is kept, so the internal resolution changes with the output.
+ *
+ * Return: void
+ */
+void setOutputSize(RenderResolution *resolution, int outputWidth, int outputHeight)
+{
+	resolution->outputWidth = SDL_max(outputWidth, 1);
+	resolution->outputHeight = SDL_max(outputHeight, 1);
+	applyScale(resolution);
+}
+
+/**
+ * updateRenderResolution - function adjusts a dynamic scale to the frame time
+ * @resolution: pointer to the render resolution
+ * @renderMs: time the world took to render this frame, in ms
+ *
+ * Render time grows with the pixel count, so a frame over budget shrinks
+ * the width by the square root of how far over it is, aiming a little
+ * under. A frame well under budget grows it back by at most a tenth at a
+ * time, so the scale does not swing between two sizes.
+ *
+ * Return: true if the internal resolution changed, false otherwise
+ */
+bool updateRenderResolution(RenderResolution *resolution, double renderMs)
+{
+	double target = resolution->scale;
+
+	if (!resolution->dynamic)
+		return (false);
+	resolution->averageMs = resolution->averageMs > 0 ?
+		resolution->averageMs * 0.9 + renderMs * 0.1 : renderMs;
+	if (resolution->settle > 0)
+	{
+		resolution->settle--;
+		return (false);
+	}
+	if (resolution->averageMs > resolution->budgetMs)
+		target *= sqrt(resolution->budgetMs * 0.9 / resolution->averageMs);
+	else if (resolution->averageMs < resolution->budgetMs * 0.6)
+		target *= SDL_min(sqrt(resolution->budgetMs * 0.8 / resolution->averageMs), 1.1);
+	target = SDL_clamp(target, MIN_RENDER_SCALE, 1);
+	if (target == resolution->scale)
+		return (false);
+	resolution->scale = target;
+	return (applyScale(resolution));
+}
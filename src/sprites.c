@@ -0,0 +1,647 @@
+#include <math.h>
+#include "../header/sprites.h"
+#include "../header/rendering.h"
+#include "../header/camera.h"
+
+/*Strips of COLUMN_STRIP columns, for rejecting sprites hidden behind walls*/
+#define SPRITE_STRIPS ((MAX_RENDER_WIDTH + COLUMN_STRIP - 1) / COLUMN_STRIP)
+
+/*Art and proportions of a kind of sprite*/
+typedef struct {
+	const char *name;
+	const char *path; /* frame image, %d is replaced by the frame number */
+	int frames;
+	float fps;
+	float scale; /* height as a fraction of a wall's */
+	float lift;  /* gap between its feet and the floor, as a fraction of a wall */
+} SpriteKindInfo;
+
+static const SpriteKindInfo spriteKinds[SPRITE_KIND_COUNT] = {
+	{"candlebra", "./resources/sprites/static_sprites/candlebra.png", 1, 0, 0.7f, 0},
+	{"green_light", "./resources/sprites/animated_sprites/green_light/%d.png", 4, 8, 0.8f, 0},
+	{"red_light", "./resources/sprites/animated_sprites/red_light/%d.png", 4, 8, 0.8f, 0},
+	{"soldier", "./resources/sprites/npc/soldier/idle/%d.png", 8, 6, 0.6f, 0},
+	{"caco_demon", "./resources/sprites/npc/caco_demon/idle/%d.png", 8, 6, 0.7f, 0.15f},
+	{"cyber_demon", "./resources/sprites/npc/cyber_demon/idle/%d.png", 8, 6, 1.0f, 0}
+};
+
+/**
+ * createSpriteSet - function allocates an empty set of sprites
+ *
+ * Return: pointer to the set, or NULL on failure
+ */
+SpriteSet *createSpriteSet(void)
+{
+	SpriteSet *sprites = calloc(1, sizeof(SpriteSet));
+
+	if (!sprites)
+		fprintf(stderr, "Failed to allocate the sprite set\n");
+	return (sprites);
+}
+
+/**
+ * growSprites - function makes room for more sprites
+ * @sprites: pointer to the sprite set
+ * @capacity: sprites the arrays must hold
+ *
+ * Return: true on success, false if memory ran out
+ */
+static bool growSprites(SpriteSet *sprites, int capacity)
+{
+	float *x = realloc(sprites->x, capacity * sizeof(float));
+	float *y = x ? realloc(sprites->y, capacity * sizeof(float)) : NULL;
+	Uint8 *kind = y ? realloc(sprites->kind, capacity * sizeof(Uint8)) : NULL;
+	VisibleSprite *visible;
+	Uint32 *sortKeys;
+	int *order;
+
+	if (x)
+		sprites->x = x;
+	if (y)
+		sprites->y = y;
+	if (!kind)
+		return (false);
+	sprites->kind = kind;
+	/*Per frame arrays hold nothing between frames, so they need no copying*/
+	visible = malloc(capacity * sizeof(VisibleSprite));
+	sortKeys = malloc(capacity * 2 * sizeof(Uint32));
+	order = malloc(capacity * 2 * sizeof(int));
+	if (!visible || !sortKeys || !order)
+	{
+		free(visible);
+		free(sortKeys);
+		free(order);
+		return (false);
+	}
+	free(sprites->visible);
+	free(sprites->sortKeys);
+	free(sprites->order);
+	sprites->visible = visible;
+	sprites->sortKeys = sortKeys;
+	sprites->order = order;
+	sprites->capacity = capacity;
+	return (true);
+}
+
+/**
+ * addSprite - function places a sprite in the world
+ * @sprites: pointer to the sprite set
+ * @kind: kind of sprite
+ * @x: position on the x axis, in map cells
+ * @y: position on the y axis, in map cells
+ *
+ * Return: true on success, false if memory ran out
+ */
+bool addSprite(SpriteSet *sprites, SpriteKind kind, float x, float y)
+{
+	int i = sprites->count;
+
+	if (i == sprites->capacity && !growSprites(sprites, SDL_max(64, i * 2)))
+	{
+		fprintf(stderr, "Failed to allocate memory for %d sprites\n", i + 1);
+		return (false);
+	}
+	sprites->x[i] = x;
+	sprites->y[i] = y;
+	sprites->kind[i] = kind;
+	sprites->count++;
+	return (true);
+}
+
+/**
+ * removeSprite - function takes a sprite out of the world
+ * @sprites: pointer to the sprite set
+ * @i: index of the sprite
+ *
+ * The last sprite moves into the freed index.
+ *
+ * Return: void
+ */
+void removeSprite(SpriteSet *sprites, int i)
+{
+	int last = --sprites->count;
+
+	sprites->x[i] = sprites->x[last];
+	sprites->y[i] = sprites->y[last];
+	sprites->kind[i] = sprites->kind[last];
+}
+
+/**
+ * isOpenCell - function checks that a sprite may stand in a map cell
+ * @x: position on the x axis
+ * @y: position on the y axis
+ *
+ * Return: true if the cell is on the map and has no wall
+ */
+static bool isOpenCell(float x, float y)
+{
+	if (x < 0 || y < 0 || x >= worldMap.width || y >= worldMap.height)
+		return (false);
+	return (getMapCell(&worldMap, (int)x, (int)y) == 0);
+}
+
+/**
+ * loadSprites - function places the sprites listed in a file
+ * @sprites: pointer to the sprite set
+ * @path: file with one sprite per line as kind name, x and y
+ *
+ * Lines starting with # are comments. The file is written for
+ * resources/map.txt, so sprites that would stand off the current map or
+ * inside a wall are left out.
+ *
+ * Return: true on success, false if the file could not be read
+ */
+bool loadSprites(SpriteSet *sprites, const char *path)
+{
+	FILE *file = fopen(path, "r");
+	char line[128], name[32];
+	int lineNumber = 0;
+	float x, y;
+
+	if (!file)
+	{
+		fprintf(stderr, "Failed to open %s\n", path);
+		return (false);
+	}
+	while (fgets(line, sizeof(line), file))
+	{
+		int kind = 0;
+
+		lineNumber++;
+		if (line[0] == '#' || sscanf(line, "%31s", name) != 1)
+			continue;
+		while (kind < SPRITE_KIND_COUNT && strcmp(name, spriteKinds[kind].name) != 0)
+			kind++;
+		if (kind == SPRITE_KIND_COUNT || sscanf(line, "%*s %f %f", &x, &y) != 2)
+		{
+			fprintf(stderr, "%s:%d: expected a sprite kind, x and y\n", path, lineNumber);
+			continue;
+		}
+		if (isOpenCell(x, y) && !addSprite(sprites, kind, x, y))
+			break;
+	}
+	fclose(file);
+	return (true);
+}
+
+/**
+ * scatterSprites - function places sprites of random kinds in random open cells
+ * @sprites: pointer to the sprite set
+ * @count: number of sprites to add
+ * @seed: seed for rand(), the same seed places the same sprites
+ *
+ * Return: void
+ */
+void scatterSprites(SpriteSet *sprites, int count, unsigned int seed)
+{
+	srand(seed);
+	for (int i = 0; i < count; i++)
+	{
+		/*Give up on maps with hardly any open space*/
+		for (int attempt = 0; attempt < 64; attempt++)
+		{
+			float x = rand() % worldMap.width + 0.5f;
+			float y = rand() % worldMap.height + 0.5f;
+
+			if (!isOpenCell(x, y))
+				continue;
+			if (!addSprite(sprites, rand() % SPRITE_KIND_COUNT, x, y))
+				return;
+			break;
+		}
+	}
+}
+
+/**
+ * copyFrame - function scales a sprite frame into its place in the atlas
+ * @atlas: pointer to the atlas being built
+ * @pixels: the atlas' ARGB8888 pixels
+ * @source: the frame's ARGB8888 surface
+ * @rect: where the frame goes in the atlas
+ *
+ * Return: void
+ */
+static void copyFrame(SpriteAtlas *atlas, Uint32 *pixels, const SDL_Surface *source,
+		const SDL_Rect *rect)
+{
+	const int sourcePitch = source->pitch / sizeof(Uint32);
+
+	for (int y = 0; y < rect->h; y++)
+	{
+		const Uint32 *row = (const Uint32 *)source->pixels +
+			(size_t)(y * source->h / rect->h) * sourcePitch;
+
+		for (int x = 0; x < rect->w; x++)
+		{
+			Uint32 texel = row[x * source->w / rect->w];
+
+			pixels[(size_t)(rect->y + y) * atlas->width + rect->x + x] = texel;
+			atlas->columns[(size_t)(rect->x + x) * atlas->height + rect->y + y] = texel;
+		}
+	}
+}
+
+/**
+ * createSpriteAtlas - function packs every sprite frame into one texture
+ * @sprites: pointer to the sprite set receiving the atlas
+ * @textures: texture cache holding the decoded frames
+ *
+ * Frames are placed on shelves left to right, tall ones scaled down to
+ * SPRITE_FRAME_HEIGHT first, since a sprite rarely covers more rows than that.
+ *
+ * Return: true on success, false if a frame or the atlas could not be made
+ */
+bool createSpriteAtlas(SpriteSet *sprites, TextureCache *textures)
+{
+	SpriteAtlas *atlas = &sprites->atlas;
+	TextureData frames[SPRITE_KIND_COUNT][SPRITE_FRAMES_MAX] = {{{0}}};
+	char paths[SPRITE_KIND_COUNT][SPRITE_FRAMES_MAX][128];
+	int x = 0, y = 0, rowHeight = 0;
+	SDL_Surface *surface = NULL;
+	bool loaded = true;
+
+	for (int kind = 0; kind < SPRITE_KIND_COUNT; kind++)
+	{
+		for (int f = 0; f < spriteKinds[kind].frames; f++)
+		{
+			SDL_Rect *rect = &atlas->frames[kind][f];
+
+			snprintf(paths[kind][f], sizeof(paths[kind][f]), spriteKinds[kind].path, f);
+			frames[kind][f] = acquireTexture(textures, paths[kind][f]);
+			if (!frames[kind][f].surface)
+			{
+				loaded = false;
+				continue;
+			}
+			rect->h = SDL_min(frames[kind][f].height, SPRITE_FRAME_HEIGHT);
+			rect->w = SDL_max(1, frames[kind][f].width * rect->h / frames[kind][f].height);
+			if (x + rect->w > SPRITE_ATLAS_WIDTH)
+			{
+				x = 0;
+				y += rowHeight;
+				rowHeight = 0;
+			}
+			rect->x = x;
+			rect->y = y;
+			x += rect->w;
+			rowHeight = SDL_max(rowHeight, rect->h);
+		}
+	}
+	atlas->width = SPRITE_ATLAS_WIDTH;
+	atlas->height = y + rowHeight;
+	if (loaded)
+	{
+		surface = SDL_CreateRGBSurfaceWithFormat(0, atlas->width, atlas->height, 32,
+				SDL_PIXELFORMAT_ARGB8888);
+		atlas->columns = calloc((size_t)atlas->width * atlas->height, sizeof(Uint32));
+	}
+	if (surface && atlas->columns)
+	{
+		/*New surfaces are zeroed, so the gaps between frames are transparent*/
+		for (int kind = 0; kind < SPRITE_KIND_COUNT; kind++)
+			for (int f = 0; f < spriteKinds[kind].frames; f++)
+				copyFrame(atlas, surface->pixels, frames[kind][f].surface,
+						&atlas->frames[kind][f]);
+		atlas->texture = SDL_CreateTextureFromSurface(textures->renderer, surface);
+		if (atlas->texture)
+			SDL_SetTextureBlendMode(atlas->texture, SDL_BLENDMODE_BLEND);
+	}
+	/*The atlas has its own copy, so the cache may evict the frames*/
+	for (int kind = 0; kind < SPRITE_KIND_COUNT; kind++)
+		for (int f = 0; f < spriteKinds[kind].frames; f++)
+			if (frames[kind][f].surface)
+				releaseTexture(textures, paths[kind][f]);
+	SDL_FreeSurface(surface);
+	if (!atlas->texture)
+	{
+		fprintf(stderr, "Failed to build the sprite atlas: %s\n", SDL_GetError());
+		free(atlas->columns);
+		atlas->columns = NULL;
+		return (false);
+	}
+	return (true);
+}
+
+/**
+ * sortFarToNear - function orders the visible sprites by decreasing depth
+ * @sprites: pointer to the sprite set, with sortKeys and order filled in
+ *
+ * Least significant digit radix sort on the keys, a byte at a time.
+ * Passes where every key has the same byte, usually the top ones, are
+ * skipped.
+ *
+ * Return: void
+ */
+static void sortFarToNear(SpriteSet *sprites)
+{
+	const int count = sprites->visibleCount;
+	Uint32 *keys = sprites->sortKeys, *keysOut = keys + sprites->capacity;
+	int *order = sprites->order, *orderOut = order + sprites->capacity;
+
+	for (int shift = 0; shift < 32 && count > 1; shift += 8)
+	{
+		int offsets[256] = {0}, total = 0;
+
+		for (int i = 0; i < count; i++)
+			offsets[(keys[i] >> shift) & 0xFF]++;
+		if (offsets[(keys[0] >> shift) & 0xFF] == count)
+			continue;
+		for (int digit = 0; digit < 256; digit++)
+		{
+			int bucket = offsets[digit];
+
+			offsets[digit] = total;
+			total += bucket;
+		}
+		for (int i = 0; i < count; i++)
+		{
+			int slot = offsets[(keys[i] >> shift) & 0xFF]++;
+
+			keysOut[slot] = keys[i];
+			orderOut[slot] = order[i];
+		}
+		/*This pass' output is the next pass' input*/
+		Uint32 *swapKeys = keys;
+		int *swapOrder = order;
+
+		keys = keysOut;
+		keysOut = swapKeys;
+		order = orderOut;
+		orderOut = swapOrder;
+	}
+	if (order != sprites->order)
+		memcpy(sprites->order, order, count * sizeof(int));
+}
+
+/**
+ * prepareSprites - function finds the sprites to draw this frame
+ * @sprites: pointer to the sprite set
+ * @seconds: game time, for animation
+ * @posX: player position on the x axis
+ * @posY: player position on the y axis
+ * @dirX: player direction on the x axis
+ * @dirY: player direction on the y axis
+ * @planeX: camera plane on the x axis
+ * @planeY: camera plane on the y axis
+ *
+ * Call after the walls are drawn: sprites behind the camera, off the
+ * sides of the screen, or farther than the walls of every column strip
+ * they cover are culled, using columnHits. The rest are sorted far to near.
+ *
+ * Return: void
+ */
+void prepareSprites(SpriteSet *sprites, double seconds, double posX, double posY,
+		double dirX, double dirY, double planeX, double planeY)
+{
+	const SpriteAtlas *atlas = &sprites->atlas;
+	/*Inverse of the camera matrix [planeX dirX; planeY dirY]*/
+	const double invDet = 1.0 / (planeX * dirY - dirX * planeY);
+	const int screenWidth = cameraTables.width;
+	const float screenHeight = (float)cameraTables.height;
+	float farthest[SPRITE_STRIPS] = {0};
+	int visibleCount = 0;
+
+	sprites->visibleCount = 0;
+	if (!atlas->texture)
+		return;
+	for (int x = 0; x < screenWidth; x++)
+		farthest[x / COLUMN_STRIP] = SDL_max(farthest[x / COLUMN_STRIP],
+				(float)columnHits[x].perpWallDist);
+
+	for (int i = 0; i < sprites->count; i++)
+	{
+		const SpriteKindInfo *info = &spriteKinds[sprites->kind[i]];
+		double dx = sprites->x[i] - posX, dy = sprites->y[i] - posY;
+		float depth = (float)(invDet * (planeX * dy - planeY * dx));
+		float side, height, width, left;
+		const SDL_Rect *frame;
+		int first, last, strip;
+		union { float f; Uint32 u; } key;
+
+		if (depth < SPRITE_NEAR)
+			continue;
+		side = (float)(invDet * (dirY * dx - dirX * dy));
+		/*Sprites of a kind start their animation a frame apart*/
+		frame = &atlas->frames[sprites->kind[i]][info->frames > 1 ?
+			((int)(seconds * info->fps) + i) % info->frames : 0];
+		height = screenHeight / depth * info->scale;
+		width = height * frame->w / frame->h;
+		left = screenWidth / 2 * (1 + side / depth) - width / 2;
+		/*Columns whose centre the sprite covers*/
+		first = SDL_max(0, (int)ceilf(left - 0.5f));
+		last = SDL_min(screenWidth - 1, (int)ceilf(left + width - 0.5f) - 1);
+		if (first > last)
+			continue;
+		strip = first / COLUMN_STRIP;
+		while (strip <= last / COLUMN_STRIP && farthest[strip] <= depth)
+			strip++;
+		if (strip > last / COLUMN_STRIP)
+			continue;
+
+		VisibleSprite *visible = &sprites->visible[visibleCount];
+
+		visible->depth = depth;
+		visible->left = left;
+		/*Feet on the floor, which meets a wall this far away halfway down its slice*/
+		visible->top = (int)screenHeight / 2 + (0.5f - info->lift) * screenHeight / depth - height;
+		visible->width = width;
+		visible->height = height;
+		visible->first = first;
+		visible->last = last;
+		visible->frame = frame;
+		/*Positive floats sort like their bits; inverting them puts the far ones first*/
+		key.f = depth;
+		sprites->sortKeys[visibleCount] = ~key.u;
+		sprites->order[visibleCount] = visibleCount;
+		visibleCount++;
+	}
+	sprites->visibleCount = visibleCount;
+	sortFarToNear(sprites);
+}
+
+/**
+ * growQuads - function enlarges the geometry buffers of drawSprites
+ * @sprites: pointer to the sprite set
+ *
+ * Return: true on success, false if memory ran out
+ */
+static bool growQuads(SpriteSet *sprites)
+{
+	int capacity = SDL_max(256, sprites->quadCapacity * 2);
+	SDL_Vertex *vertices = realloc(sprites->vertices, capacity * 4 * sizeof(SDL_Vertex));
+	int *indices = vertices ? realloc(sprites->indices, capacity * 6 * sizeof(int)) : NULL;
+
+	if (vertices)
+		sprites->vertices = vertices;
+	if (!indices)
+		return (false);
+	sprites->indices = indices;
+	/*Two triangles per quad*/
+	for (int i = sprites->quadCapacity; i < capacity; i++)
+	{
+		int *quad = indices + i * 6;
+
+		quad[0] = i * 4;
+		quad[1] = i * 4 + 1;
+		quad[2] = i * 4 + 2;
+		quad[3] = i * 4 + 2;
+		quad[4] = i * 4 + 1;
+		quad[5] = i * 4 + 3;
+	}
+	sprites->quadCapacity = capacity;
+	return (true);
+}
+
+/**
+ * drawSprites - function draws the visible sprites over SDL rendered walls
+ * @sprites: pointer to the sprite set, after prepareSprites
+ * @renderer: SDL renderer pointer
+ *
+ * Each sprite is split into runs of columns where it is nearer than the
+ * wall, and every run becomes one textured quad. All quads, far to near,
+ * go to the GPU in a single SDL_RenderGeometry call on the atlas.
+ *
+ * Return: void
+ */
+void drawSprites(SpriteSet *sprites, SDL_Renderer *renderer)
+{
+	const SpriteAtlas *atlas = &sprites->atlas;
+	const SDL_Color white = {255, 255, 255, 255};
+	int quads = 0;
+
+	for (int n = 0; n < sprites->visibleCount; n++)
+	{
+		const VisibleSprite *s = &sprites->visible[sprites->order[n]];
+		const float texelsPerPixel = s->frame->w / s->width;
+		float v0 = (float)s->frame->y / atlas->height;
+		float v1 = (float)(s->frame->y + s->frame->h) / atlas->height;
+		int x = s->first;
+
+		while (x <= s->last)
+		{
+			int start;
+
+			/*Skip the columns where a wall is in front*/
+			while (x <= s->last && columnHits[x].perpWallDist <= s->depth)
+				x++;
+			start = x;
+			while (x <= s->last && columnHits[x].perpWallDist > s->depth)
+				x++;
+			if (start == x)
+				continue;
+			if (quads == sprites->quadCapacity && !growQuads(sprites))
+				break;
+
+			SDL_Vertex *v = sprites->vertices + quads++ * 4;
+			float u0 = (s->frame->x + (start - s->left) * texelsPerPixel) / atlas->width;
+			float u1 = (s->frame->x + (x - s->left) * texelsPerPixel) / atlas->width;
+			float bottom = s->top + s->height;
+
+			v[0] = (SDL_Vertex){{start, s->top}, white, {u0, v0}};
+			v[1] = (SDL_Vertex){{x, s->top}, white, {u1, v0}};
+			v[2] = (SDL_Vertex){{start, bottom}, white, {u0, v1}};
+			v[3] = (SDL_Vertex){{x, bottom}, white, {u1, v1}};
+		}
+	}
+	if (quads > 0)
+		SDL_RenderGeometry(renderer, atlas->texture, sprites->vertices, quads * 4,
+				sprites->indices, quads * 6);
+}
+
+/*Everything a worker needs to draw sprites over its strip of columns*/
+typedef struct {
+	const SpriteSet *sprites;
+	Framebuffer *fb;
+} SpriteJob;
+
+/**
+ * drawSpriteColumns - function draws the visible sprites over a strip of columns
+ * @context: pointer to the SpriteJob
+ * @begin: first column of the strip
+ * @end: one past the last column of the strip
+ *
+ * Sprites are painted far to near, skipping columns where the wall is
+ * closer and texels that are mostly transparent.
+ *
+ * Return: void
+ */
+static void drawSpriteColumns(void *context, int begin, int end)
+{
+	const SpriteJob *job = context;
+	const SpriteSet *sprites = job->sprites;
+	const SpriteAtlas *atlas = &sprites->atlas;
+	Framebuffer *fb = job->fb;
+
+	for (int n = 0; n < sprites->visibleCount; n++)
+	{
+		const VisibleSprite *s = &sprites->visible[sprites->order[n]];
+		const SDL_Rect *frame = s->frame;
+		int first = SDL_max(s->first, begin), last = SDL_min(s->last, end - 1);
+		int top = SDL_max(0, (int)ceilf(s->top - 0.5f));
+		int bottom = SDL_min(fb->height, (int)ceilf(s->top + s->height - 0.5f));
+		/*Texel rows per screen row, in 16.16 fixed point*/
+		Uint32 step = (Uint32)(frame->h / s->height * 65536);
+		Uint32 start = (Uint32)((top + 0.5f - s->top) * frame->h / s->height * 65536);
+		int lastRow = frame->h - 1;
+
+		for (int x = first; x <= last; x++)
+		{
+			Uint32 *dst = fb->pixels + x;
+			Uint32 texPos = start;
+			int texX;
+			const Uint32 *column;
+
+			if (fb->depth[x] <= s->depth)
+				continue;
+			texX = SDL_min(frame->w - 1, (int)((x + 0.5f - s->left) * frame->w / s->width));
+			column = atlas->columns + (size_t)(frame->x + texX) * atlas->height + frame->y;
+			for (int y = top; y < bottom; y++, texPos += step)
+			{
+				Uint32 texel = column[SDL_min((int)(texPos >> 16), lastRow)];
+
+				if (texel & 0x80000000)
+					dst[y * fb->width] = texel;
+			}
+		}
+	}
+}
+
+/**
+ * drawSpritesSoftware - function draws the visible sprites into the framebuffer
+ * @sprites: pointer to the sprite set, after prepareSprites
+ * @fb: framebuffer holding the walls and their per-column depth
+ * @pool: worker threads sharing the columns, or NULL for the caller only
+ *
+ * Return: void
+ */
+void drawSpritesSoftware(SpriteSet *sprites, Framebuffer *fb, ThreadPool *pool)
+{
+	SpriteJob job = {sprites, fb};
+
+	if (sprites->visibleCount > 0)
+		runParallel(pool, fb->width, COLUMN_STRIP, drawSpriteColumns, &job);
+}
+
+/**
+ * destroySpriteSet - function frees the sprites and their atlas
+ * @sprites: pointer to the sprite set, may be NULL
+ *
+ * Return: void
+ */
+void destroySpriteSet(SpriteSet *sprites)
+{
+	if (!sprites)
+		return;
+	if (sprites->atlas.texture)
+		SDL_DestroyTexture(sprites->atlas.texture);
+	free(sprites->atlas.columns);
+	free(sprites->x);
+	free(sprites->y);
+	free(sprites->kind);
+	free(sprites->visible);
+	free(sprites->sortKeys);
+	free(sprites->order);
+	free(sprites->vertices);
+	free(sprites->indices);
+	free(sprites);
+}
@@ -0,0 +1,252 @@
+#include "../header/texture_cache.h"
+#include "../header/textures.h"
+
+/**
+ * hashPath - function hashes a path with FNV-1a
+ * @path: path to hash
+ *
+ * Return: bucket index for the path
+ */
+static unsigned int hashPath(const char *path)
+{
+	Uint32 hash = 2166136261u;
+
+	for (; *path; path++)
+		hash = (hash ^ (unsigned char)*path) * 16777619u;
+	return (hash % TEXTURE_CACHE_BUCKETS);
+}
+
+/**
+ * findEntry - function looks up a cached path
+ * @cache: pointer to the texture cache
+ * @path: path of the image
+ *
+ * Return: pointer to the entry, or NULL if the path is not cached
+ */
+static CachedTexture *findEntry(const TextureCache *cache, const char *path)
+{
+	CachedTexture *entry = cache->buckets[hashPath(path)];
+
+	while (entry && strcmp(entry->path, path) != 0)
+		entry = entry->next;
+	return (entry);
+}
+
+/**
+ * freeEntry - function unlinks an entry and releases its memory
+ * @cache: pointer to the texture cache
+ * @entry: pointer to the entry
+ *
+ * Return: void
+ */
+static void freeEntry(TextureCache *cache, CachedTexture *entry)
+{
+	CachedTexture **link = &cache->buckets[hashPath(entry->path)];
+
+	while (*link != entry)
+		link = &(*link)->next;
+	*link = entry->next;
+	cache->stats.entries--;
+	cache->stats.surfaceBytes -= entry->surfaceBytes;
+	cache->stats.textureBytes -= entry->textureBytes;
+	freeTextureData(&entry->data);
+	free(entry->path);
+	free(entry);
+}
+
+/**
+ * evictToBudget - function frees unused entries until the cache fits its budget
+ * @cache: pointer to the texture cache
+ *
+ * Entries still referenced are never evicted, so the cache can stay over
+ * budget if everything in it is in use.
+ *
+ * Return: void
+ */
+static void evictToBudget(TextureCache *cache)
+{
+	CachedTexture *oldest;
+
+	while (cache->stats.surfaceBytes + cache->stats.textureBytes > cache->budget)
+	{
+		oldest = NULL;
+		for (int i = 0; i < TEXTURE_CACHE_BUCKETS; i++)
+		{
+			for (CachedTexture *entry = cache->buckets[i]; entry; entry = entry->next)
+			{
+				if (entry->refCount == 0 && (!oldest || entry->lastUse < oldest->lastUse))
+					oldest = entry;
+			}
+		}
+		if (!oldest)
+			return;
+		freeEntry(cache, oldest);
+		cache->stats.evictions++;
+	}
+}
+
+/**
+ * addEntry - function uploads decoded pixels and caches them under a path
+ * @cache: pointer to the texture cache
+ * @path: path of the image
+ * @surface: ARGB8888 pixels, owned by the cache from now on
+ *
+ * Return: pointer to the new entry, or NULL on failure
+ */
+static CachedTexture *addEntry(TextureCache *cache, const char *path, SDL_Surface *surface)
+{
+	CachedTexture *entry = calloc(1, sizeof(CachedTexture));
+	unsigned int bucket = hashPath(path);
+
+	if (entry)
+		entry->path = strdup(path);
+	if (!entry || !entry->path)
+	{
+		free(entry);
+		SDL_FreeSurface(surface);
+		return (NULL);
+	}
+	entry->data = uploadTextureData(surface, cache->renderer);
+	entry->surfaceBytes = (size_t)surface->pitch * surface->h;
+	entry->textureBytes = entry->data.texture ? (size_t)surface->w * surface->h * 4 : 0;
+	entry->lastUse = ++cache->clock;
+	entry->next = cache->buckets[bucket];
+	cache->buckets[bucket] = entry;
+	cache->stats.entries++;
+	cache->stats.surfaceBytes += entry->surfaceBytes;
+	cache->stats.textureBytes += entry->textureBytes;
+	return (entry);
+}
+
+/**
+ * createTextureCache - function creates an empty texture cache
+ * @renderer: SDL renderer the textures are created for
+ * @budget: bytes of pixels and textures to keep before evicting
+ *
+ * Return: pointer to the cache, or NULL on failure
+ */
+TextureCache *createTextureCache(SDL_Renderer *renderer, size_t budget)
+{
+	TextureCache *cache = calloc(1, sizeof(TextureCache));
+
+	if (!cache)
+		return (NULL);
+	cache->renderer = renderer;
+	cache->budget = budget;
+	return (cache);
+}
+
+/**
+ * acquireTexture - function gets the texture for a path, loading it if needed
+ * @cache: pointer to the texture cache
+ * @path: path of the image
+ *
+ * Every acquire must be matched by a releaseTexture once the caller no
+ * longer uses the result; until then the texture cannot be evicted.
+ *
+ * Return: texture data, owned by the cache, empty if the image failed to load
+ */
+TextureData acquireTexture(TextureCache *cache, const char *path)
+{
+	TextureData empty = {NULL, NULL, 0, 0};
+	CachedTexture *entry = findEntry(cache, path);
+	SDL_Surface *surface;
+
+	if (entry)
+		cache->stats.hits++;
+	else
+	{
+		cache->stats.misses++;
+		surface = decodeTextureSurface(path);
+		if (!surface || !(entry = addEntry(cache, path, surface)))
+			return (empty);
+	}
+	entry->refCount++;
+	entry->lastUse = ++cache->clock;
+	evictToBudget(cache);
+	return (entry->data);
+}
+
+/**
+ * releaseTexture - function drops a reference taken by acquireTexture
+ * @cache: pointer to the texture cache
+ * @path: path the texture was acquired with
+ *
+ * The texture stays cached, unreferenced, until the budget needs its space.
+ *
+ * Return: void
+ */
+void releaseTexture(TextureCache *cache, const char *path)
+{
+	CachedTexture *entry = findEntry(cache, path);
+
+	if (!entry || entry->refCount == 0)
+	{
+		fprintf(stderr, "Texture %s released more often than acquired\n", path);
+		return;
+	}
+	entry->refCount--;
+	evictToBudget(cache);
+}
+
+/**
+ * insertTexture - function caches pixels decoded ahead of time, unreferenced
+ * @cache: pointer to the texture cache
+ * @path: path the pixels were decoded from
+ * @surface: ARGB8888 pixels, owned by the cache from now on
+ *
+ * Used by the asset loader so a later acquireTexture is a hit. Pixels for
+ * a path that is already cached are dropped.
+ *
+ * Return: true if the texture was added, false otherwise
+ */
+bool insertTexture(TextureCache *cache, const char *path, SDL_Surface *surface)
+{
+	if (findEntry(cache, path))
+	{
+		SDL_FreeSurface(surface);
+		return (false);
+	}
+	if (!addEntry(cache, path, surface))
+		return (false);
+	evictToBudget(cache);
+	return (true);
+}
+
+/**
+ * printTextureCacheStats - function writes the cache counters
+ * @cache: pointer to the texture cache
+ * @out: stream to write to
+ *
+ * Return: void
+ */
+void printTextureCacheStats(const TextureCache *cache, FILE *out)
+{
+	const TextureCacheStats *stats = &cache->stats;
+	const double mb = 1024.0 * 1024.0;
+
+	fprintf(out, "Texture cache: %llu hits, %llu misses, %llu evictions, "
+			"%d textures, %.1f MB resident (%.1f MB pixels, %.1f MB GPU) of %.1f MB\n",
+			(unsigned long long)stats->hits, (unsigned long long)stats->misses,
+			(unsigned long long)stats->evictions, stats->entries,
+			(stats->surfaceBytes + stats->textureBytes) / mb,
+			stats->surfaceBytes / mb, stats->textureBytes / mb, cache->budget / mb);
+}
+
+/**
+ * destroyTextureCache - function frees every cached texture
+ * @cache: pointer to the texture cache, may be NULL
+ *
+ * Return: void
+ */
+void destroyTextureCache(TextureCache *cache)
+{
+	if (!cache)
+		return;
+	for (int i = 0; i < TEXTURE_CACHE_BUCKETS; i++)
+	{
+		while (cache->buckets[i])
+			freeEntry(cache, cache->buckets[i]);
+	}
+	free(cache);
+}
@@ -22,18 +22,305 @@ SDL_Texture* loadTexture(const char* path, SDL_Renderer* renderer)
 }
 
 
+/**
+ * decodeTextureSurface - function decodes an image into ARGB8888 pixels
+ * @file: path to the image file
+ *
+ * Needs no renderer, so asset loader threads can call it.
+ *
+ * Return: pointer to the surface, or NULL on failure
+ */
+SDL_Surface* decodeTextureSurface(const char* file)
+{
+    SDL_Surface* loaded = IMG_Load(file);
+    SDL_Surface* converted;
+
+    if (!loaded)
+    {
+        fprintf(stderr, "IMG_Load error for %s: %s\n", file, IMG_GetError());
+        return NULL;
+    }
+    /*Convert once so every texel is a single Uint32*/
+    converted = SDL_ConvertSurfaceFormat(loaded, SDL_PIXELFORMAT_ARGB8888, 0);
+    SDL_FreeSurface(loaded);
+
+    if (!converted)
+        fprintf(stderr, "SDL_ConvertSurfaceFormat error: %s\n", SDL_GetError());
+    return converted;
+}
+
+/**
+ * uploadTextureData - function creates the GPU texture for decoded pixels
+ * @surface: ARGB8888 surface from decodeTextureSurface, owned by the result
+ * @renderer: SDL renderer pointer, used on the render thread only
+ *
+ * Return: texture data with its dimensions
+ */
+TextureData uploadTextureData(SDL_Surface* surface, SDL_Renderer* renderer)
+{
+    TextureData texData = {NULL, surface, surface->w, surface->h};
+
+    texData.texture = SDL_CreateTextureFromSurface(renderer, surface);
+    if (!texData.texture)
+        fprintf(stderr, "SDL_CreateTextureFromSurface error: %s\n", SDL_GetError());
+    return texData;
+}
+
 /**
  * loadTextureWithDimensions - function to load textures and get their dimensions
  * @file: path to the texture file
  * @renderer: SDL renderer pointer
- * 
- * Return: pointer to the texture
+ *
+ * The decoded pixels are kept in ARGB8888 so the software renderer
+ * can sample them without reading back from the GPU.
+ *
+ * Return: texture data with its dimensions
  */
 TextureData loadTextureWithDimensions(const char* file, SDL_Renderer* renderer)
 {
-    /*Load texture and get dimensions*/
-    TextureData texData;
-    texData.texture = loadTexture(file, renderer);
-    SDL_QueryTexture(texData.texture, NULL, NULL, &texData.width, &texData.height);
-    return texData;
+    TextureData texData = {NULL, NULL, 0, 0};
+    SDL_Surface* surface = decodeTextureSurface(file);
+
+    if (!surface)
+        return texData;
+    return uploadTextureData(surface, renderer);
+}
+
+/**
+ * freeTextureData - function to release a texture and its pixels
+ * @texData: pointer to the texture data
+ *
+ * Return: void
+ */
+void freeTextureData(TextureData* texData)
+{
+    SDL_DestroyTexture(texData->texture);
+    SDL_FreeSurface(texData->surface);
+    texData->texture = NULL;
+    texData->surface = NULL;
+}
+
+/**
+ * ceilShift - function finds the smallest power of two holding a size
+ * @size: size in texels
+ *
+ * Return: log2 of the power of two
+ */
+static int ceilShift(int size)
+{
+    int shift = 0;
+
+    while ((1 << shift) < size)
+        shift++;
+    return shift;
+}
+
+/**
+ * floorShift - function finds the largest power of two not above a size
+ * @size: size in texels, at least 1
+ *
+ * Return: log2 of the power of two
+ */
+static int floorShift(int size)
+{
+    int shift = 0;
+
+    while ((2 << shift) <= size)
+        shift++;
+    return shift;
+}
+
+/**
+ * reduceAtlasLevel - function fills a level of the wall atlas from the one above it
+ * @atlas: pointer to the atlas, with the level above filled in
+ * @level: level to fill, 1 or more
+ *
+ * Every texel averages a 2x2 block of the level above. Slots are powers
+ * of two, so no block straddles two textures.
+ *
+ * Return: void
+ */
+static void reduceAtlasLevel(WallAtlas* atlas, int level)
+{
+    const int columns = WALL_TEXTURE_COUNT << (atlas->widthShift - level);
+    const int heightShift = atlas->heightShift - level;
+    const Uint32* src = atlas->texels + atlas->levelOffset[level - 1];
+    Uint32* dst = atlas->texels + atlas->levelOffset[level];
+
+    for (int x = 0; x < columns; x++)
+    {
+        const Uint32* left = src + ((size_t)(2 * x) << (heightShift + 1));
+        const Uint32* right = left + ((size_t)1 << (heightShift + 1));
+        Uint32* column = dst + ((size_t)x << heightShift);
+
+        for (int y = 0; y < 1 << heightShift; y++)
+            column[y] = averageTexels(left[2 * y], left[2 * y + 1],
+                    right[2 * y], right[2 * y + 1]);
+    }
+}
+
+/**
+ * createWallAtlas - function packs the wall textures for the software renderer
+ * @atlas: pointer to the atlas to fill in
+ * @wallTextures: the WALL_TEXTURE_COUNT loaded wall textures
+ *
+ * Every texture gets a slot as large as the largest one, rounded up to
+ * powers of two, and is copied in transposed so that walking down a wall
+ * slice walks through consecutive texels. Padding and textures that failed
+ * to load stay black. The mip levels follow, until the slots are a texel
+ * wide or tall.
+ *
+ * Return: true on success, false if the atlas could not be allocated
+ */
+bool createWallAtlas(WallAtlas* atlas, const TextureData wallTextures[])
+{
+    /*Copy in blocks so that neither the reads nor the writes stride through memory*/
+    const int block = 16;
+    int maxWidth = 1, maxHeight = 1;
+    size_t total = 0;
+
+    for (int i = 0; i < WALL_TEXTURE_COUNT; i++)
+    {
+        atlas->width[i] = wallTextures[i].surface ? wallTextures[i].width : 1;
+        atlas->height[i] = wallTextures[i].surface ? wallTextures[i].height : 1;
+        maxWidth = SDL_max(maxWidth, atlas->width[i]);
+        maxHeight = SDL_max(maxHeight, atlas->height[i]);
+    }
+    atlas->widthShift = ceilShift(maxWidth);
+    atlas->heightShift = ceilShift(maxHeight);
+    atlas->levelCount = SDL_min(SDL_min(atlas->widthShift, atlas->heightShift) + 1,
+            WALL_MAX_LEVELS);
+    for (int level = 0; level < atlas->levelCount; level++)
+    {
+        atlas->levelOffset[level] = total;
+        total += (size_t)WALL_TEXTURE_COUNT << (atlas->widthShift + atlas->heightShift - 2 * level);
+    }
+    /*A texture smaller than its slot ends before the slot does*/
+    for (int i = 0; i < WALL_TEXTURE_COUNT; i++)
+        atlas->textureLevels[i] = SDL_min(SDL_min(floorShift(atlas->width[i]),
+                    floorShift(atlas->height[i])) + 1, atlas->levelCount);
+    atlas->texels = calloc(total, sizeof(Uint32));
+    if (!atlas->texels)
+    {
+        fprintf(stderr, "Failed to allocate the %dx%d wall atlas\n",
+                1 << atlas->widthShift, 1 << atlas->heightShift);
+        return false;
+    }
+
+    for (int i = 0; i < WALL_TEXTURE_COUNT; i++)
+    {
+        const SDL_Surface* surface = wallTextures[i].surface;
+
+        if (!surface)
+            continue;
+        for (int by = 0; by < surface->h; by += block)
+        {
+            for (int bx = 0; bx < surface->w; bx += block)
+            {
+                for (int x = bx; x < SDL_min(bx + block, surface->w); x++)
+                {
+                    Uint32* column = (Uint32*)getAtlasColumn(atlas, 0, i, x);
+                    const Uint8* pixels = (const Uint8*)surface->pixels + x * sizeof(Uint32);
+
+                    for (int y = by; y < SDL_min(by + block, surface->h); y++)
+                        column[y] = *(const Uint32*)(pixels + y * surface->pitch);
+                }
+            }
+        }
+    }
+    for (int level = 1; level < atlas->levelCount; level++)
+        reduceAtlasLevel(atlas, level);
+    return true;
+}
+
+/**
+ * destroyWallAtlas - function releases the wall atlas
+ * @atlas: pointer to the atlas
+ *
+ * Return: void
+ */
+void destroyWallAtlas(WallAtlas* atlas)
+{
+    free(atlas->texels);
+    atlas->texels = NULL;
+}
+
+/**
+ * createWallMipmaps - function uploads the wall atlas' mip levels for the SDL renderer
+ * @mipmaps: pointer to the mipmaps to fill in
+ * @atlas: pointer to the atlas holding the levels
+ * @wallTextures: the loaded wall textures, used as level 0
+ * @renderer: SDL renderer pointer
+ *
+ * Return: true on success, false otherwise
+ */
+bool createWallMipmaps(WallMipmaps* mipmaps, const WallAtlas* atlas,
+        const TextureData wallTextures[], SDL_Renderer* renderer)
+{
+    /*Level 1 of the largest texture is the largest level uploaded*/
+    Uint32* pixels = malloc(sizeof(Uint32) << SDL_max(atlas->widthShift + atlas->heightShift - 2, 0));
+
+    memset(mipmaps, 0, sizeof(WallMipmaps));
+    if (!pixels)
+    {
+        fprintf(stderr, "Failed to allocate the wall mip levels\n");
+        return false;
+    }
+    for (int i = 0; i < WALL_TEXTURE_COUNT; i++)
+    {
+        mipmaps->levels[i][0] = wallTextures[i].texture;
+        mipmaps->width[i] = atlas->width[i];
+        mipmaps->height[i] = atlas->height[i];
+        mipmaps->levelCount[i] = wallTextures[i].texture ? atlas->textureLevels[i] : 1;
+        for (int level = 1; level < mipmaps->levelCount[i]; level++)
+        {
+            const int width = atlas->width[i] >> level, height = atlas->height[i] >> level;
+            SDL_Texture* texture;
+
+            /*Back from the atlas' columns into rows*/
+            for (int x = 0; x < width; x++)
+            {
+                const Uint32* column = getAtlasColumn(atlas, level, i, x);
+
+                for (int y = 0; y < height; y++)
+                    pixels[y * width + x] = column[y];
+            }
+            texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888,
+                    SDL_TEXTUREACCESS_STATIC, width, height);
+            if (!texture || SDL_UpdateTexture(texture, NULL, pixels, width * sizeof(Uint32)) != 0)
+            {
+                fprintf(stderr, "Wall mip level creation failed: %s\n", SDL_GetError());
+                if (texture)
+                    SDL_DestroyTexture(texture);
+                mipmaps->levelCount[i] = level;
+                free(pixels);
+                destroyWallMipmaps(mipmaps);
+                return false;
+            }
+            mipmaps->levels[i][level] = texture;
+        }
+    }
+    free(pixels);
+    return true;
+}
+
+/**
+ * destroyWallMipmaps - function releases the mip levels made by createWallMipmaps
+ * @mipmaps: pointer to the mipmaps
+ *
+ * Level 0 belongs to the caller and is left alone.
+ *
+ * Return: void
+ */
+void destroyWallMipmaps(WallMipmaps* mipmaps)
+{
+    for (int i = 0; i < WALL_TEXTURE_COUNT; i++)
+    {
+        for (int level = 1; level < mipmaps->levelCount[i]; level++)
+        {
+            SDL_DestroyTexture(mipmaps->levels[i][level]);
+            mipmaps->levels[i][level] = NULL;
+        }
+        mipmaps->levelCount[i] = 0;
+    }
 }
@@ -0,0 +1,160 @@
+#include "../header/threadpool.h"
+
+/**
+ * drainJob - function claims chunks of the current job until none are left
+ * @pool: pointer to the thread pool
+ *
+ * Chunks are handed out from a shared counter, so a thread that drew cheap
+ * items simply comes back for more while another is still busy.
+ *
+ * Return: void
+ */
+static void drainJob(ThreadPool *pool)
+{
+	int begin, end;
+
+	for (;;)
+	{
+		begin = SDL_AtomicAdd(&pool->next, pool->grain);
+		if (begin >= pool->count)
+			break;
+		end = begin + pool->grain;
+		if (end > pool->count)
+			end = pool->count;
+		pool->job(pool->context, begin, end);
+	}
+}
+
+/**
+ * workerMain - function runs on every worker thread for the pool lifetime
+ * @data: pointer to the thread pool
+ *
+ * Return: 0 when the pool shuts down
+ */
+static int workerMain(void *data)
+{
+	ThreadPool *pool = data;
+	int seen = 0;
+
+	SDL_LockMutex(pool->lock);
+	for (;;)
+	{
+		while (!pool->quit && pool->generation == seen)
+			SDL_CondWait(pool->wake, pool->lock);
+		if (pool->quit)
+			break;
+		seen = pool->generation;
+		SDL_UnlockMutex(pool->lock);
+
+		drainJob(pool);
+
+		SDL_LockMutex(pool->lock);
+		if (--pool->busyWorkers == 0)
+			SDL_CondSignal(pool->done);
+	}
+	SDL_UnlockMutex(pool->lock);
+	return (0);
+}
+
+/**
+ * createThreadPool - function starts a pool of persistent worker threads
+ * @threadCount: number of threads sharing a job, including the caller;
+ * 0 or less uses one per CPU core
+ *
+ * Return: pointer to the pool, or NULL on failure
+ */
+ThreadPool *createThreadPool(int threadCount)
+{
+	ThreadPool *pool = calloc(1, sizeof(ThreadPool));
+
+	if (!pool)
+		return (NULL);
+	if (threadCount <= 0)
+		threadCount = SDL_GetCPUCount();
+	pool->threadCount = threadCount;
+	pool->lock = SDL_CreateMutex();
+	pool->wake = SDL_CreateCond();
+	pool->done = SDL_CreateCond();
+	/*The calling thread is worker 0*/
+	pool->threads = calloc(threadCount, sizeof(SDL_Thread *));
+
+	if (!pool->lock || !pool->wake || !pool->done || !pool->threads)
+	{
+		fprintf(stderr, "Thread pool creation failed: %s\n", SDL_GetError());
+		destroyThreadPool(pool);
+		return (NULL);
+	}
+	for (int i = 1; i < threadCount; i++)
+	{
+		pool->threads[i] = SDL_CreateThread(workerMain, "raycast worker", pool);
+		if (!pool->threads[i])
+		{
+			fprintf(stderr, "SDL_CreateThread failed: %s\n", SDL_GetError());
+			pool->threadCount = i;
+			break;
+		}
+	}
+	return (pool);
+}
+
+/**
+ * runParallel - function splits items [0, count) over the pool and waits
+ * @pool: pointer to the thread pool, or NULL to run on the caller alone
+ * @count: number of items in the job
+ * @grain: number of consecutive items handed out at once
+ * @job: callback processing a range of items
+ * @context: pointer passed through to the callback
+ *
+ * Return: void
+ */
+void runParallel(ThreadPool *pool, int count, int grain, ParallelJob job, void *context)
+{
+	if (!pool || pool->threadCount <= 1)
+	{
+		job(context, 0, count);
+		return;
+	}
+	SDL_LockMutex(pool->lock);
+	pool->job = job;
+	pool->context = context;
+	pool->count = count;
+	pool->grain = grain > 0 ? grain : 1;
+	SDL_AtomicSet(&pool->next, 0);
+	pool->busyWorkers = pool->threadCount - 1;
+	pool->generation++;
+	SDL_CondBroadcast(pool->wake);
+	SDL_UnlockMutex(pool->lock);
+
+	drainJob(pool);
+
+	SDL_LockMutex(pool->lock);
+	while (pool->busyWorkers > 0)
+		SDL_CondWait(pool->done, pool->lock);
+	SDL_UnlockMutex(pool->lock);
+}
+
+/**
+ * destroyThreadPool - function stops the workers and frees the pool
+ * @pool: pointer to the thread pool
+ *
+ * Return: void
+ */
+void destroyThreadPool(ThreadPool *pool)
+{
+	if (!pool)
+		return;
+	if (pool->lock)
+	{
+		SDL_LockMutex(pool->lock);
+		pool->quit = true;
+		SDL_CondBroadcast(pool->wake);
+		SDL_UnlockMutex(pool->lock);
+	}
+	for (int i = 1; pool->threads && i < pool->threadCount; i++)
+		SDL_WaitThread(pool->threads[i], NULL);
+	free(pool->threads);
+	SDL_DestroyCond(pool->done);
+	SDL_DestroyCond(pool->wake);
+	SDL_DestroyMutex(pool->lock);
+	free(pool);
+}
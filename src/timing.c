@@ -0,0 +1,35 @@
+#include "../header/timing.h"
+
+/**
+ * getSecondsBetween - function converts a performance counter span to seconds
+ * @start: earlier SDL_GetPerformanceCounter value
+ * @end: later SDL_GetPerformanceCounter value
+ *
+ * Return: elapsed time in seconds
+ */
+double getSecondsBetween(Uint64 start, Uint64 end)
+{
+	return ((double)(end - start) / SDL_GetPerformanceFrequency());
+}
+
+/**
+ * waitUntil - function blocks until the performance counter reaches a deadline
+ * @deadline: SDL_GetPerformanceCounter value to wait for
+ *
+ * SDL_Delay may oversleep by a millisecond or more, so it is only used
+ * while more than 2 ms remain and the rest is spent polling the counter.
+ *
+ * Return: void
+ */
+void waitUntil(Uint64 deadline)
+{
+	const Uint64 twoMs = SDL_GetPerformanceFrequency() / 500;
+	Uint64 now = SDL_GetPerformanceCounter();
+
+	while (now < deadline)
+	{
+		if (deadline - now > twoMs)
+			SDL_Delay((Uint32)((deadline - now - twoMs) * 1000 / SDL_GetPerformanceFrequency()));
+		now = SDL_GetPerformanceCounter();
+	}
+}
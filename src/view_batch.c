@@ -0,0 +1,168 @@
+#include "../header/view_batch.h"
+#include "../header/rendering.h"
+#include "../header/camera.h"
+
+/*One renderViewBatch call, shared by the workers*/
+typedef struct {
+	const ViewBatch *batch;
+	const ViewCamera *views;
+	Framebuffer *targets;
+} ViewJob;
+
+/**
+ * createViewBatch - function loads what every view of a batch shares
+ * @width: columns of every view
+ * @height: rows of every view
+ * @threadCount: threads drawing views, including the caller;
+ * 0 or less uses one per CPU core
+ *
+ * SDL and SDL_image must be initialized, but no video mode or renderer
+ * is needed: the wall textures are decoded straight into the atlas.
+ *
+ * Return: pointer to the batch, or NULL on failure
+ */
+ViewBatch *createViewBatch(int width, int height, int threadCount)
+{
+	ViewBatch *batch;
+	TextureData wallTextures[WALL_TEXTURE_COUNT];
+	char path[64];
+	bool ready;
+
+	if (width <= 0 || height <= 0)
+	{
+		fprintf(stderr, "Views of %dx%d cannot be rendered\n", width, height);
+		return (NULL);
+	}
+	batch = calloc(1, sizeof(ViewBatch));
+	if (!batch)
+		return (NULL);
+	batch->width = width;
+	batch->height = height;
+	batch->cameraX = malloc(sizeof(double) * width);
+	batch->pool = createThreadPool(threadCount);
+	if (!batch->cameraX || !batch->pool)
+	{
+		fprintf(stderr, "Failed to allocate a batch of %dx%d views\n", width, height);
+		destroyViewBatch(batch);
+		return (NULL);
+	}
+	fillCameraColumns(batch->cameraX, width);
+	for (int i = 0; i < WALL_TEXTURE_COUNT; i++)
+	{
+		snprintf(path, sizeof(path), "./resources/textures/%d.png", i + 1);
+		wallTextures[i] = (TextureData){NULL, decodeTextureSurface(path), 0, 0};
+		if (wallTextures[i].surface)
+		{
+			wallTextures[i].width = wallTextures[i].surface->w;
+			wallTextures[i].height = wallTextures[i].surface->h;
+		}
+	}
+	ready = createWallAtlas(&batch->wallAtlas, wallTextures);
+	for (int i = 0; i < WALL_TEXTURE_COUNT; i++)
+		SDL_FreeSurface(wallTextures[i].surface);
+	if (!ready || !createFloorTextures(&batch->floorTextures, &batch->wallAtlas))
+	{
+		destroyViewBatch(batch);
+		return (NULL);
+	}
+	return (batch);
+}
+
+/**
+ * createViewTargets - function allocates framebuffers for the views of a batch
+ * @batch: pointer to the batch
+ * @targets: array of count framebuffers to initialize
+ * @count: number of framebuffers
+ *
+ * The framebuffers have no texture; their pixels are read from memory.
+ *
+ * Return: true on success, false otherwise
+ */
+bool createViewTargets(const ViewBatch *batch, Framebuffer *targets, int count)
+{
+	for (int i = 0; i < count; i++)
+	{
+		if (!createFramebuffer(&targets[i], NULL, batch->width, batch->height))
+		{
+			destroyViewTargets(targets, i);
+			return (false);
+		}
+	}
+	return (true);
+}
+
+/**
+ * drawViews - function draws a range of the views of a batch
+ * @context: pointer to the ViewJob
+ * @begin: first view of the range
+ * @end: one past the last view of the range
+ *
+ * Return: void
+ */
+static void drawViews(void *context, int begin, int end)
+{
+	const ViewJob *job = context;
+	const ViewBatch *batch = job->batch;
+
+	for (int i = begin; i < end; i++)
+	{
+		const ViewCamera *view = &job->views[i];
+		Framebuffer *fb = &job->targets[i];
+
+		performRaycastingView(fb, &batch->wallAtlas, batch->cameraX, view->posX,
+				view->posY, view->dirX, view->dirY, view->planeX, view->planeY);
+		performFloorCasting(fb, NULL, &batch->floorTextures, true, view->posX,
+				view->posY, view->dirX, view->dirY, view->planeX, view->planeY);
+	}
+}
+
+/**
+ * renderViewBatch - function renders a batch of cameras into their framebuffers
+ * @batch: pointer to the batch
+ * @views: array of count cameras
+ * @targets: array of count framebuffers from createViewTargets
+ * @count: number of views
+ *
+ * Each view gets the textured walls, floor and ceiling of the software
+ * renderer, without sky or sprites. Views are handed to the threads one
+ * at a time, so views that look down long corridors balance out. The
+ * game's frame state, columnHits and the ray cache, is left untouched.
+ *
+ * Return: void
+ */
+void renderViewBatch(ViewBatch *batch, const ViewCamera *views, Framebuffer *targets, int count)
+{
+	ViewJob job = {batch, views, targets};
+
+	runParallel(batch->pool, count, 1, drawViews, &job);
+}
+
+/**
+ * destroyViewTargets - function frees the framebuffers of createViewTargets
+ * @targets: array of framebuffers
+ * @count: number of framebuffers
+ *
+ * Return: void
+ */
+void destroyViewTargets(Framebuffer *targets, int count)
+{
+	for (int i = 0; i < count; i++)
+		destroyFramebuffer(&targets[i]);
+}
+
+/**
+ * destroyViewBatch - function frees a batch and its shared data
+ * @batch: pointer to the batch, may be NULL
+ *
+ * Return: void
+ */
+void destroyViewBatch(ViewBatch *batch)
+{
+	if (!batch)
+		return;
+	destroyWallAtlas(&batch->wallAtlas);
+	destroyFloorTextures(&batch->floorTextures);
+	destroyThreadPool(batch->pool);
+	free(batch->cameraX);
+	free(batch);
+}
@@ -53,8 +53,13 @@ WeaponState handleWeaponInput(bool* firing, WeaponState currentWeaponState) {
  */
 void renderWeapon(SDL_Renderer* renderer, TextureData* weaponTextures, WeaponState weaponState)
 {
-    /*Adjust Weapon size*/
-    SDL_Rect dstRect = {SCREEN_WIDTH / 2 - 128, SCREEN_HEIGHT - 256, 256, 256};
+    int width, height, size;
+    SDL_Rect dstRect;
+
+    /*Adjust Weapon size, 256 pixels at SCREEN_HEIGHT*/
+    SDL_GetRendererOutputSize(renderer, &width, &height);
+    size = 256 * height / SCREEN_HEIGHT;
+    dstRect = (SDL_Rect){width / 2 - size / 2, height - size, size, size};
 
     switch (weaponState)
     {
@@ -73,33 +78,106 @@ void renderWeapon(SDL_Renderer* renderer, TextureData* weaponTextures, WeaponSta
     }
 }
 
+/**
+ * getMuzzlePosition - function finds where smoke leaves the drawn weapon
+ * @renderer: SDL renderer pointer the weapon is drawn with
+ * @x: receives the muzzle position on the x axis, in output pixels
+ * @y: receives the muzzle position on the y axis, in output pixels
+ *
+ * Return: void
+ */
+void getMuzzlePosition(SDL_Renderer* renderer, float* x, float* y)
+{
+    int width, height;
+
+    SDL_GetRendererOutputSize(renderer, &width, &height);
+    *x = width / 2.0f;
+    *y = height - 220.0f * height / SCREEN_HEIGHT;
+}
+
+/**
+ * fireWeapon - function fires the weapon if it is ready
+ * @weaponState: pointer to the current weapon state
+ * @stateTime: pointer to the time the current state was entered
+ * @now: current simulation time in ms
+ *
+ * Return: true if a shot was fired, false if the weapon was busy
+ */
+bool fireWeapon(WeaponState* weaponState, Uint32* stateTime, Uint32 now)
+{
+    if (*weaponState != WEAPON_AIM)
+        return false;
+
+    *weaponState = WEAPON_FIRE;
+    *stateTime = now;
+    /*Play gunshot sound*/
+    Mix_PlayChannel(-1, shotgunSound, 0);
+    return true;
+}
+
+/**
+ * shootNpcs - function applies a shot along the player's view
+ * @npcs: NPCs indexed by map cell, with their sprite index as id
+ * @sprites: sprites the NPCs are drawn with
+ * @player: player who fired
+ *
+ * Hit-scan: the first NPC in the line of fire, if no wall is nearer, goes
+ * down. The last sprite takes the freed slot, so its entity is renumbered.
+ *
+ * Return: sprite index of the NPC hit, or -1 if the shot missed
+ */
+int shootNpcs(EntityGrid* npcs, SpriteSet* sprites, const Player* player)
+{
+    int target = castEntityRay(npcs, player->posX, player->posY,
+            player->dirX, player->dirY, NULL);
+
+    if (target >= 0)
+    {
+        int last = sprites->count - 1;
+
+        removeEntity(npcs, target);
+        removeSprite(sprites, target);
+        renumberEntity(npcs, last, target);
+    }
+    return target;
+}
+
 /**
  * updateWeaponState - function to update weapon state
- * @lastFireTime: pointer to time data when weapon was fired last
- * @fireCooldown: contains the time in ms for weapon cooldown
- * 
+ * @weaponState: pointer to the current weapon state
+ * @stateTime: pointer to the time the current state was entered
+ * @now: current simulation time in ms
+ *
+ * Each state after firing lasts a fixed time, so the weapon animates
+ * without ever pausing the game loop.
+ *
  * Return: null
  */
-void updateWeaponState(WeaponState* weaponState, Uint32* lastFireTime, Uint32 fireCooldown)
+void updateWeaponState(WeaponState* weaponState, Uint32* stateTime, Uint32 now)
 {
-    /*Update weapon state based on current time and last fire time*/
-    Uint32 currentTime = SDL_GetTicks();
-
-    /*Handle weapon state transitions*/
+    /*Handle weapon state transitions once the current state has run its time*/
     switch (*weaponState)
     {
         case WEAPON_FIRE:
-
-            if (currentTime - *lastFireTime >= fireCooldown)
+            if (now - *stateTime >= WEAPON_FIRE_MS)
             {
                 *weaponState = WEAPON_RECOIL;
+                *stateTime += WEAPON_FIRE_MS;
             }
             break;
         case WEAPON_RECOIL:
-            *weaponState = WEAPON_RELOAD;
+            if (now - *stateTime >= WEAPON_RECOIL_MS)
+            {
+                *weaponState = WEAPON_RELOAD;
+                *stateTime += WEAPON_RECOIL_MS;
+            }
             break;
         case WEAPON_RELOAD:
-            *weaponState = WEAPON_AIM;
+            if (now - *stateTime >= WEAPON_RELOAD_MS)
+            {
+                *weaponState = WEAPON_AIM;
+                *stateTime += WEAPON_RELOAD_MS;
+            }
             break;
         default:
             *weaponState = WEAPON_AIM;
@@ -0,0 +1,41 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "../header/map.h"
+
+/*
+ * Converts a map.txt style text map into the binary map format that
+ * loadMap can map into memory without parsing. Any map loadMap accepts
+ * can be given as input, so binary maps can also be checked and rewritten.
+ *
+ * gcc -O2 -o mapconvert tools/mapconvert.c src/map.c
+ */
+
+/**
+ * main - converts one map file
+ * @argc: arguments counter
+ * @argv: pointer to argument array
+ *
+ * Return: 0 on success, 1 on failure
+ */
+int main(int argc, char *argv[])
+{
+	if (argc != 3)
+	{
+		fprintf(stderr, "Usage: %s INPUT OUTPUT\n", argv[0]);
+		fprintf(stderr, "  e.g. %s resources/map.txt resources/map.bin\n", argv[0]);
+		return (1);
+	}
+
+	/*loadMap reports invalid maps and exits*/
+	loadMap(argv[1]);
+	if (!saveMapBinary(&worldMap, argv[2]))
+	{
+		fprintf(stderr, "Failed to write %s\n", argv[2]);
+		freeMap(&worldMap);
+		return (1);
+	}
+	printf("%s: %dx%d map, %d x %d tiles\n", argv[2], worldMap.width,
+			worldMap.height, worldMap.tilesX, worldMap.tilesY);
+	freeMap(&worldMap);
+	return (0);
+}